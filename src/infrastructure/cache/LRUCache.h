@@ -0,0 +1,175 @@
+#ifndef LRUCACHE_H
+#define LRUCACHE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QDateTime>
+#include <list>
+
+// 线程安全的LRU缓存
+// 同时受条目数、字节预算和TTL约束，超出任一限制时从最久未使用的条目开始淘汰。
+// 所有操作都在内部互斥锁下完成，可被多个工作线程共享。
+template <typename K, typename V>
+class LRUCache
+{
+public:
+    // capacity: 最大条目数；maxBytes: 字节预算；ttlSeconds: 过期时间，0表示不过期
+    LRUCache(int capacity, qint64 maxBytes, int ttlSeconds = 0)
+        : maxEntries(qMax(1, capacity)), byteBudget(maxBytes), ttlMs(qint64(ttlSeconds) * 1000),
+          usedBytes(0), hitCount(0), missCount(0), evictionCount(0)
+    {
+    }
+
+    void put(const K &key, const V &value, qint64 cost)
+    {
+        QMutexLocker locker(&mutex);
+        auto found = index.find(key);
+        if (found != index.end()) {
+            usedBytes -= found.value()->cost;
+            entries.erase(found.value());
+            index.erase(found);
+        }
+        // 单个条目超过整个预算时不缓存
+        if (byteBudget > 0 && cost > byteBudget) return;
+
+        entries.push_front(Entry{key, value, cost, QDateTime::currentMSecsSinceEpoch()});
+        index.insert(key, entries.begin());
+        usedBytes += cost;
+        evict();
+    }
+
+    // 未命中或已过期时返回默认构造的值
+    V get(const K &key)
+    {
+        V value;
+        tryGet(key, value);
+        return value;
+    }
+
+    bool tryGet(const K &key, V &value)
+    {
+        QMutexLocker locker(&mutex);
+        auto found = index.find(key);
+        if (found == index.end()) {
+            ++missCount;
+            return false;
+        }
+        auto entry = found.value();
+        if (ttlMs > 0 && QDateTime::currentMSecsSinceEpoch() - entry->insertedAt > ttlMs) {
+            usedBytes -= entry->cost;
+            entries.erase(entry);
+            index.erase(found);
+            ++missCount;
+            return false;
+        }
+        // 移到链表头部，标记为最近使用
+        entries.splice(entries.begin(), entries, entry);
+        value = entry->value;
+        ++hitCount;
+        return true;
+    }
+
+    bool contains(const K &key) const
+    {
+        QMutexLocker locker(&mutex);
+        return index.contains(key);
+    }
+
+    void remove(const K &key)
+    {
+        QMutexLocker locker(&mutex);
+        auto found = index.find(key);
+        if (found == index.end()) return;
+        usedBytes -= found.value()->cost;
+        entries.erase(found.value());
+        index.erase(found);
+    }
+
+    void clear()
+    {
+        QMutexLocker locker(&mutex);
+        entries.clear();
+        index.clear();
+        usedBytes = 0;
+    }
+
+    int size() const
+    {
+        QMutexLocker locker(&mutex);
+        return index.size();
+    }
+
+    qint64 totalBytes() const
+    {
+        QMutexLocker locker(&mutex);
+        return usedBytes;
+    }
+
+    quint64 hits() const
+    {
+        QMutexLocker locker(&mutex);
+        return hitCount;
+    }
+
+    quint64 misses() const
+    {
+        QMutexLocker locker(&mutex);
+        return missCount;
+    }
+
+    quint64 evictions() const
+    {
+        QMutexLocker locker(&mutex);
+        return evictionCount;
+    }
+
+    double hitRate() const
+    {
+        QMutexLocker locker(&mutex);
+        const quint64 lookups = hitCount + missCount;
+        return lookups > 0 ? double(hitCount) / lookups : 0.0;
+    }
+
+    void resetStatistics()
+    {
+        QMutexLocker locker(&mutex);
+        hitCount = 0;
+        missCount = 0;
+        evictionCount = 0;
+    }
+
+private:
+    struct Entry {
+        K key;
+        V value;
+        qint64 cost;
+        qint64 insertedAt;
+    };
+
+    // 调用方已持有锁
+    void evict()
+    {
+        while (!entries.empty() &&
+               (int(entries.size()) > maxEntries || (byteBudget > 0 && usedBytes > byteBudget))) {
+            const Entry &oldest = entries.back();
+            usedBytes -= oldest.cost;
+            index.remove(oldest.key);
+            entries.pop_back();
+            ++evictionCount;
+        }
+    }
+
+    mutable QMutex mutex;
+    std::list<Entry> entries; // 头部为最近使用
+    QHash<K, typename std::list<Entry>::iterator> index;
+    const int maxEntries;
+    const qint64 byteBudget;
+    const qint64 ttlMs;
+    qint64 usedBytes;
+    quint64 hitCount;
+    quint64 missCount;
+    quint64 evictionCount;
+};
+
+#endif // LRUCACHE_H
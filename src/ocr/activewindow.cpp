@@ -0,0 +1,129 @@
+#include "activewindow.h"
+#include <QGuiApplication>
+#include <QScreen>
+#include <QWindow>
+#include <qpa/qplatformscreen.h>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#endif
+
+#ifdef OCR_X11
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#include <unistd.h>
+#include "x11errortrap.h"
+#endif
+
+#if defined(Q_OS_WIN) || defined(OCR_X11)
+// 系统返回物理像素；按平台插件给出的屏幕物理矩形找到所在屏幕，再按该屏幕的缩放比例换算
+static QRect toLogical(const QRect &physical)
+{
+    const QPoint center = physical.center();
+    for (QScreen *screen : QGuiApplication::screens()) {
+        if (!screen->handle()) continue;
+        const QRect geometry = screen->geometry();
+        const qreal dpr = screen->devicePixelRatio();
+        const QRect native = screen->handle()->geometry();
+        if (native.contains(center)) {
+            const QPoint topLeft = geometry.topLeft() + (physical.topLeft() - native.topLeft()) / dpr;
+            return QRect(topLeft, physical.size() / dpr);
+        }
+    }
+    return physical;
+}
+#endif
+
+#ifdef OCR_X11
+// 读取窗口上格式为32位的属性，最多count项，返回实际读到的项数
+static int readLongs(Display *display, Window window, const char *name, Atom type, unsigned long *values, int count)
+{
+    Atom actualType = None;
+    int actualFormat = 0;
+    unsigned long items = 0;
+    unsigned long remaining = 0;
+    unsigned char *data = nullptr;
+    const Atom property = XInternAtom(display, name, True);
+    if (property == None) return 0;
+    if (XGetWindowProperty(display, window, property, 0, count, False, type, &actualType, &actualFormat, &items,
+                           &remaining, &data) != Success) {
+        return 0;
+    }
+    int read = 0;
+    if (data && actualType == type && actualFormat == 32) {
+        read = int(qMin<unsigned long>(items, count));
+        const unsigned long *longs = reinterpret_cast<const unsigned long *>(data);
+        for (int i = 0; i < read; ++i) {
+            values[i] = longs[i];
+        }
+    }
+    if (data) XFree(data);
+    return read;
+}
+
+// 从根窗口的_NET_ACTIVE_WINDOW取得前台窗口，返回包含窗口管理器边框的物理像素坐标
+static QRect activeX11Window(Display *display)
+{
+    const Window root = DefaultRootWindow(display);
+    unsigned long active = 0;
+    if (readLongs(display, root, "_NET_ACTIVE_WINDOW", XA_WINDOW, &active, 1) != 1 || active == 0) return QRect();
+    const Window window = Window(active);
+
+    unsigned long pid = 0;
+    if (readLongs(display, window, "_NET_WM_PID", XA_CARDINAL, &pid, 1) == 1 && pid == static_cast<unsigned long>(getpid())) {
+        return QRect();
+    }
+
+    XWindowAttributes attributes;
+    if (!XGetWindowAttributes(display, window, &attributes) || attributes.map_state != IsViewable) return QRect();
+
+    // 客户区原点换算到根窗口坐标，再按_NET_FRAME_EXTENTS（左、右、上、下）加上边框
+    int x = 0;
+    int y = 0;
+    Window child = 0;
+    if (!XTranslateCoordinates(display, window, root, 0, 0, &x, &y, &child)) return QRect();
+    unsigned long extents[4] = {0, 0, 0, 0};
+    readLongs(display, window, "_NET_FRAME_EXTENTS", XA_CARDINAL, extents, 4);
+    return QRect(x - int(extents[0]), y - int(extents[2]), attributes.width + int(extents[0] + extents[1]),
+                 attributes.height + int(extents[2] + extents[3]));
+}
+
+static QRect x11Geometry()
+{
+    // 连接只打开一次，在GUI线程的定时器中反复查询
+    static Display *display = XOpenDisplay(nullptr);
+    if (!display) return QRect();
+
+    // 查询期间窗口可能被关闭，出错时当作没有前台窗口
+    X11ErrorTrap trap(display);
+    const QRect rect = activeX11Window(display);
+    if (trap.sync() != 0 || rect.isEmpty()) return QRect();
+    return toLogical(rect);
+}
+#endif
+
+QRect ActiveWindow::geometry()
+{
+#ifdef Q_OS_WIN
+    HWND hwnd = GetForegroundWindow();
+    if (!hwnd || IsIconic(hwnd)) return QRect();
+
+    DWORD processId = 0;
+    GetWindowThreadProcessId(hwnd, &processId);
+    if (processId == GetCurrentProcessId()) return QRect();
+
+    RECT rect;
+    if (!GetWindowRect(hwnd, &rect)) return QRect();
+    return toLogical(QRect(QPoint(rect.left, rect.top), QPoint(rect.right - 1, rect.bottom - 1)));
+#else
+#ifdef OCR_X11
+    // X11上由窗口管理器在根窗口上公布前台窗口，Wayland下的坐标与X11不一致，不使用
+    if (QGuiApplication::platformName() == QLatin1String("xcb")) {
+        return x11Geometry();
+    }
+#endif
+    // 无法获取其他进程的窗口，只能跟随本进程的焦点窗口
+    QWindow *window = QGuiApplication::focusWindow();
+    return window ? window->frameGeometry() : QRect();
+#endif
+}
@@ -0,0 +1,27 @@
+#ifndef ACTIVEWINDOW_H
+#define ACTIVEWINDOW_H
+
+#include <QtCore/qglobal.h>
+
+#ifndef OCR_EXPORT
+#ifdef OCR_LIBRARY
+#define OCR_EXPORT Q_DECL_EXPORT
+#else
+#define OCR_EXPORT Q_DECL_IMPORT
+#endif
+#endif
+
+#include <QRect>
+
+// 当前前台窗口
+class OCR_EXPORT ActiveWindow
+{
+public:
+    // 前台窗口的全局逻辑坐标（与QScreen::geometry()同一坐标系）。
+    // Windows上查询系统前台窗口，X11上读取根窗口的_NET_ACTIVE_WINDOW并加上窗口管理器的边框，
+    // 前台窗口属于本进程（如悬浮显示窗口）时返回空矩形；
+    // 其他平台只能取得本进程的焦点窗口。无法获取时返回空矩形
+    static QRect geometry();
+};
+
+#endif // ACTIVEWINDOW_H
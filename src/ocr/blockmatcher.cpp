@@ -0,0 +1,96 @@
+#include "blockmatcher.h"
+#include <QAtomicInteger>
+#include <QHash>
+#include <QSet>
+
+static QAtomicInteger<quint64> nextBlockId(1);
+
+// 各边相差不超过tolerance像素
+static bool sameBox(const QRect &a, const QRect &b, int tolerance)
+{
+    return qAbs(a.left() - b.left()) <= tolerance && qAbs(a.top() - b.top()) <= tolerance &&
+           qAbs(a.right() - b.right()) <= tolerance && qAbs(a.bottom() - b.bottom()) <= tolerance;
+}
+
+int BlockMatcher::findSame(const QVector<OCRTextBlock> &previous, const QRect &box)
+{
+    for (int i = 0; i < previous.size(); ++i) {
+        if (previous[i].rect == box) return i;
+    }
+    return -1;
+}
+
+int BlockMatcher::findShifted(const QVector<OCRTextBlock> &previous, const QRect &box, const QRect &scrollRegion,
+                              const QPoint &offset, int tolerance)
+{
+    if (!scrollRegion.contains(box)) return -1;
+    for (int i = 0; i < previous.size(); ++i) {
+        if (scrollRegion.contains(previous[i].rect) && sameBox(previous[i].rect.translated(offset), box, tolerance)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void BlockMatcher::assignIds(QVector<OCRTextBlock> &blocks, const QVector<OCRTextBlock> &previous, double minOverlap)
+{
+    QSet<quint64> usedIds;
+    for (const OCRTextBlock &block : blocks) {
+        if (block.id != 0) usedIds.insert(block.id);
+    }
+    for (OCRTextBlock &block : blocks) {
+        if (block.id != 0) continue;
+        double bestOverlap = minOverlap;
+        for (const OCRTextBlock &old : previous) {
+            if (usedIds.contains(old.id)) continue;
+            const double overlap = overlapRatio(old.rect, block.rect);
+            if (overlap >= bestOverlap) {
+                bestOverlap = overlap;
+                block.id = old.id;
+            }
+        }
+        if (block.id == 0) {
+            block.id = newId();
+        }
+        usedIds.insert(block.id);
+    }
+}
+
+OCRTextDelta BlockMatcher::diff(const QVector<OCRTextBlock> &previous, const QVector<OCRTextBlock> &current)
+{
+    OCRTextDelta delta;
+    QHash<quint64, int> previousIndex;
+    for (int i = 0; i < previous.size(); ++i) {
+        previousIndex.insert(previous[i].id, i);
+    }
+    for (const OCRTextBlock &block : current) {
+        auto found = previousIndex.find(block.id);
+        if (found == previousIndex.end()) {
+            delta.added.append(block);
+            continue;
+        }
+        const OCRTextBlock &old = previous[found.value()];
+        if (old.text != block.text || old.rect != block.rect) {
+            delta.changed.append(block);
+        }
+        previousIndex.erase(found);
+    }
+    for (auto it = previousIndex.constBegin(); it != previousIndex.constEnd(); ++it) {
+        delta.removed.append(it.key());
+    }
+    return delta;
+}
+
+double BlockMatcher::overlapRatio(const QRect &a, const QRect &b)
+{
+    const QRect common = a.intersected(b);
+    if (common.isEmpty()) return 0.0;
+    const double shared = double(common.width()) * common.height();
+    const double total = double(a.width()) * a.height() + double(b.width()) * b.height() - shared;
+    return total > 0.0 ? shared / total : 0.0;
+}
+
+quint64 BlockMatcher::newId()
+{
+    return nextBlockId.fetchAndAddRelaxed(1);
+}
@@ -0,0 +1,47 @@
+#ifndef BLOCKMATCHER_H
+#define BLOCKMATCHER_H
+
+#include <QtCore/qglobal.h>
+
+#ifndef OCR_EXPORT
+#ifdef OCR_LIBRARY
+#define OCR_EXPORT Q_DECL_EXPORT
+#else
+#define OCR_EXPORT Q_DECL_IMPORT
+#endif
+#endif
+
+#include <QPoint>
+#include <QRect>
+#include <QVector>
+#include "ocrtypes.h"
+
+// 连续帧之间文字区域的对应关系
+// 位置不变或随滚动平移的区域直接沿用上一帧的文字和编号；新识别的区域与上一帧区域重叠足够多时
+// 视为同一区域（文字被编辑、区域拆分或合并），沿用编号；输出时按编号比较得出增删改。
+class OCR_EXPORT BlockMatcher
+{
+public:
+    // previous中位置与box完全相同的区域，找不到时返回-1
+    static int findSame(const QVector<OCRTextBlock> &previous, const QRect &box);
+
+    // 滚动后与box对应的上一帧区域：两者都在scrollRegion内，上一帧区域平移offset后各边与box相差不超过tolerance。
+    // 检测框在降采样网格上取整，tolerance一般取检测的降采样倍数。找不到时返回-1
+    static int findShifted(const QVector<OCRTextBlock> &previous, const QRect &box, const QRect &scrollRegion,
+                           const QPoint &offset, int tolerance);
+
+    // 给blocks中编号为0的区域分配编号：取上一帧中尚未被使用、交并比最大且不低于minOverlap的区域的编号，
+    // 没有时分配新编号。已有编号的区域先占用各自的编号
+    static void assignIds(QVector<OCRTextBlock> &blocks, const QVector<OCRTextBlock> &previous, double minOverlap = 0.5);
+
+    // 按编号比较两次输出，文字或位置变化的区域记为changed
+    static OCRTextDelta diff(const QVector<OCRTextBlock> &previous, const QVector<OCRTextBlock> &current);
+
+    // 交并比，0~1
+    static double overlapRatio(const QRect &a, const QRect &b);
+
+    // 进程内唯一的新编号，所有流水线共用，保证多屏幕时编号也不重复
+    static quint64 newId();
+};
+
+#endif // BLOCKMATCHER_H
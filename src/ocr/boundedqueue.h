@@ -0,0 +1,105 @@
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QQueue>
+#include <climits>
+
+// 有界帧队列
+// 队列满时丢弃最旧的元素而不是阻塞生产者，保证下游总是处理最新的帧。
+// 回放录制帧时可改用pushWait()，等待下游腾出空位，一帧都不丢。
+template <typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(int capacity = 1) : cap(qMax(1, capacity)), closed(false), dropped(0) {}
+
+    // 返回false表示为了放入新元素丢弃了旧元素
+    bool push(const T &item)
+    {
+        QMutexLocker locker(&mutex);
+        if (closed) return false;
+        bool kept = true;
+        while (items.size() >= cap) {
+            items.dequeue();
+            ++dropped;
+            kept = false;
+        }
+        items.enqueue(item);
+        notEmpty.wakeOne();
+        return kept;
+    }
+
+    // 队列满时阻塞等待空位，队列关闭返回false
+    bool pushWait(const T &item)
+    {
+        QMutexLocker locker(&mutex);
+        while (items.size() >= cap && !closed) {
+            notFull.wait(&mutex);
+        }
+        if (closed) return false;
+        items.enqueue(item);
+        notEmpty.wakeOne();
+        return true;
+    }
+
+    // 阻塞等待元素，队列关闭或超时返回false
+    bool pop(T &item, unsigned long timeoutMs = ULONG_MAX)
+    {
+        QMutexLocker locker(&mutex);
+        while (items.isEmpty() && !closed) {
+            if (!notEmpty.wait(&mutex, timeoutMs)) {
+                return false;
+            }
+        }
+        if (items.isEmpty()) return false;
+        item = items.dequeue();
+        notFull.wakeOne();
+        return true;
+    }
+
+    void close()
+    {
+        QMutexLocker locker(&mutex);
+        closed = true;
+        notEmpty.wakeAll();
+        notFull.wakeAll();
+    }
+
+    void reopen()
+    {
+        QMutexLocker locker(&mutex);
+        closed = false;
+        items.clear();
+    }
+
+    int size() const
+    {
+        QMutexLocker locker(&mutex);
+        return items.size();
+    }
+
+    int capacity() const
+    {
+        return cap;
+    }
+
+    quint64 droppedCount() const
+    {
+        QMutexLocker locker(&mutex);
+        return dropped;
+    }
+
+private:
+    mutable QMutex mutex;
+    QWaitCondition notEmpty;
+    QWaitCondition notFull;
+    QQueue<T> items;
+    const int cap;
+    bool closed;
+    quint64 dropped;
+};
+
+#endif // BOUNDEDQUEUE_H
@@ -0,0 +1,54 @@
+#include "capturesource.h"
+#include <QGuiApplication>
+#include <QScreen>
+#include <QPixmap>
+#include <QDebug>
+
+#ifdef OCR_X11_CAPTURE
+#include "x11capturesource.h"
+#endif
+
+CaptureSource::CaptureSource(QObject *parent)
+    : QObject(parent)
+{
+}
+
+CaptureSource::~CaptureSource()
+{
+}
+
+bool CaptureSource::isEventDriven() const
+{
+    return false;
+}
+
+CaptureSource *CaptureSource::create(QScreen *screen, QObject *parent)
+{
+#ifdef OCR_X11_CAPTURE
+    if (QGuiApplication::platformName() == QLatin1String("xcb") && qgetenv("OCR_CAPTURE_BACKEND") != "grab") {
+        X11CaptureSource *source = new X11CaptureSource(screen, parent);
+        if (source->open()) {
+            return source;
+        }
+        qDebug() << "XShm/XDamage capture unavailable, falling back to grabWindow";
+        delete source;
+    }
+#endif
+    return new ScreenGrabSource(screen, parent);
+}
+
+ScreenGrabSource::ScreenGrabSource(QScreen *screen, QObject *parent)
+    : CaptureSource(parent), target(screen)
+{
+}
+
+QString ScreenGrabSource::name() const
+{
+    return QStringLiteral("grab");
+}
+
+QImage ScreenGrabSource::grab(const QRect &region)
+{
+    if (!target || region.isEmpty()) return QImage();
+    return target->grabWindow(0, region.x(), region.y(), region.width(), region.height()).toImage();
+}
@@ -0,0 +1,59 @@
+#ifndef CAPTURESOURCE_H
+#define CAPTURESOURCE_H
+
+#include <QtCore/qglobal.h>
+
+#ifndef OCR_EXPORT
+#ifdef OCR_LIBRARY
+#define OCR_EXPORT Q_DECL_EXPORT
+#else
+#define OCR_EXPORT Q_DECL_IMPORT
+#endif
+#endif
+
+#include <QObject>
+#include <QImage>
+#include <QPointer>
+#include <QRect>
+#include <QString>
+
+class QScreen;
+
+// 截图来源
+// 坐标均为相对屏幕左上角的逻辑坐标，截得的图像为设备像素。
+class OCR_EXPORT CaptureSource : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CaptureSource(QObject *parent = nullptr);
+    virtual ~CaptureSource();
+
+    virtual QString name() const = 0;
+    virtual QImage grab(const QRect &region) = 0;
+
+    // 为true时屏幕变化会通过damaged()通知，调用方只在收到通知后截图；否则需要定时轮询
+    virtual bool isEventDriven() const;
+
+    // 按平台选择后端：X11上优先使用XShm + XDamage，不可用时退回QScreen::grabWindow。
+    // 设置环境变量OCR_CAPTURE_BACKEND=grab可强制使用grabWindow
+    static CaptureSource *create(QScreen *screen, QObject *parent = nullptr);
+
+signals:
+    void damaged(const QRect &rect);
+};
+
+// 基于QScreen::grabWindow的轮询截图，所有平台可用
+class OCR_EXPORT ScreenGrabSource : public CaptureSource
+{
+    Q_OBJECT
+public:
+    explicit ScreenGrabSource(QScreen *screen, QObject *parent = nullptr);
+
+    QString name() const override;
+    QImage grab(const QRect &region) override;
+
+private:
+    QPointer<QScreen> target;
+};
+
+#endif // CAPTURESOURCE_H
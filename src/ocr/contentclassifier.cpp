@@ -0,0 +1,126 @@
+#include "contentclassifier.h"
+#include "imagekernels.h"
+#include <QVector>
+#include <QtMath>
+#include <cstdlib>
+
+static const int COLOR_SAMPLES_X = 128;     // 颜色熵的采样网格
+static const int COLOR_SAMPLES_Y = 72;
+static const double HIGH_ENTROPY = 6.0;     // 低于该值视为界面/文档，直接判为文字
+static const int EDGE_STRENGTH = 24;        // |gx| + |gy| 达到该值才算强边缘
+static const double AXIS_TOLERANCE = 0.25;  // 较弱分量不超过较强分量的该比例时视为水平或竖直（约14度）
+static const double MIN_AXIS_RATIO = 0.45;  // 方向随机分布时约为0.31
+static const int CHANGE_LEVEL = 16;         // 缩略图像素灰度差超过该值视为变化
+static const double MOTION_CHANGE = 0.3;
+
+ContentClassifier::ContentClassifier()
+    : width(320)
+{
+}
+
+void ContentClassifier::setSampleWidth(int sampleWidth)
+{
+    width = qMax(32, sampleWidth);
+    previous = QImage();
+}
+
+int ContentClassifier::sampleWidth() const
+{
+    return width;
+}
+
+static double colorEntropy(const QImage &frame)
+{
+    // 网格采样，彩色按每通道4位量化（4096种），灰度按256级
+    const bool gray = frame.format() == QImage::Format_Grayscale8;
+    const QImage src = gray || frame.format() == QImage::Format_ARGB32 || frame.format() == QImage::Format_RGB32 ||
+                               frame.format() == QImage::Format_ARGB32_Premultiplied
+                           ? frame
+                           : frame.convertToFormat(QImage::Format_RGB32);
+    const int stepX = qMax(1, src.width() / COLOR_SAMPLES_X);
+    const int stepY = qMax(1, src.height() / COLOR_SAMPLES_Y);
+
+    QVector<int> histogram(gray ? 256 : 4096, 0);
+    int samples = 0;
+    for (int y = stepY / 2; y < src.height(); y += stepY) {
+        const uchar *line = src.constScanLine(y);
+        for (int x = stepX / 2; x < src.width(); x += stepX) {
+            if (gray) {
+                ++histogram[line[x]];
+            } else {
+                const QRgb pixel = reinterpret_cast<const QRgb *>(line)[x];
+                ++histogram[((qRed(pixel) >> 4) << 8) | ((qGreen(pixel) >> 4) << 4) | (qBlue(pixel) >> 4)];
+            }
+            ++samples;
+        }
+    }
+
+    double entropy = 0.0;
+    for (int count : histogram) {
+        if (count == 0) continue;
+        const double p = double(count) / samples;
+        entropy -= p * std::log2(p);
+    }
+    return entropy;
+}
+
+ContentClassifier::Content ContentClassifier::classify(const QImage &frame, const QImage &gray)
+{
+    features = Features();
+    if (frame.isNull()) return Text;
+
+    const QImage source = gray.isNull() ? ImageKernels::toGray(frame) : gray;
+    const int factor = qMax(1, source.width() / width);
+    const QImage thumb = ImageKernels::downscale(source, factor);
+
+    features.colorEntropy = colorEntropy(frame);
+
+    // 边缘方向：中心差分梯度，只统计强边缘
+    qint64 strong = 0;
+    qint64 axis = 0;
+    for (int y = 1; y + 1 < thumb.height(); ++y) {
+        const uchar *above = thumb.constScanLine(y - 1);
+        const uchar *line = thumb.constScanLine(y);
+        const uchar *below = thumb.constScanLine(y + 1);
+        for (int x = 1; x + 1 < thumb.width(); ++x) {
+            const int gx = std::abs(int(line[x + 1]) - int(line[x - 1]));
+            const int gy = std::abs(int(below[x]) - int(above[x]));
+            if (gx + gy < EDGE_STRENGTH) continue;
+            ++strong;
+            if (qMin(gx, gy) <= AXIS_TOLERANCE * qMax(gx, gy)) ++axis;
+        }
+    }
+    const qint64 inner = qint64(qMax(0, thumb.width() - 2)) * qMax(0, thumb.height() - 2);
+    features.edgeDensity = inner > 0 ? double(strong) / inner : 0.0;
+    features.axisEdgeRatio = strong > 0 ? double(axis) / strong : 1.0;
+
+    // 时间变化：与上一帧缩略图逐像素比较
+    if (previous.size() == thumb.size()) {
+        qint64 changed = 0;
+        for (int y = 0; y < thumb.height(); ++y) {
+            const uchar *a = previous.constScanLine(y);
+            const uchar *b = thumb.constScanLine(y);
+            for (int x = 0; x < thumb.width(); ++x) {
+                if (std::abs(int(a[x]) - int(b[x])) > CHANGE_LEVEL) ++changed;
+            }
+        }
+        features.changeRatio = double(changed) / (qint64(thumb.width()) * thumb.height());
+    }
+    previous = thumb;
+
+    if (features.colorEntropy < HIGH_ENTROPY) return Text;
+    if (features.changeRatio >= MOTION_CHANGE) return Motion;
+    if (features.axisEdgeRatio < MIN_AXIS_RATIO) return NonText;
+    return Text;
+}
+
+ContentClassifier::Features ContentClassifier::lastFeatures() const
+{
+    return features;
+}
+
+void ContentClassifier::reset()
+{
+    previous = QImage();
+    features = Features();
+}
@@ -0,0 +1,59 @@
+#ifndef CONTENTCLASSIFIER_H
+#define CONTENTCLASSIFIER_H
+
+#include <QtCore/qglobal.h>
+
+#ifndef OCR_EXPORT
+#ifdef OCR_LIBRARY
+#define OCR_EXPORT Q_DECL_EXPORT
+#else
+#define OCR_EXPORT Q_DECL_IMPORT
+#endif
+#endif
+
+#include <QImage>
+
+// 画面内容分类
+// 在缩略图上计算三个便宜的特征，判断整帧是否值得识别：
+//   颜色熵：界面和文档只有少数几种颜色，照片、视频和游戏画面颜色丰富；
+//   边缘方向：文字和界面的边缘以水平、竖直为主，自然图像的边缘方向分散；
+//   时间变化：与上一帧缩略图相比变化的像素比例，视频和游戏几乎每帧都大面积变化。
+// 颜色丰富且大面积变化的画面判为Motion，颜色丰富且边缘方向分散的判为NonText。
+// 滚动文档虽然整帧变化，但颜色熵低，仍判为Text。
+class OCR_EXPORT ContentClassifier
+{
+public:
+    enum Content {
+        Text,
+        NonText,
+        Motion
+    };
+
+    struct Features {
+        double colorEntropy = 0.0;  // 量化颜色直方图的熵，比特，0~12
+        double axisEdgeRatio = 0.0; // 强边缘中水平/竖直方向的比例
+        double edgeDensity = 0.0;   // 强边缘像素占比
+        double changeRatio = 0.0;   // 与上一帧相比变化的像素占比
+    };
+
+    ContentClassifier();
+
+    // 缩略图宽度，默认320
+    void setSampleWidth(int width);
+    int sampleWidth() const;
+
+    // frame为原始截图（ARGB32/RGB32或灰度），gray为其灰度图，调用方已转换过时传入可省去一次转换。
+    // 每次调用都会更新时间变化的参考帧
+    Content classify(const QImage &frame, const QImage &gray = QImage());
+    Features lastFeatures() const;
+
+    // 丢弃参考帧，下一帧不计算时间变化
+    void reset();
+
+private:
+    int width;
+    QImage previous; // 上一帧的灰度缩略图
+    Features features;
+};
+
+#endif // CONTENTCLASSIFIER_H
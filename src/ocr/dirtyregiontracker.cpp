@@ -0,0 +1,296 @@
+#include "dirtyregiontracker.h"
+#include <QStringList>
+#include <cstring>
+
+static const quint64 PRIME64_1 = 0x9E3779B185EBCA87ULL;
+static const quint64 PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+static const quint64 PRIME64_3 = 0x165667B19E3779F9ULL;
+static const int INK_CONTRAST = 48; // 相邻像素差达到该值才算笔画边缘
+
+static inline quint64 rotl64(quint64 x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline quint64 mixLane(quint64 acc, quint64 input)
+{
+    acc += input * PRIME64_2;
+    acc = rotl64(acc, 31);
+    return acc * PRIME64_1;
+}
+
+DirtyRegionTracker::DirtyRegionTracker(const QSize &tileSize)
+    : tile(tileSize), frameFormat(QImage::Format_Invalid), cols(0), rows(0), lastDirtyTiles(0)
+{
+}
+
+void DirtyRegionTracker::setTileSize(const QSize &size)
+{
+    if (size.isValid() && size != tile) {
+        tile = size;
+        reset();
+    }
+}
+
+QSize DirtyRegionTracker::tileSize() const
+{
+    return tile;
+}
+
+quint64 DirtyRegionTracker::hashTile(const uchar *bits, qsizetype bytesPerLine, int bytesPerRow, int rows)
+{
+    quint64 lane0 = PRIME64_1 + PRIME64_2;
+    quint64 lane1 = PRIME64_2;
+    quint64 lane2 = 0;
+    quint64 lane3 = 0 - PRIME64_1;
+
+    for (int y = 0; y < rows; ++y) {
+        const uchar *p = bits + y * bytesPerLine;
+        int x = 0;
+        // 四条独立的累加链，没有跨路依赖
+        for (; x + 32 <= bytesPerRow; x += 32) {
+            quint64 v[4];
+            memcpy(v, p + x, sizeof(v));
+            lane0 = mixLane(lane0, v[0]);
+            lane1 = mixLane(lane1, v[1]);
+            lane2 = mixLane(lane2, v[2]);
+            lane3 = mixLane(lane3, v[3]);
+        }
+        for (; x + 8 <= bytesPerRow; x += 8) {
+            quint64 v;
+            memcpy(&v, p + x, sizeof(v));
+            lane0 = mixLane(lane0, v);
+        }
+        for (; x < bytesPerRow; ++x) {
+            lane1 = mixLane(lane1, p[x]);
+        }
+    }
+
+    quint64 h = rotl64(lane0, 1) + rotl64(lane1, 7) + rotl64(lane2, 12) + rotl64(lane3, 18);
+    h ^= h >> 33;
+    h *= PRIME64_2;
+    h ^= h >> 29;
+    h *= PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+QRect DirtyRegionTracker::tilesToPixels(const QRect &tiles) const
+{
+    QRect rect(tiles.left() * tile.width(), tiles.top() * tile.height(),
+               tiles.width() * tile.width(), tiles.height() * tile.height());
+    return rect.intersected(QRect(QPoint(0, 0), frameSize));
+}
+
+// 像素行[left, right)内是否有相邻像素在某个通道上陡变
+static bool rowHasInk(const uchar *line, int left, int right, int bytesPerPixel)
+{
+    // 只看相邻像素的差：渐变、细纹理和抗锯齿的背景逐像素变化平缓，文字笔画边缘是陡变
+    const uchar *p = line + left * bytesPerPixel;
+    const int bytes = (right - left - 1) * bytesPerPixel;
+    for (int i = 0; i < bytes; ++i) {
+        if (qAbs(int(p[i + bytesPerPixel]) - int(p[i])) >= INK_CONTRAST) return true;
+    }
+    return false;
+}
+
+bool DirtyRegionTracker::crossesRowBoundary(const QImage &frame, int row, int firstCol, int lastCol) const
+{
+    // 边界两侧的像素行都没有笔画边缘时视为行间空白，否则有文字跨过
+    const int bytesPerPixel = frame.depth() / 8;
+    const int left = firstCol * tile.width();
+    const int right = qMin((lastCol + 1) * tile.width(), frameSize.width());
+    const int y = row * tile.height();
+    for (int line = y - 1; line <= y; ++line) {
+        if (rowHasInk(frame.constScanLine(line), left, right, bytesPerPixel)) return true;
+    }
+    return false;
+}
+
+QVector<QRect> DirtyRegionTracker::update(const QImage &frame)
+{
+    QVector<QRect> regions;
+    if (frame.isNull()) return regions;
+
+    // 分辨率或格式变化时整帧失效（哈希清零，下一次比较必然不同）
+    if (frame.size() != frameSize || frame.format() != frameFormat) {
+        frameSize = frame.size();
+        frameFormat = frame.format();
+        cols = (frameSize.width() + tile.width() - 1) / tile.width();
+        rows = (frameSize.height() + tile.height() - 1) / tile.height();
+        hashes.fill(0, cols * rows);
+        dirtyFlags.fill(true, cols * rows);
+        runs.clear();
+    }
+
+    const int bytesPerPixel = frame.depth() / 8;
+    const qsizetype bytesPerLine = frame.bytesPerLine();
+    const uchar *bits = frame.constBits();
+    lastDirtyTiles = 0;
+
+    // 每个瓦片行内连续的脏瓦片为一块（瓦片坐标）
+    QVector<QRect> blocks;
+    for (int r = 0; r < rows; ++r) {
+        const int y = r * tile.height();
+        const int tileRows = qMin(tile.height(), frameSize.height() - y);
+        int runStart = -1;
+        for (int c = 0; c <= cols; ++c) {
+            bool dirty = false;
+            if (c < cols) {
+                const int x = c * tile.width();
+                const int tileCols = qMin(tile.width(), frameSize.width() - x);
+                quint64 h = hashTile(bits + y * bytesPerLine + x * bytesPerPixel, bytesPerLine,
+                                     tileCols * bytesPerPixel, tileRows);
+                quint64 &prev = hashes[r * cols + c];
+                dirty = h != prev;
+                dirtyFlags[r * cols + c] = dirty;
+                if (dirty) {
+                    prev = h;
+                    ++lastDirtyTiles;
+                }
+            }
+            if (dirty && runStart < 0) {
+                runStart = c;
+            } else if (!dirty && runStart >= 0) {
+                blocks.append(QRect(runStart, r, c - runStart, 1));
+                runStart = -1;
+            }
+        }
+    }
+
+    // 扩展到完整的文字行，再与相邻的块、重叠的缓存块合并，直到不再变化
+    bool changed = !blocks.isEmpty();
+    while (changed) {
+        changed = false;
+        for (QRect &block : blocks) {
+            while (block.top() > 0 && crossesRowBoundary(frame, block.top(), block.left(), block.right())) {
+                block.setTop(block.top() - 1);
+                changed = true;
+            }
+            while (block.bottom() < rows - 1 && crossesRowBoundary(frame, block.bottom() + 1, block.left(), block.right())) {
+                block.setBottom(block.bottom() + 1);
+                changed = true;
+            }
+        }
+        for (int i = 0; i < blocks.size(); ++i) {
+            // 同一行内左右相邻的块也合并，与行内连续脏瓦片的处理一致
+            for (int j = blocks.size() - 1; j > i; --j) {
+                if (blocks[i].adjusted(-1, 0, 1, 0).intersects(blocks[j])) {
+                    blocks[i] = blocks[i].united(blocks[j]);
+                    blocks.removeAt(j);
+                    changed = true;
+                }
+            }
+            // 被覆盖的缓存文字作废，缓存块整体并入重新识别
+            for (int k = runs.size() - 1; k >= 0; --k) {
+                if (runs[k].tiles.intersects(blocks[i])) {
+                    blocks[i] = blocks[i].united(runs[k].tiles);
+                    runs.removeAt(k);
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    for (const QRect &block : blocks) {
+        regions.append(tilesToPixels(block));
+    }
+    return regions;
+}
+
+void DirtyRegionTracker::storeText(const QRect &region, const QString &text)
+{
+    if (rows == 0 || region.isEmpty()) return;
+
+    Run run;
+    run.tiles = QRect(QPoint(region.left() / tile.width(), region.top() / tile.height()),
+                      QPoint(region.right() / tile.width(), region.bottom() / tile.height()));
+    run.text = text;
+    for (int k = runs.size() - 1; k >= 0; --k) {
+        if (runs[k].tiles.intersects(run.tiles)) {
+            runs.removeAt(k);
+        }
+    }
+
+    // 按起始行、再按列排序
+    int pos = 0;
+    while (pos < runs.size() && (runs[pos].tiles.top() < run.tiles.top() ||
+                                 (runs[pos].tiles.top() == run.tiles.top() && runs[pos].tiles.left() < run.tiles.left()))) {
+        ++pos;
+    }
+    runs.insert(pos, run);
+}
+
+QString DirtyRegionTracker::text() const
+{
+    // 起始于同一瓦片行的块用空格连接，不同行换行
+    QStringList lines;
+    QStringList parts;
+    int row = -1;
+    for (const Run &run : runs) {
+        if (run.text.isEmpty()) continue;
+        if (run.tiles.top() != row && !parts.isEmpty()) {
+            lines << parts.join(' ');
+            parts.clear();
+        }
+        row = run.tiles.top();
+        parts << run.text;
+    }
+    if (!parts.isEmpty()) {
+        lines << parts.join(' ');
+    }
+    return lines.join('\n');
+}
+
+bool DirtyRegionTracker::isDirty(const QRect &region) const
+{
+    if (cols == 0 || rows == 0) return true;
+    const QRect rect = region.intersected(QRect(QPoint(0, 0), frameSize));
+    if (rect.isEmpty()) return false;
+
+    const int firstCol = rect.left() / tile.width();
+    const int lastCol = rect.right() / tile.width();
+    const int firstRow = rect.top() / tile.height();
+    const int lastRow = rect.bottom() / tile.height();
+    for (int r = firstRow; r <= lastRow; ++r) {
+        for (int c = firstCol; c <= lastCol; ++c) {
+            if (dirtyFlags[r * cols + c]) return true;
+        }
+    }
+    return false;
+}
+
+QRect DirtyRegionTracker::dirtyBounds() const
+{
+    QRect bounds;
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            if (dirtyFlags[r * cols + c]) {
+                bounds = bounds.united(tilesToPixels(QRect(c, r, 1, 1)));
+            }
+        }
+    }
+    return bounds;
+}
+
+int DirtyRegionTracker::dirtyTileCount() const
+{
+    return lastDirtyTiles;
+}
+
+int DirtyRegionTracker::tileCount() const
+{
+    return cols * rows;
+}
+
+void DirtyRegionTracker::reset()
+{
+    frameSize = QSize();
+    frameFormat = QImage::Format_Invalid;
+    cols = 0;
+    rows = 0;
+    hashes.clear();
+    dirtyFlags.clear();
+    runs.clear();
+    lastDirtyTiles = 0;
+}
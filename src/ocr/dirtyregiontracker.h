@@ -0,0 +1,75 @@
+#ifndef DIRTYREGIONTRACKER_H
+#define DIRTYREGIONTRACKER_H
+
+#include <QtCore/qglobal.h>
+
+#ifndef OCR_EXPORT
+#ifdef OCR_LIBRARY
+#define OCR_EXPORT Q_DECL_EXPORT
+#else
+#define OCR_EXPORT Q_DECL_IMPORT
+#endif
+#endif
+
+#include <QImage>
+#include <QRect>
+#include <QSize>
+#include <QString>
+#include <QVector>
+
+// 分块哈希脏区域检测
+// 每帧按瓦片计算哈希并与上一帧比较，只有变化的瓦片需要重新识别。
+// 变化的瓦片合并成块：同一瓦片行内相邻的合并，有墨迹跨过瓦片行边界时向上下扩展，
+// 保证一行文字不会被切成两半分别识别。识别结果按块缓存，未变化区域直接复用缓存文字。
+class OCR_EXPORT DirtyRegionTracker
+{
+public:
+    explicit DirtyRegionTracker(const QSize &tileSize = QSize(128, 32));
+
+    void setTileSize(const QSize &size);
+    QSize tileSize() const;
+
+    // 对新帧分块哈希，返回需要重新识别的区域（合并、扩展到完整文字行后的脏块）
+    QVector<QRect> update(const QImage &frame);
+
+    // 保存update()返回区域的识别结果
+    void storeText(const QRect &region, const QString &text);
+
+    // 按屏幕位置拼接所有缓存文字
+    QString text() const;
+
+    // 区域内是否有瓦片在最近一次update()中发生变化
+    bool isDirty(const QRect &region) const;
+
+    // 最近一次update()中所有变化瓦片的外接矩形
+    QRect dirtyBounds() const;
+
+    int dirtyTileCount() const;
+    int tileCount() const;
+    void reset();
+
+    // 64位四路并行哈希，每次处理32字节，便于编译器向量化
+    static quint64 hashTile(const uchar *bits, qsizetype bytesPerLine, int bytesPerRow, int rows);
+
+private:
+    struct Run {
+        QRect tiles; // 瓦片坐标
+        QString text;
+    };
+
+    QRect tilesToPixels(const QRect &tiles) const;
+    // 第row个瓦片行的上边界在[firstCol, lastCol]范围内是否有墨迹穿过
+    bool crossesRowBoundary(const QImage &frame, int row, int firstCol, int lastCol) const;
+
+    QSize tile;
+    QSize frameSize;
+    QImage::Format frameFormat;
+    int cols;
+    int rows;
+    QVector<quint64> hashes;
+    QVector<bool> dirtyFlags;
+    QVector<Run> runs; // 缓存的块，互不重叠
+    int lastDirtyTiles;
+};
+
+#endif // DIRTYREGIONTRACKER_H
@@ -0,0 +1,258 @@
+#include "framerecording.h"
+#include "scanpipeline.h"
+#include <QElapsedTimer>
+#include <QThread>
+#include <QDebug>
+#include <cstring>
+
+static const char FRAME_MAGIC[8] = {'O', 'C', 'R', 'F', 'R', 'A', 'M', 'E'};
+static const quint32 FRAME_VERSION = 1;
+static const qint64 HEADER_SIZE = 64;
+static const qint64 RECORD_HEADER_SIZE = 64;
+
+static_assert(sizeof(FrameFileHeader) == HEADER_SIZE, "FrameFileHeader must be 64 bytes");
+
+static quint64 alignTo64(quint64 value)
+{
+    return (value + 63) & ~quint64(63);
+}
+
+FrameRecorder::FrameRecorder()
+    : headerWritten(false)
+{
+    memset(&header, 0, sizeof(header));
+}
+
+FrameRecorder::~FrameRecorder()
+{
+    close();
+}
+
+bool FrameRecorder::open(const QString &path)
+{
+    close();
+    file.setFileName(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        error = file.errorString();
+        qDebug() << "Failed to open recording" << path << error;
+        return false;
+    }
+    memset(&header, 0, sizeof(header));
+    headerWritten = false;
+    error.clear();
+    return true;
+}
+
+bool FrameRecorder::writeHeader()
+{
+    if (!file.seek(0) || file.write(reinterpret_cast<const char *>(&header), sizeof(header)) != qint64(sizeof(header))) {
+        error = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool FrameRecorder::append(const QImage &frame, qint64 timestampMs)
+{
+    if (!file.isOpen() || frame.isNull()) return false;
+
+    const QImage image = frame.format() == QImage::Format_Grayscale8 ? frame : frame.convertToFormat(QImage::Format_ARGB32);
+
+    if (!headerWritten) {
+        memcpy(header.magic, FRAME_MAGIC, sizeof(header.magic));
+        header.version = FRAME_VERSION;
+        header.width = quint32(image.width());
+        header.height = quint32(image.height());
+        header.format = quint32(image.format());
+        header.bytesPerLine = quint32(image.bytesPerLine());
+        header.frameCount = 0;
+        header.frameStride = alignTo64(RECORD_HEADER_SIZE + quint64(image.bytesPerLine()) * image.height());
+        if (!writeHeader()) return false;
+        headerWritten = true;
+    }
+
+    if (quint32(image.width()) != header.width || quint32(image.height()) != header.height ||
+        quint32(image.format()) != header.format) {
+        error = QStringLiteral("frame size or format differs from the first frame");
+        return false;
+    }
+
+    const qint64 offset = HEADER_SIZE + qint64(header.frameCount) * qint64(header.frameStride);
+    char record[RECORD_HEADER_SIZE];
+    memset(record, 0, sizeof(record));
+    memcpy(record, &timestampMs, sizeof(timestampMs));
+
+    const qint64 pixelBytes = qint64(header.bytesPerLine) * header.height;
+    const QByteArray padding(int(qint64(header.frameStride) - RECORD_HEADER_SIZE - pixelBytes), '\0');
+    if (!file.seek(offset) || file.write(record, sizeof(record)) != qint64(sizeof(record)) ||
+        file.write(reinterpret_cast<const char *>(image.constBits()), pixelBytes) != pixelBytes ||
+        file.write(padding) != padding.size()) {
+        error = file.errorString();
+        return false;
+    }
+    ++header.frameCount;
+    return true;
+}
+
+void FrameRecorder::close()
+{
+    if (!file.isOpen()) return;
+    // 帧数最后写回；未正常关闭的文件回放时按文件长度推算帧数
+    if (headerWritten) {
+        writeHeader();
+    }
+    file.close();
+}
+
+bool FrameRecorder::isOpen() const
+{
+    return file.isOpen();
+}
+
+int FrameRecorder::frameCount() const
+{
+    return int(header.frameCount);
+}
+
+QString FrameRecorder::errorString() const
+{
+    return error;
+}
+
+FrameReplaySource::FrameReplaySource()
+    : data(nullptr)
+{
+    memset(&header, 0, sizeof(header));
+}
+
+FrameReplaySource::~FrameReplaySource()
+{
+    close();
+}
+
+bool FrameReplaySource::open(const QString &path)
+{
+    close();
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = file.errorString();
+        return false;
+    }
+    const qint64 size = file.size();
+    if (size < HEADER_SIZE) {
+        error = QStringLiteral("file too small");
+        close();
+        return false;
+    }
+
+    data = file.map(0, size);
+    if (!data) {
+        error = file.errorString();
+        close();
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+
+    const bool formatOk = header.format == quint32(QImage::Format_Grayscale8) || header.format == quint32(QImage::Format_ARGB32);
+    const quint64 pixelBytes = quint64(header.bytesPerLine) * header.height;
+    if (memcmp(header.magic, FRAME_MAGIC, sizeof(header.magic)) != 0 || header.version != FRAME_VERSION || !formatOk ||
+        header.width == 0 || header.height == 0 || header.frameStride < RECORD_HEADER_SIZE + pixelBytes) {
+        error = QStringLiteral("not a frame recording");
+        close();
+        return false;
+    }
+
+    // 录制未正常结束时文件头中的帧数为0，按完整帧的数量回放
+    const quint64 available = quint64(size - HEADER_SIZE) / header.frameStride;
+    if (header.frameCount == 0 || header.frameCount > available) {
+        header.frameCount = quint32(available);
+    }
+    error.clear();
+    return true;
+}
+
+void FrameReplaySource::close()
+{
+    if (data) {
+        file.unmap(const_cast<uchar *>(data));
+        data = nullptr;
+    }
+    if (file.isOpen()) {
+        file.close();
+    }
+    memset(&header, 0, sizeof(header));
+}
+
+bool FrameReplaySource::isOpen() const
+{
+    return data != nullptr;
+}
+
+int FrameReplaySource::frameCount() const
+{
+    return int(header.frameCount);
+}
+
+QSize FrameReplaySource::frameSize() const
+{
+    return QSize(int(header.width), int(header.height));
+}
+
+QImage::Format FrameReplaySource::format() const
+{
+    return data ? QImage::Format(header.format) : QImage::Format_Invalid;
+}
+
+qint64 FrameReplaySource::timestamp(int index) const
+{
+    if (!data || index < 0 || index >= frameCount()) return -1;
+    qint64 value = 0;
+    memcpy(&value, data + HEADER_SIZE + qint64(index) * qint64(header.frameStride), sizeof(value));
+    return value;
+}
+
+QImage FrameReplaySource::frame(int index) const
+{
+    if (!data || index < 0 || index >= frameCount()) return QImage();
+    const uchar *bits = data + HEADER_SIZE + qint64(index) * qint64(header.frameStride) + RECORD_HEADER_SIZE;
+    return QImage(bits, int(header.width), int(header.height), int(header.bytesPerLine), QImage::Format(header.format));
+}
+
+int FrameReplaySource::replay(ScanPipeline *pipeline, Pacing pacing)
+{
+    if (!data || !pipeline || !pipeline->isRunning()) return 0;
+
+    // 原始节奏下与实时采集一样，下游忙时丢帧；全速回放时每一帧都要处理
+    const bool wasLossless = pipeline->isLossless();
+    pipeline->setLossless(pacing == AsFastAsPossible);
+    const quint64 doneBefore = pipeline->processedFrames() + pipeline->droppedFrames();
+
+    QElapsedTimer clock;
+    clock.start();
+    const qint64 firstTimestamp = timestamp(0);
+    int submitted = 0;
+    for (int i = 0; i < frameCount() && pipeline->isRunning(); ++i) {
+        if (pacing == OriginalCadence) {
+            const qint64 due = timestamp(i) - firstTimestamp;
+            const qint64 wait = due - clock.elapsed();
+            if (wait > 0) {
+                QThread::msleep(static_cast<unsigned long>(wait));
+            }
+        }
+        // 流水线会留住上一帧做滚动估计，拷出映射区，避免关闭文件后悬空
+        pipeline->submitFrame(frame(i).copy());
+        ++submitted;
+    }
+
+    // 等所有帧处理完或被丢弃后再返回，调用方拿到的统计才完整
+    while (pipeline->isRunning() && pipeline->processedFrames() + pipeline->droppedFrames() - doneBefore < quint64(submitted)) {
+        QThread::msleep(1);
+    }
+    pipeline->setLossless(wasLossless);
+    return submitted;
+}
+
+QString FrameReplaySource::errorString() const
+{
+    return error;
+}
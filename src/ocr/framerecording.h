@@ -0,0 +1,101 @@
+#ifndef FRAMERECORDING_H
+#define FRAMERECORDING_H
+
+#include <QtCore/qglobal.h>
+
+#ifndef OCR_EXPORT
+#ifdef OCR_LIBRARY
+#define OCR_EXPORT Q_DECL_EXPORT
+#else
+#define OCR_EXPORT Q_DECL_IMPORT
+#endif
+#endif
+
+#include <QFile>
+#include <QImage>
+#include <QSize>
+#include <QString>
+
+class ScanPipeline;
+
+// 录制帧文件格式（本机字节序）：
+//   文件头 64字节：magic "OCRFRAME"，版本，宽，高，像素格式，每行字节数，帧数
+//   之后每帧占固定的frameStride字节：64字节帧头（毫秒时间戳）+ 像素数据
+// 帧长度固定，可按序号直接定位；像素数据按64字节对齐，映射后可直接作为QImage使用。
+// 像素格式只有Grayscale8和ARGB32两种，其他格式录制时转为ARGB32。
+struct FrameFileHeader {
+    char magic[8];
+    quint32 version;
+    quint32 width;
+    quint32 height;
+    quint32 format;       // QImage::Format
+    quint32 bytesPerLine;
+    quint32 frameCount;
+    quint64 frameStride;
+    char reserved[24];
+};
+
+// 录制帧写入器
+class OCR_EXPORT FrameRecorder
+{
+public:
+    FrameRecorder();
+    ~FrameRecorder();
+
+    bool open(const QString &path);
+    // 第一帧决定尺寸和格式，之后尺寸不同的帧会被拒绝；timestampMs为相对录制开始的时间
+    bool append(const QImage &frame, qint64 timestampMs);
+    // 写回帧数并关闭文件
+    void close();
+
+    bool isOpen() const;
+    int frameCount() const;
+    QString errorString() const;
+
+private:
+    bool writeHeader();
+
+    QFile file;
+    FrameFileHeader header;
+    bool headerWritten;
+    QString error;
+};
+
+// 录制帧回放
+// 文件整体内存映射，frame()返回直接引用映射内存的QImage，不复制像素。
+class OCR_EXPORT FrameReplaySource
+{
+public:
+    enum Pacing {
+        OriginalCadence,  // 按录制时的时间间隔提交
+        AsFastAsPossible  // 不等待，流水线处理完一帧立即提交下一帧
+    };
+
+    FrameReplaySource();
+    ~FrameReplaySource();
+
+    bool open(const QString &path);
+    // 关闭后之前frame()返回的图像全部失效
+    void close();
+    bool isOpen() const;
+
+    int frameCount() const;
+    QSize frameSize() const;
+    QImage::Format format() const;
+    qint64 timestamp(int index) const;
+    QImage frame(int index) const;
+
+    // 在调用线程中把所有帧依次提交给流水线，返回提交的帧数。
+    // 流水线切换为无丢帧模式，返回前等待最后一帧处理完成；提交的是帧的拷贝，返回后可以关闭文件
+    int replay(ScanPipeline *pipeline, Pacing pacing);
+
+    QString errorString() const;
+
+private:
+    QFile file;
+    const uchar *data;
+    FrameFileHeader header;
+    QString error;
+};
+
+#endif // FRAMERECORDING_H
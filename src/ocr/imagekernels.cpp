@@ -0,0 +1,432 @@
+#include "imagekernels.h"
+#include <QAtomicInt>
+#include <QVector>
+#include <cmath>
+
+#if defined(__GNUC__) && defined(__SSE2__)
+#define IMAGEKERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+static QAtomicInt maxLevel(ImageKernels::AVX2);
+
+// ==================== 标量实现 ====================
+
+static void grayRowScalar(const quint32 *src, uchar *dst, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        const quint32 p = src[i];
+        const quint32 r = (p >> 16) & 0xFF;
+        const quint32 g = (p >> 8) & 0xFF;
+        const quint32 b = p & 0xFF;
+        dst[i] = uchar((r * 77 + g * 150 + b * 29 + 128) >> 8);
+    }
+}
+
+static void downscale2RowScalar(const uchar *row0, const uchar *row1, uchar *dst, int outWidth)
+{
+    for (int x = 0; x < outWidth; ++x) {
+        dst[x] = uchar((row0[2 * x] + row0[2 * x + 1] + row1[2 * x] + row1[2 * x + 1] + 2) >> 2);
+    }
+}
+
+static void thresholdRowScalar(const uchar *src, uchar *dst, int count, uchar level)
+{
+    for (int i = 0; i < count; ++i) {
+        dst[i] = src[i] >= level ? 255 : 0;
+    }
+}
+
+#ifdef IMAGEKERNELS_X86
+
+// ==================== SSE2实现 ====================
+
+// 4个像素一组：每个32位通道取出B/G/R，16位乘法足够容纳加权和
+static inline __m128i grayLanesSse2(__m128i px)
+{
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    const __m128i b = _mm_and_si128(px, mask);
+    const __m128i g = _mm_and_si128(_mm_srli_epi32(px, 8), mask);
+    const __m128i r = _mm_and_si128(_mm_srli_epi32(px, 16), mask);
+    __m128i sum = _mm_mullo_epi16(r, _mm_set1_epi32(77));
+    sum = _mm_add_epi16(sum, _mm_mullo_epi16(g, _mm_set1_epi32(150)));
+    sum = _mm_add_epi16(sum, _mm_mullo_epi16(b, _mm_set1_epi32(29)));
+    sum = _mm_add_epi16(sum, _mm_set1_epi32(128));
+    return _mm_srli_epi32(sum, 8);
+}
+
+static void grayRowSse2(const quint32 *src, uchar *dst, int count)
+{
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i y0 = grayLanesSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+        const __m128i y1 = grayLanesSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 4)));
+        const __m128i y2 = grayLanesSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8)));
+        const __m128i y3 = grayLanesSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 12)));
+        const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(y0, y1), _mm_packs_epi32(y2, y3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), packed);
+    }
+    grayRowScalar(src + i, dst + i, count - i);
+}
+
+// 16个输入字节 -> 8个16位的相邻两像素之和
+static inline __m128i pairSumSse2(__m128i v)
+{
+    return _mm_add_epi16(_mm_and_si128(v, _mm_set1_epi16(0x00FF)), _mm_srli_epi16(v, 8));
+}
+
+// 与标量实现相同：四个像素在16位通道中求和，+2后右移2位，只舍入一次
+static inline __m128i quadAverageSse2(const uchar *row0, const uchar *row1)
+{
+    const __m128i top = pairSumSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row0)));
+    const __m128i bottom = pairSumSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row1)));
+    return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(top, bottom), _mm_set1_epi16(2)), 2);
+}
+
+static void downscale2RowSse2(const uchar *row0, const uchar *row1, uchar *dst, int outWidth)
+{
+    int x = 0;
+    for (; x + 16 <= outWidth; x += 16) {
+        const __m128i h0 = quadAverageSse2(row0 + 2 * x, row1 + 2 * x);
+        const __m128i h1 = quadAverageSse2(row0 + 2 * x + 16, row1 + 2 * x + 16);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(h0, h1));
+    }
+    downscale2RowScalar(row0 + 2 * x, row1 + 2 * x, dst + x, outWidth - x);
+}
+
+static void thresholdRowSse2(const uchar *src, uchar *dst, int count, uchar level)
+{
+    const __m128i t = _mm_set1_epi8(char(level));
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        // max(v, t) == v 即 v >= t，无符号比较
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_cmpeq_epi8(_mm_max_epu8(v, t), v));
+    }
+    thresholdRowScalar(src + i, dst + i, count - i, level);
+}
+
+// ==================== AVX2实现 ====================
+
+__attribute__((target("avx2")))
+static inline __m256i grayLanesAvx2(__m256i px)
+{
+    const __m256i mask = _mm256_set1_epi32(0xFF);
+    const __m256i b = _mm256_and_si256(px, mask);
+    const __m256i g = _mm256_and_si256(_mm256_srli_epi32(px, 8), mask);
+    const __m256i r = _mm256_and_si256(_mm256_srli_epi32(px, 16), mask);
+    __m256i sum = _mm256_mullo_epi16(r, _mm256_set1_epi32(77));
+    sum = _mm256_add_epi16(sum, _mm256_mullo_epi16(g, _mm256_set1_epi32(150)));
+    sum = _mm256_add_epi16(sum, _mm256_mullo_epi16(b, _mm256_set1_epi32(29)));
+    sum = _mm256_add_epi16(sum, _mm256_set1_epi32(128));
+    return _mm256_srli_epi32(sum, 8);
+}
+
+__attribute__((target("avx2")))
+static void grayRowAvx2(const quint32 *src, uchar *dst, int count)
+{
+    // pack指令在128位通道内交错，最后按32位分组重排回顺序
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    int i = 0;
+    for (; i + 32 <= count; i += 32) {
+        const __m256i y0 = grayLanesAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)));
+        const __m256i y1 = grayLanesAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 8)));
+        const __m256i y2 = grayLanesAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 16)));
+        const __m256i y3 = grayLanesAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 24)));
+        const __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(y0, y1), _mm256_packs_epi32(y2, y3));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_permutevar8x32_epi32(packed, order));
+    }
+    grayRowSse2(src + i, dst + i, count - i);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i quadAverageAvx2(const uchar *row0, const uchar *row1)
+{
+    const __m256i lowMask = _mm256_set1_epi16(0x00FF);
+    const __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row0));
+    const __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row1));
+    const __m256i top = _mm256_add_epi16(_mm256_and_si256(v0, lowMask), _mm256_srli_epi16(v0, 8));
+    const __m256i bottom = _mm256_add_epi16(_mm256_and_si256(v1, lowMask), _mm256_srli_epi16(v1, 8));
+    return _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(top, bottom), _mm256_set1_epi16(2)), 2);
+}
+
+__attribute__((target("avx2")))
+static void downscale2RowAvx2(const uchar *row0, const uchar *row1, uchar *dst, int outWidth)
+{
+    int x = 0;
+    for (; x + 32 <= outWidth; x += 32) {
+        const __m256i h0 = quadAverageAvx2(row0 + 2 * x, row1 + 2 * x);
+        const __m256i h1 = quadAverageAvx2(row0 + 2 * x + 32, row1 + 2 * x + 32);
+        // packus在128位通道内交错，按64位分组重排
+        const __m256i packed = _mm256_packus_epi16(h0, h1);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x), _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+    downscale2RowSse2(row0 + 2 * x, row1 + 2 * x, dst + x, outWidth - x);
+}
+
+__attribute__((target("avx2")))
+static void thresholdRowAvx2(const uchar *src, uchar *dst, int count, uchar level)
+{
+    const __m256i t = _mm256_set1_epi8(char(level));
+    int i = 0;
+    for (; i + 32 <= count; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_cmpeq_epi8(_mm256_max_epu8(v, t), v));
+    }
+    thresholdRowSse2(src + i, dst + i, count - i, level);
+}
+
+#endif // IMAGEKERNELS_X86
+
+// ==================== 分发 ====================
+
+ImageKernels::SimdLevel ImageKernels::detectedLevel()
+{
+#ifdef IMAGEKERNELS_X86
+    static const SimdLevel level = []() {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") ? AVX2 : SSE2;
+    }();
+    return level;
+#else
+    return Scalar;
+#endif
+}
+
+ImageKernels::SimdLevel ImageKernels::activeLevel()
+{
+    return SimdLevel(qMin(int(detectedLevel()), maxLevel.loadRelaxed()));
+}
+
+void ImageKernels::setMaxLevel(SimdLevel level)
+{
+    maxLevel.storeRelaxed(level);
+}
+
+QImage ImageKernels::toGray(const QImage &image)
+{
+    if (image.isNull()) return QImage();
+    if (image.format() == QImage::Format_Grayscale8) return image;
+
+    QImage src = image;
+    if (src.format() != QImage::Format_ARGB32 && src.format() != QImage::Format_RGB32 &&
+        src.format() != QImage::Format_ARGB32_Premultiplied) {
+        src = src.convertToFormat(QImage::Format_RGB32);
+    }
+
+    QImage gray(src.size(), QImage::Format_Grayscale8);
+    const SimdLevel level = activeLevel();
+    for (int y = 0; y < src.height(); ++y) {
+        const quint32 *in = reinterpret_cast<const quint32*>(src.constScanLine(y));
+        uchar *out = gray.scanLine(y);
+        switch (level) {
+#ifdef IMAGEKERNELS_X86
+        case AVX2: grayRowAvx2(in, out, src.width()); break;
+        case SSE2: grayRowSse2(in, out, src.width()); break;
+#endif
+        default: grayRowScalar(in, out, src.width()); break;
+        }
+    }
+    return gray;
+}
+
+QImage ImageKernels::downscale(const QImage &gray, int factor)
+{
+    if (gray.isNull() || factor <= 1) return gray;
+    const QImage src = gray.format() == QImage::Format_Grayscale8 ? gray : toGray(gray);
+    const int outWidth = src.width() / factor;
+    const int outHeight = src.height() / factor;
+    if (outWidth == 0 || outHeight == 0) return src;
+
+    QImage out(outWidth, outHeight, QImage::Format_Grayscale8);
+    const SimdLevel level = activeLevel();
+
+    if (factor == 2) {
+        for (int y = 0; y < outHeight; ++y) {
+            const uchar *row0 = src.constScanLine(2 * y);
+            const uchar *row1 = src.constScanLine(2 * y + 1);
+            uchar *dst = out.scanLine(y);
+            switch (level) {
+#ifdef IMAGEKERNELS_X86
+            case AVX2: downscale2RowAvx2(row0, row1, dst, outWidth); break;
+            case SSE2: downscale2RowSse2(row0, row1, dst, outWidth); break;
+#endif
+            default: downscale2RowScalar(row0, row1, dst, outWidth); break;
+            }
+        }
+        return out;
+    }
+
+    // 任意整数倍：逐行累加到列和，再按块求平均
+    QVector<quint32> sums(outWidth);
+    const quint32 area = quint32(factor * factor);
+    for (int y = 0; y < outHeight; ++y) {
+        sums.fill(0);
+        for (int dy = 0; dy < factor; ++dy) {
+            const uchar *row = src.constScanLine(y * factor + dy);
+            for (int x = 0; x < outWidth; ++x) {
+                const uchar *p = row + x * factor;
+                quint32 s = 0;
+                for (int dx = 0; dx < factor; ++dx) {
+                    s += p[dx];
+                }
+                sums[x] += s;
+            }
+        }
+        uchar *dst = out.scanLine(y);
+        for (int x = 0; x < outWidth; ++x) {
+            dst[x] = uchar((sums[x] + area / 2) / area);
+        }
+    }
+    return out;
+}
+
+int ImageKernels::otsuThreshold(const QImage &gray)
+{
+    if (gray.isNull()) return 128;
+    const QImage src = gray.format() == QImage::Format_Grayscale8 ? gray : toGray(gray);
+
+    // 4个子直方图交替累加，避免相邻像素写同一计数器的依赖
+    quint32 hist[4][256] = {};
+    for (int y = 0; y < src.height(); ++y) {
+        const uchar *row = src.constScanLine(y);
+        int x = 0;
+        for (; x + 4 <= src.width(); x += 4) {
+            ++hist[0][row[x]];
+            ++hist[1][row[x + 1]];
+            ++hist[2][row[x + 2]];
+            ++hist[3][row[x + 3]];
+        }
+        for (; x < src.width(); ++x) {
+            ++hist[0][row[x]];
+        }
+    }
+
+    double total = 0.0;
+    double sumAll = 0.0;
+    double counts[256];
+    for (int i = 0; i < 256; ++i) {
+        counts[i] = double(hist[0][i]) + hist[1][i] + hist[2][i] + hist[3][i];
+        total += counts[i];
+        sumAll += i * counts[i];
+    }
+
+    double weightBackground = 0.0;
+    double sumBackground = 0.0;
+    double bestVariance = -1.0;
+    int best = 128;
+    for (int t = 0; t < 256; ++t) {
+        weightBackground += counts[t];
+        if (weightBackground == 0.0) continue;
+        const double weightForeground = total - weightBackground;
+        if (weightForeground == 0.0) break;
+        sumBackground += t * counts[t];
+        const double meanBackground = sumBackground / weightBackground;
+        const double meanForeground = (sumAll - sumBackground) / weightForeground;
+        const double diff = meanBackground - meanForeground;
+        const double variance = weightBackground * weightForeground * diff * diff;
+        if (variance > bestVariance) {
+            bestVariance = variance;
+            best = t + 1;
+        }
+    }
+    return best;
+}
+
+QImage ImageKernels::threshold(const QImage &gray, int level)
+{
+    if (gray.isNull()) return QImage();
+    const QImage src = gray.format() == QImage::Format_Grayscale8 ? gray : toGray(gray);
+    const uchar t = uchar(qBound(0, level, 255));
+
+    QImage out(src.size(), QImage::Format_Grayscale8);
+    const SimdLevel simd = activeLevel();
+    for (int y = 0; y < src.height(); ++y) {
+        const uchar *in = src.constScanLine(y);
+        uchar *dst = out.scanLine(y);
+        switch (simd) {
+#ifdef IMAGEKERNELS_X86
+        case AVX2: thresholdRowAvx2(in, dst, src.width(), t); break;
+        case SSE2: thresholdRowSse2(in, dst, src.width(), t); break;
+#endif
+        default: thresholdRowScalar(in, dst, src.width(), t); break;
+        }
+    }
+    return out;
+}
+
+QImage ImageKernels::sauvola(const QImage &gray, int window, double k)
+{
+    if (gray.isNull()) return QImage();
+    const QImage src = gray.format() == QImage::Format_Grayscale8 ? gray : toGray(gray);
+    const int width = src.width();
+    const int height = src.height();
+    const int radius = qMax(1, window / 2);
+    const double dynamicRange = 128.0;
+
+    // 列方向滑动窗口和，内存只占O(width)，4K屏也不需要整幅积分图
+    QVector<quint32> colSum(width, 0);
+    QVector<quint64> colSq(width, 0);
+    auto addRow = [&](int y, int sign) {
+        const uchar *row = src.constScanLine(y);
+        for (int x = 0; x < width; ++x) {
+            const quint32 v = row[x];
+            if (sign > 0) {
+                colSum[x] += v;
+                colSq[x] += v * v;
+            } else {
+                colSum[x] -= v;
+                colSq[x] -= v * v;
+            }
+        }
+    };
+
+    for (int y = 0; y < qMin(radius, height); ++y) {
+        addRow(y, 1);
+    }
+
+    QImage out(src.size(), QImage::Format_Grayscale8);
+    for (int y = 0; y < height; ++y) {
+        if (y + radius < height) addRow(y + radius, 1);
+        if (y - radius - 1 >= 0) addRow(y - radius - 1, -1);
+        const int rowsInWindow = qMin(height - 1, y + radius) - qMax(0, y - radius) + 1;
+
+        const uchar *in = src.constScanLine(y);
+        uchar *dst = out.scanLine(y);
+        quint64 sum = 0;
+        quint64 sq = 0;
+        for (int x = 0; x < qMin(radius, width); ++x) {
+            sum += colSum[x];
+            sq += colSq[x];
+        }
+        for (int x = 0; x < width; ++x) {
+            if (x + radius < width) {
+                sum += colSum[x + radius];
+                sq += colSq[x + radius];
+            }
+            if (x - radius - 1 >= 0) {
+                sum -= colSum[x - radius - 1];
+                sq -= colSq[x - radius - 1];
+            }
+            const int colsInWindow = qMin(width - 1, x + radius) - qMax(0, x - radius) + 1;
+            const double n = double(rowsInWindow) * colsInWindow;
+            const double mean = sum / n;
+            const double variance = qMax(0.0, sq / n - mean * mean);
+            const double t = mean * (1.0 + k * (std::sqrt(variance) / dynamicRange - 1.0));
+            dst[x] = in[x] > t ? 255 : 0;
+        }
+    }
+    return out;
+}
+
+QImage ImageKernels::binarize(const QImage &gray, Binarization mode)
+{
+    switch (mode) {
+    case OtsuBinarization:
+        return threshold(gray, otsuThreshold(gray));
+    case SauvolaBinarization:
+        return sauvola(gray);
+    default:
+        return gray;
+    }
+}
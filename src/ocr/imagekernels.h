@@ -0,0 +1,54 @@
+#ifndef IMAGEKERNELS_H
+#define IMAGEKERNELS_H
+
+#include <QtCore/qglobal.h>
+
+#ifndef OCR_EXPORT
+#ifdef OCR_LIBRARY
+#define OCR_EXPORT Q_DECL_EXPORT
+#else
+#define OCR_EXPORT Q_DECL_IMPORT
+#endif
+#endif
+
+#include <QImage>
+
+// OCR输入预处理内核：灰度化、降采样、二值化
+// x86上按运行时检测的指令集选择AVX2/SSE2实现，其他平台使用标量实现。
+class OCR_EXPORT ImageKernels
+{
+public:
+    enum SimdLevel {
+        Scalar,
+        SSE2,
+        AVX2
+    };
+
+    enum Binarization {
+        NoBinarization,
+        OtsuBinarization,
+        SauvolaBinarization
+    };
+
+    static SimdLevel detectedLevel();
+    static SimdLevel activeLevel();
+    // 强制使用不高于level的实现，用于基准测试和对比
+    static void setMaxLevel(SimdLevel level);
+
+    // ARGB32/RGB32 -> Grayscale8，系数 (77R + 150G + 29B) / 256
+    static QImage toGray(const QImage &image);
+
+    // 灰度图按整数倍做面积平均降采样
+    static QImage downscale(const QImage &gray, int factor);
+
+    // 大津法全局阈值
+    static int otsuThreshold(const QImage &gray);
+    // 大于等于阈值的像素置255，其余置0
+    static QImage threshold(const QImage &gray, int level);
+    // Sauvola局部自适应阈值，window为窗口边长，k通常取0.2~0.5
+    static QImage sauvola(const QImage &gray, int window = 25, double k = 0.34);
+
+    static QImage binarize(const QImage &gray, Binarization mode);
+};
+
+#endif // IMAGEKERNELS_H
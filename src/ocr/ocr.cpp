@@ -1,83 +1,341 @@
 #include "ocr.h"
-#include <QApplication>
+#include "screenscanner.h"
+#include "activewindow.h"
+#include "recognizerpool.h"
+#include "workerprocesspool.h"
+#include "screenhistoryindex.h"
+#include <QGuiApplication>
 #include <QScreen>
-#include <QPixmap>
-#include <QPainter>
-#include <QBuffer>
+#include <QStringList>
+#include <QThread>
 #include <QDebug>
-#include <QProcess>
-#include <QTemporaryFile>
-#include <QDir>
 
-OCRModule::OCRModule(QObject *parent) : QObject(parent), scanning(false) {
-    timer = new QTimer(this);
-    connect(timer, &QTimer::timeout, this, &OCRModule::onTimeout);
+static const int FOLLOW_INTERVAL_MS = 200; // 前台窗口位置的查询间隔
+
+// 最大屏幕一帧灰度图的字节数，决定共享内存帧环的槽位大小
+static qint64 maxFrameBytes() {
+    qint64 bytes = 0;
+    for (QScreen *screen : QGuiApplication::screens()) {
+        const QSize size = screen->geometry().size() * screen->devicePixelRatio();
+        bytes = qMax(bytes, qint64((size.width() + 3) & ~3) * size.height());
+    }
+    return bytes > 0 ? bytes : qint64(3840) * 2160;
+}
+
+// 识别进程（线程）数：OCR_WORKERS优先，其次为setRecognizerCount()的设置，0表示核心数
+static int effectiveRecognizerCount(int configured) {
+    bool ok = false;
+    const int count = qEnvironmentVariableIntValue("OCR_WORKERS", &ok);
+    if (ok && count > 0) return count;
+    return configured > 0 ? configured : qMax(1, QThread::idealThreadCount());
+}
+
+// 默认在识别进程中识别；OCR_RECOGNIZER=thread或识别进程不可用时在进程内的线程池中识别
+static RegionRecognizer *createRecognizer(int configured) {
+    const int count = effectiveRecognizerCount(configured);
+    if (qgetenv("OCR_RECOGNIZER") != "thread") {
+        WorkerProcessPool *pool = new WorkerProcessPool(count, QStringLiteral("chi_sim+eng"), maxFrameBytes());
+        if (pool->start()) {
+            qDebug() << "OCR using" << pool->workerCount() << "worker processes";
+            return pool;
+        }
+        delete pool;
+        qDebug() << "OCR worker processes unavailable, recognizing in-process";
+    }
+    return new RecognizerPool(count);
+}
+
+OCRModule::OCRModule(QObject *parent) : QObject(parent), recognizerPool(nullptr), recognizers(0), history(new ScreenHistoryIndex(32 * 1024 * 1024, this)), historyAttached(false), followActive(false), minRate(1.0), maxRate(30.0), refineThreshold(70), recognitionPaused(false), scanning(false) {
+    followTimer = new QTimer(this);
+    followTimer->setInterval(FOLLOW_INTERVAL_MS);
+    connect(followTimer, &QTimer::timeout, this, &OCRModule::onFollowTimeout);
+    connect(qApp, &QGuiApplication::screenAdded, this, &OCRModule::onScreenAdded);
+    connect(qApp, &QGuiApplication::screenRemoved, this, &OCRModule::onScreenRemoved);
+    rebuildScanners();
 }
 
 OCRModule::~OCRModule() {
     stopScanning();
+    clearScanners();
 }
 
 void OCRModule::startScanning() {
     if (!scanning) {
         scanning = true;
-        timer->start(1000 / 30); // 每秒30次
+        // 识别进程只在扫描期间存在，启动程序时不加载模型
+        recognizerPool = createRecognizer(recognizers);
+        if (!historyAttached) {
+            history->attach(this);
+            historyAttached = true;
+        }
+        for (ScreenScanner *scanner : scanners) {
+            scanner->setRecognizerPool(recognizerPool);
+        }
+        if (followActive) {
+            onFollowTimeout();
+            followTimer->start();
+        }
+        // 每个屏幕的采集、预处理和识别相互独立
+        for (ScreenScanner *scanner : scanners) {
+            scanner->start();
+        }
+        emit scanRateChanged(currentScanRate());
     }
 }
 
+void OCRModule::startScanning(const QRect &region) {
+    setFollowActiveWindow(false);
+    setCaptureRegion(region);
+    startScanning();
+}
+
+void OCRModule::startScanningActiveWindow() {
+    setFollowActiveWindow(true);
+    startScanning();
+}
+
 void OCRModule::stopScanning() {
     if (scanning) {
         scanning = false;
-        timer->stop();
+        followTimer->stop();
+        for (ScreenScanner *scanner : scanners) {
+            scanner->stop();
+        }
+        // 流水线已经停止，不再使用识别池，释放识别进程和模型
+        for (ScreenScanner *scanner : scanners) {
+            scanner->setRecognizerPool(nullptr);
+        }
+        delete recognizerPool;
+        recognizerPool = nullptr;
+        updatePausedState();
+        emit scanRateChanged(0.0);
+    }
+}
+
+ScreenHistoryIndex *OCRModule::screenHistory() const {
+    return history;
+}
+
+void OCRModule::setRecognizerCount(int count) {
+    recognizers = qMax(0, count);
+}
+
+int OCRModule::recognizerCount() const {
+    return effectiveRecognizerCount(recognizers);
+}
+
+void OCRModule::setCaptureRegion(const QRect &region) {
+    if (region == captureRegion) return;
+    captureRegion = region;
+    applyCaptureRegion();
+}
+
+QRect OCRModule::getCaptureRegion() const {
+    return captureRegion;
+}
+
+void OCRModule::setFollowActiveWindow(bool follow) {
+    if (follow == followActive) return;
+    followActive = follow;
+    if (!follow) {
+        // 退出跟随模式时恢复全屏扫描
+        followTimer->stop();
+        setCaptureRegion(QRect());
+    } else if (scanning) {
+        onFollowTimeout();
+        followTimer->start();
+    }
+}
+
+bool OCRModule::followsActiveWindow() const {
+    return followActive;
+}
+
+void OCRModule::applyCaptureRegion() {
+    // 区域离开某个屏幕时，该屏幕的扫描器会发出空文字和消失的区域
+    for (ScreenScanner *scanner : scanners) {
+        scanner->setCaptureRegion(captureRegion);
+    }
+    updatePausedState();
+}
+
+void OCRModule::onFollowTimeout() {
+    // 前台窗口是本进程窗口或无法获取时保持上一次的区域
+    const QRect window = ActiveWindow::geometry();
+    if (!window.isEmpty()) {
+        setCaptureRegion(window);
+    }
+}
+
+void OCRModule::setScreens(const QList<int> &indices) {
+    screenFilter = indices;
+    rebuildScanners();
+}
+
+QList<int> OCRModule::screens() const {
+    QList<int> indices;
+    for (ScreenScanner *scanner : scanners) {
+        indices << scanner->index();
     }
+    return indices;
 }
 
-void OCRModule::onTimeout() {
-    if (!scanning) return;
+void OCRModule::setScanRateRange(double minFps, double maxFps) {
+    minRate = minFps;
+    maxRate = maxFps;
+    for (ScreenScanner *scanner : scanners) {
+        scanner->setScanRateRange(minFps, maxFps);
+    }
+}
 
-    // 获取主屏幕
-    QScreen *screen = QGuiApplication::primaryScreen();
-    if (!screen) return;
+double OCRModule::currentScanRate() const {
+    double fps = 0.0;
+    for (ScreenScanner *scanner : scanners) {
+        fps = qMax(fps, scanner->currentScanRate());
+    }
+    return fps;
+}
 
-    // 截取全屏
-    QPixmap pixmap = screen->grabWindow(0);
+double OCRModule::screenScanRate(int screen) const {
+    for (ScreenScanner *scanner : scanners) {
+        if (scanner->index() == screen) return scanner->currentScanRate();
+    }
+    return 0.0;
+}
 
-    // 保存为临时文件
-    QTemporaryFile tempFile(QDir::tempPath() + "/screen_XXXXXX.png");
-    if (!tempFile.open()) {
-        qDebug() << "Failed to create temp file";
-        return;
+double OCRModule::cacheHitRate() const {
+    quint64 hits = 0;
+    quint64 lookups = 0;
+    for (ScreenScanner *scanner : scanners) {
+        hits += scanner->cacheHits();
+        lookups += scanner->cacheHits() + scanner->cacheMisses();
     }
+    return lookups > 0 ? double(hits) / lookups : 0.0;
+}
 
-    if (!pixmap.save(&tempFile, "PNG")) {
-        qDebug() << "Failed to save screenshot";
-        return;
+void OCRModule::setRefineConfidence(int threshold) {
+    refineThreshold = threshold;
+    for (ScreenScanner *scanner : scanners) {
+        scanner->setRefineConfidence(threshold);
     }
+}
 
-    QString tempFileName = tempFile.fileName();
-    tempFile.close();
+double OCRModule::refinedAreaRatio() const {
+    quint64 refined = 0;
+    quint64 scanned = 0;
+    for (ScreenScanner *scanner : scanners) {
+        refined += scanner->refinedPixels();
+        scanned += scanner->scannedPixels();
+    }
+    return scanned > 0 ? double(refined) / scanned : 0.0;
+}
 
-    // 使用QProcess调用tesseract命令行
-    QProcess process;
-    QStringList arguments;
-    arguments << tempFileName << "stdout" << "-l" << "chi_sim+eng";
+bool OCRModule::isRecognitionPaused() const {
+    return recognitionPaused;
+}
 
-    process.start("tesseract", arguments);
-    if (!process.waitForFinished(5000)) { // 5秒超时
-        qDebug() << "Tesseract process timeout";
-        return;
+void OCRModule::updatePausedState() {
+    // 只要还有一个屏幕在识别就不算暂停
+    int active = 0;
+    int paused = 0;
+    for (ScreenScanner *scanner : scanners) {
+        if (!scanner->isRunning() || !scanner->coversRegion()) continue;
+        ++active;
+        if (scanner->isRecognitionPaused()) ++paused;
     }
+    const bool state = active > 0 && paused == active;
+    if (state != recognitionPaused) {
+        recognitionPaused = state;
+        emit recognitionPausedChanged(state);
+    }
+}
 
-    QByteArray output = process.readAllStandardOutput();
-    QString recognizedText = QString::fromUtf8(output).trimmed();
+void OCRModule::clearScanners() {
+    // 先从列表中移除再删除，析构时发出的信号不会访问到已删除的扫描器
+    QVector<ScreenScanner *> old;
+    old.swap(scanners);
+    for (ScreenScanner *scanner : old) {
+        scanner->disconnect(this);
+        delete scanner;
+    }
+    screenTexts.clear();
+}
 
-    // 清理临时文件
-    tempFile.remove();
+bool OCRModule::startRecording(const QString &path, int screen) {
+    for (ScreenScanner *scanner : scanners) {
+        if (scanner->index() == screen) return scanner->startRecording(path);
+    }
+    qDebug() << "No scanner for screen" << screen;
+    return false;
+}
 
-    if (!recognizedText.isEmpty()) {
-        emit textRecognized(recognizedText);
-    } else {
-        // 如果没有识别到文字，发送模拟文本
-        emit textRecognized("屏幕内容识别模拟");
+void OCRModule::stopRecording() {
+    for (ScreenScanner *scanner : scanners) {
+        scanner->stopRecording();
+    }
+}
+
+void OCRModule::rebuildScanners(QScreen *excluded) {
+    clearScanners();
+
+    const QList<QScreen *> available = QGuiApplication::screens();
+    int index = 0;
+    for (QScreen *screen : available) {
+        if (screen == excluded) continue;
+        if (screenFilter.isEmpty() || screenFilter.contains(index)) {
+            ScreenScanner *scanner = new ScreenScanner(screen, index, this);
+            scanner->setScanRateRange(minRate, maxRate);
+            scanner->setCaptureRegion(captureRegion);
+            scanner->setRecognizerPool(recognizerPool);
+            scanner->setRefineConfidence(refineThreshold);
+            connect(scanner, &ScreenScanner::textRecognized, this, &OCRModule::onScreenText);
+            connect(scanner, &ScreenScanner::blocksRecognized, this, &OCRModule::onScreenBlocks);
+            connect(scanner, &ScreenScanner::blocksChanged, this, &OCRModule::blocksChanged);
+            connect(scanner, &ScreenScanner::resultRecognized, this, &OCRModule::resultRecognized);
+            connect(scanner, &ScreenScanner::scanRateChanged, this, &OCRModule::onScreenRateChanged);
+            connect(scanner, &ScreenScanner::recognitionPausedChanged, this, &OCRModule::updatePausedState);
+            scanners.append(scanner);
+            if (scanning) {
+                scanner->start();
+            }
+        }
+        ++index;
+    }
+    qDebug() << "OCR scanning" << scanners.size() << "of" << index << "screens";
+    updatePausedState();
+}
+
+void OCRModule::onScreenAdded(QScreen *screen) {
+    Q_UNUSED(screen)
+    rebuildScanners();
+}
+
+void OCRModule::onScreenRemoved(QScreen *screen) {
+    // 信号发出时屏幕可能仍在列表中，重建时跳过
+    rebuildScanners(screen);
+}
+
+void OCRModule::onScreenText(int screen, const QString &text) {
+    if (screenTexts.value(screen) == text) return;
+    screenTexts[screen] = text;
+    emit screenTextRecognized(screen, text);
+
+    QStringList parts;
+    for (const QString &part : std::as_const(screenTexts)) {
+        if (!part.isEmpty()) parts << part;
+    }
+    emit textRecognized(parts.join('\n'));
+}
+
+void OCRModule::onScreenBlocks(int screen, const QVector<OCRTextBlock> &blocks) {
+    Q_UNUSED(screen)
+    emit blocksRecognized(blocks);
+}
+
+void OCRModule::onScreenRateChanged(int screen, double fps) {
+    Q_UNUSED(screen)
+    Q_UNUSED(fps)
+    if (scanning) {
+        emit scanRateChanged(currentScanRate());
     }
 }
@@ -13,13 +13,28 @@
 
 #include <QObject>
 #include <QString>
+#include <QRect>
 #include <QTimer>
+#include <QList>
+#include <QMap>
+#include <QVector>
+#include "ocrtypes.h"
+
+class QScreen;
+class ScreenScanner;
+class RegionRecognizer;
+class ScreenHistoryIndex;
 
 // OCR接口
 class OCRInterface {
 public:
     virtual ~OCRInterface() {}
+    // 按当前设置的扫描区域开始扫描，默认整个屏幕
     virtual void startScanning() = 0;
+    // 只扫描指定区域（全局逻辑坐标）
+    virtual void startScanning(const QRect &region) = 0;
+    // 跟随前台窗口扫描
+    virtual void startScanningActiveWindow() = 0;
     virtual void stopScanning() = 0;
 };
 
@@ -31,16 +46,97 @@ public:
     ~OCRModule();
 
     void startScanning() override;
+    void startScanning(const QRect &region) override;
+    void startScanningActiveWindow() override;
     void stopScanning() override;
 
+    // 并行识别的进程（线程）数，每个各加载一份模型（约数百MB）。0表示核心数，为默认值；
+    // 环境变量OCR_WORKERS优先。只在扫描开始时读取，扫描中修改在下一次开始扫描时生效
+    void setRecognizerCount(int count);
+    int recognizerCount() const;
+
+    // 扫描区域，空矩形表示整个屏幕；扫描中修改立即生效，不需要重启
+    void setCaptureRegion(const QRect &region);
+    QRect getCaptureRegion() const;
+
+    // 跟随前台窗口：定期查询前台窗口位置并更新扫描区域
+    void setFollowActiveWindow(bool follow);
+    bool followsActiveWindow() const;
+
+    // 要扫描的屏幕序号（QGuiApplication::screens()中的位置），为空时扫描所有屏幕
+    void setScreens(const QList<int> &indices);
+    QList<int> screens() const;
+
+    // 自适应扫描频率范围，默认1~30帧每秒，每个屏幕独立调度
+    void setScanRateRange(double minFps, double maxFps);
+    // 所有屏幕中最高的扫描频率
+    double currentScanRate() const;
+    double screenScanRate(int screen) const;
+
+    // 识别结果缓存命中率
+    double cacheHitRate() const;
+
+    // 两遍识别：HiDPI屏幕先按降采样图像识别，平均置信度低于threshold（0~100）的区域再用原始分辨率识别。
+    // 默认70，0表示关闭
+    void setRefineConfidence(int threshold);
+    // 经过原始分辨率识别的像素占所有扫描像素的比例
+    double refinedAreaRatio() const;
+
+    // 所有正在扫描的屏幕都是视频、游戏或照片画面，识别已暂停
+    bool isRecognitionPaused() const;
+
+    // 屏幕文字历史，第一次开始扫描时接入识别输出，之后一直记录，可在任意线程查询
+    ScreenHistoryIndex *screenHistory() const;
+
+    // 录制指定屏幕送入识别流水线的帧，用于离线回放和基准测试
+    bool startRecording(const QString &path, int screen = 0);
+    void stopRecording();
+
 signals:
+    // 所有屏幕的文字，按屏幕顺序拼接；只在文字变化时发出
     void textRecognized(const QString &text);
+    void screenTextRecognized(int screen, const QString &text);
+    // 单个屏幕的文字区域，block.screen为屏幕序号；内容没有变化时不发出
+    void blocksRecognized(const QVector<OCRTextBlock> &blocks);
+    // 单个屏幕上新增、变化和消失的文字区域，按block.id关联
+    void blocksChanged(const OCRTextDelta &delta);
+    // 单个屏幕整帧的区域、行、词及置信度，可用于放置叠加层、过滤低置信度的词；result.screen()为屏幕序号
+    void resultRecognized(const OCRResult &result);
+    void scanRateChanged(double fps);
+    // 识别暂停/恢复，UI据此提示扫描已暂停
+    void recognitionPausedChanged(bool paused);
 
 private slots:
-    void onTimeout();
+    void onFollowTimeout();
+    void onScreenAdded(QScreen *screen);
+    void onScreenRemoved(QScreen *screen);
+    void onScreenText(int screen, const QString &text);
+    void onScreenBlocks(int screen, const QVector<OCRTextBlock> &blocks);
+    void onScreenRateChanged(int screen, double fps);
+    void updatePausedState();
 
 private:
-    QTimer *timer;
+    // 按当前屏幕列表和过滤条件重建扫描器，excluded为正在移除的屏幕
+    void rebuildScanners(QScreen *excluded = nullptr);
+    void clearScanners();
+
+    // 把区域分发给各屏幕的扫描器
+    void applyCaptureRegion();
+
+    RegionRecognizer *recognizerPool; // 所有屏幕共用：识别进程池，不可用时为进程内的识别线程池；只在扫描期间存在
+    int recognizers; // setRecognizerCount()的设置，0表示核心数
+    ScreenHistoryIndex *history;
+    bool historyAttached;
+    QVector<ScreenScanner *> scanners;
+    QList<int> screenFilter;
+    QRect captureRegion;
+    QTimer *followTimer;
+    bool followActive;
+    QMap<int, QString> screenTexts;
+    double minRate;
+    double maxRate;
+    int refineThreshold;
+    bool recognitionPaused;
     bool scanning;
 };
 
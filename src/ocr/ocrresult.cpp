@@ -0,0 +1,351 @@
+#include "ocrresult.h"
+#include <QDataStream>
+#include <QIODevice>
+#include <QStringList>
+
+class OCRResultData : public QSharedData
+{
+public:
+    QVector<OCRBlock> blocks;
+    QVector<OCRLine> lines;
+    QVector<OCRWord> words;
+    QByteArray pool; // 所有词的UTF-8文字首尾相接
+};
+
+static bool isCjk(uint ucs4)
+{
+    return (ucs4 >= 0x2E80 && ucs4 <= 0x9FFF) || (ucs4 >= 0xAC00 && ucs4 <= 0xD7AF) ||
+           (ucs4 >= 0xF900 && ucs4 <= 0xFAFF) || (ucs4 >= 0xFF00 && ucs4 <= 0xFFEF) ||
+           (ucs4 >= 0x20000 && ucs4 <= 0x2FFFF);
+}
+
+// 最后一个字符的码位，扩展B区等补充平面的汉字占两个UTF-16单元
+static uint lastCodePoint(const QString &text)
+{
+    const qsizetype n = text.size();
+    if (n >= 2 && text.at(n - 1).isLowSurrogate() && text.at(n - 2).isHighSurrogate()) {
+        return QChar::surrogateToUcs4(text.at(n - 2), text.at(n - 1));
+    }
+    return text.back().unicode();
+}
+
+static QRect scaledRect(const QRect &rect, int factor)
+{
+    return factor == 1 ? rect : QRect(rect.topLeft() * factor, rect.size() * factor);
+}
+
+OCRResult::OCRResult()
+    : d(new OCRResultData()), screenIndex(0)
+{
+}
+
+OCRResult::OCRResult(const OCRResult &other) = default;
+OCRResult &OCRResult::operator=(const OCRResult &other) = default;
+OCRResult::~OCRResult() = default;
+
+bool OCRResult::isEmpty() const
+{
+    return d->words.isEmpty();
+}
+
+int OCRResult::screen() const
+{
+    return screenIndex;
+}
+
+void OCRResult::setScreen(int screen)
+{
+    screenIndex = screen;
+}
+
+int OCRResult::blockCount() const
+{
+    return d->blocks.size();
+}
+
+int OCRResult::lineCount() const
+{
+    return d->lines.size();
+}
+
+int OCRResult::wordCount() const
+{
+    return d->words.size();
+}
+
+const OCRBlock &OCRResult::block(int index) const
+{
+    return d->blocks.at(index);
+}
+
+const OCRLine &OCRResult::line(int index) const
+{
+    return d->lines.at(index);
+}
+
+const OCRWord &OCRResult::word(int index) const
+{
+    return d->words.at(index);
+}
+
+const QVector<OCRBlock> &OCRResult::blocks() const
+{
+    return d->blocks;
+}
+
+const QVector<OCRLine> &OCRResult::lines() const
+{
+    return d->lines;
+}
+
+const QVector<OCRWord> &OCRResult::words() const
+{
+    return d->words;
+}
+
+QByteArrayView OCRResult::wordUtf8(int index) const
+{
+    const OCRWord &w = d->words.at(index);
+    return QByteArrayView(d->pool.constData() + w.textOffset, qsizetype(w.textLength));
+}
+
+QString OCRResult::wordText(int index) const
+{
+    return QString::fromUtf8(wordUtf8(index));
+}
+
+QString OCRResult::lineText(int index) const
+{
+    const OCRLine &l = d->lines.at(index);
+    QString text;
+    for (quint32 i = 0; i < l.wordCount; ++i) {
+        const QString word = wordText(int(l.firstWord + i));
+        if (word.isEmpty()) continue;
+        if (!text.isEmpty() && !isCjk(lastCodePoint(text)) && !isCjk(word.toUcs4().value(0))) {
+            text += QLatin1Char(' ');
+        }
+        text += word;
+    }
+    return text;
+}
+
+QString OCRResult::blockText(int index) const
+{
+    const OCRBlock &b = d->blocks.at(index);
+    QStringList lines;
+    for (quint32 i = 0; i < b.lineCount; ++i) {
+        const QString line = lineText(int(b.firstLine + i));
+        if (!line.isEmpty()) lines << line;
+    }
+    return lines.join(QLatin1Char('\n'));
+}
+
+QString OCRResult::text() const
+{
+    QStringList blocks;
+    for (int i = 0; i < d->blocks.size(); ++i) {
+        const QString block = blockText(i);
+        if (!block.isEmpty()) blocks << block;
+    }
+    return blocks.join(QLatin1Char('\n'));
+}
+
+void OCRResult::reserve(int blocks, int lines, int words, int textBytes)
+{
+    d->blocks.reserve(blocks);
+    d->lines.reserve(lines);
+    d->words.reserve(words);
+    d->pool.reserve(textBytes);
+}
+
+int OCRResult::addBlock(const QRect &rect, quint64 id)
+{
+    OCRBlock b;
+    b.rect = rect;
+    b.id = id;
+    b.firstLine = quint32(d->lines.size());
+    d->blocks.append(b);
+    return d->blocks.size() - 1;
+}
+
+int OCRResult::addLine(const QRect &rect)
+{
+    if (d->blocks.isEmpty()) addBlock(rect);
+    OCRLine l;
+    l.rect = rect;
+    l.block = quint32(d->blocks.size() - 1);
+    l.firstWord = quint32(d->words.size());
+    d->lines.append(l);
+    ++d->blocks.last().lineCount;
+    return d->lines.size() - 1;
+}
+
+int OCRResult::addWord(const QRect &rect, const char *utf8, int length, int confidence)
+{
+    if (d->lines.isEmpty()) addLine(rect);
+    OCRWord w;
+    w.rect = rect;
+    w.textOffset = quint32(d->pool.size());
+    w.textLength = quint32(qMax(0, length));
+    w.line = quint32(d->lines.size() - 1);
+    w.block = d->lines.last().block;
+    w.confidence = qBound(0, confidence, 100);
+    d->pool.append(utf8, int(w.textLength));
+    d->words.append(w);
+    ++d->lines.last().wordCount;
+    return d->words.size() - 1;
+}
+
+void OCRResult::setBlockId(int index, quint64 id)
+{
+    d->blocks[index].id = id;
+}
+
+void OCRResult::append(const OCRResult &other, const QPoint &offset, int scale, quint64 id)
+{
+    const OCRResultData *src = other.d.constData();
+    if (src->blocks.isEmpty()) return;
+
+    const quint32 blockBase = quint32(d->blocks.size());
+    const quint32 lineBase = quint32(d->lines.size());
+    const quint32 wordBase = quint32(d->words.size());
+    const quint32 poolBase = quint32(d->pool.size());
+    d->blocks.reserve(d->blocks.size() + src->blocks.size());
+    d->lines.reserve(d->lines.size() + src->lines.size());
+    d->words.reserve(d->words.size() + src->words.size());
+
+    for (OCRBlock b : src->blocks) {
+        b.rect = scaledRect(b.rect, scale).translated(offset);
+        b.firstLine += lineBase;
+        if (id != 0) b.id = id;
+        d->blocks.append(b);
+    }
+    for (OCRLine l : src->lines) {
+        l.rect = scaledRect(l.rect, scale).translated(offset);
+        l.block += blockBase;
+        l.firstWord += wordBase;
+        d->lines.append(l);
+    }
+    for (OCRWord w : src->words) {
+        w.rect = scaledRect(w.rect, scale).translated(offset);
+        w.textOffset += poolBase;
+        w.line += lineBase;
+        w.block += blockBase;
+        d->words.append(w);
+    }
+    d->pool.append(src->pool);
+}
+
+OCRResult OCRResult::scaled(int factor) const
+{
+    if (factor == 1) return *this;
+    OCRResult result;
+    result.screenIndex = screenIndex;
+    result.append(*this, QPoint(), factor);
+    return result;
+}
+
+OCRResult OCRResult::filtered(int minConfidence) const
+{
+    OCRResult result;
+    result.screenIndex = screenIndex;
+    result.reserve(d->blocks.size(), d->lines.size(), d->words.size(), d->pool.size());
+    for (const OCRBlock &b : d->blocks) {
+        result.addBlock(b.rect, b.id);
+        for (quint32 i = 0; i < b.lineCount; ++i) {
+            const OCRLine &l = d->lines.at(int(b.firstLine + i));
+            result.addLine(l.rect);
+            for (quint32 j = 0; j < l.wordCount; ++j) {
+                const OCRWord &w = d->words.at(int(l.firstWord + j));
+                if (w.confidence < minConfidence) continue;
+                result.addWord(w.rect, d->pool.constData() + w.textOffset, int(w.textLength), w.confidence);
+            }
+        }
+    }
+    return result;
+}
+
+QDataStream &operator<<(QDataStream &out, const OCRResult &result)
+{
+    const OCRResultData *d = result.d.constData();
+    out << qint32(result.screenIndex) << quint32(d->blocks.size()) << quint32(d->lines.size()) << quint32(d->words.size());
+    for (const OCRBlock &b : d->blocks) {
+        out << b.rect << b.id << b.firstLine << b.lineCount;
+    }
+    for (const OCRLine &l : d->lines) {
+        out << l.rect << l.block << l.firstWord << l.wordCount;
+    }
+    for (const OCRWord &w : d->words) {
+        out << w.rect << w.textOffset << w.textLength << w.line << w.block << qint32(w.confidence);
+    }
+    out << d->pool;
+    return out;
+}
+
+// 序列化后每个元素的字节数（QRect为4个qint32）
+static const quint64 BLOCK_BYTES = 16 + 8 + 4 + 4;
+static const quint64 LINE_BYTES = 16 + 4 + 4 + 4;
+static const quint64 WORD_BYTES = 16 + 4 + 4 + 4 + 4 + 4;
+
+// 解码后的下标和偏移都必须落在数组和字符串池内，否则按损坏处理
+static bool isConsistent(const OCRResultData *d)
+{
+    const quint64 blocks = quint64(d->blocks.size());
+    const quint64 lines = quint64(d->lines.size());
+    const quint64 words = quint64(d->words.size());
+    const quint64 pool = quint64(d->pool.size());
+    for (const OCRBlock &b : d->blocks) {
+        if (quint64(b.firstLine) + b.lineCount > lines) return false;
+    }
+    for (const OCRLine &l : d->lines) {
+        if (l.block >= blocks || quint64(l.firstWord) + l.wordCount > words) return false;
+    }
+    for (const OCRWord &w : d->words) {
+        if (w.line >= lines || w.block >= blocks || quint64(w.textOffset) + w.textLength > pool) return false;
+        if (w.confidence < 0 || w.confidence > 100) return false;
+    }
+    return true;
+}
+
+QDataStream &operator>>(QDataStream &in, OCRResult &result)
+{
+    qint32 screen = 0;
+    quint32 blockCount = 0;
+    quint32 lineCount = 0;
+    quint32 wordCount = 0;
+    in >> screen >> blockCount >> lineCount >> wordCount;
+    if (in.status() != QDataStream::Ok) return in;
+
+    // 数据来自另一个进程，数量不能超过流中剩余的字节，避免按损坏的数量分配内存
+    const quint64 needed = blockCount * BLOCK_BYTES + lineCount * LINE_BYTES + wordCount * WORD_BYTES;
+    if (!in.device() || needed > quint64(qMax<qint64>(0, in.device()->bytesAvailable()))) {
+        in.setStatus(QDataStream::ReadCorruptData);
+        return in;
+    }
+
+    OCRResult decoded;
+    decoded.screenIndex = screen;
+    OCRResultData *d = decoded.d.data();
+    d->blocks.resize(qsizetype(blockCount));
+    d->lines.resize(qsizetype(lineCount));
+    d->words.resize(qsizetype(wordCount));
+    for (OCRBlock &b : d->blocks) {
+        in >> b.rect >> b.id >> b.firstLine >> b.lineCount;
+    }
+    for (OCRLine &l : d->lines) {
+        in >> l.rect >> l.block >> l.firstWord >> l.wordCount;
+    }
+    for (OCRWord &w : d->words) {
+        qint32 confidence = 0;
+        in >> w.rect >> w.textOffset >> w.textLength >> w.line >> w.block >> confidence;
+        w.confidence = confidence;
+    }
+    in >> d->pool;
+    if (in.status() != QDataStream::Ok) return in;
+    if (!isConsistent(d)) {
+        in.setStatus(QDataStream::ReadCorruptData);
+        return in;
+    }
+    result = decoded;
+    return in;
+}
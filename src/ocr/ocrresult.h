@@ -0,0 +1,115 @@
+#ifndef OCRRESULT_H
+#define OCRRESULT_H
+
+#include <QtCore/qglobal.h>
+
+#ifndef OCR_EXPORT
+#ifdef OCR_LIBRARY
+#define OCR_EXPORT Q_DECL_EXPORT
+#else
+#define OCR_EXPORT Q_DECL_IMPORT
+#endif
+#endif
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QMetaType>
+#include <QPoint>
+#include <QRect>
+#include <QSharedDataPointer>
+#include <QString>
+#include <QVector>
+
+// 一个词。文字以UTF-8存放在所属OCRResult的字符串池中
+struct OCRWord {
+    QRect rect;
+    quint32 textOffset = 0; // 字符串池中的字节偏移
+    quint32 textLength = 0; // UTF-8字节数
+    quint32 line = 0;       // 所在行的序号
+    quint32 block = 0;      // 所在区域的序号
+    int confidence = 0;     // 0~100
+};
+
+// 一行文字，词按从左到右的顺序连续存放
+struct OCRLine {
+    QRect rect;
+    quint32 block = 0;
+    quint32 firstWord = 0;
+    quint32 wordCount = 0;
+};
+
+// 一个文字区域，行按从上到下的顺序连续存放
+struct OCRBlock {
+    QRect rect;
+    quint64 id = 0; // 与OCRTextBlock::id相同，在连续帧之间保持不变
+    quint32 firstLine = 0;
+    quint32 lineCount = 0;
+};
+
+class OCRResultData;
+class QDataStream;
+
+// 一帧的识别结果：区域、行、词各存放在一个连续数组中，文字共用一个UTF-8字符串池。
+// 隐式共享，通过排队信号跨线程传递时只增加引用计数；构建时每个数组整体扩容，不为单个词分配内存。
+class OCR_EXPORT OCRResult
+{
+public:
+    OCRResult();
+    OCRResult(const OCRResult &other);
+    OCRResult &operator=(const OCRResult &other);
+    ~OCRResult();
+
+    bool isEmpty() const;
+
+    // 所在屏幕序号，不属于共享数据，修改时不复制数组
+    int screen() const;
+    void setScreen(int screen);
+
+    int blockCount() const;
+    int lineCount() const;
+    int wordCount() const;
+    const OCRBlock &block(int index) const;
+    const OCRLine &line(int index) const;
+    const OCRWord &word(int index) const;
+    const QVector<OCRBlock> &blocks() const;
+    const QVector<OCRLine> &lines() const;
+    const QVector<OCRWord> &words() const;
+
+    // 直接指向字符串池，不复制
+    QByteArrayView wordUtf8(int index) const;
+    QString wordText(int index) const;
+    // 行内的词相连，拉丁文字之间加空格，中日韩文字之间不加
+    QString lineText(int index) const;
+    QString blockText(int index) const;
+    // 所有区域的文字，行之间以换行分隔
+    QString text() const;
+
+    // 构建：区域、行、词依次追加，新行属于最后一个区域，新词属于最后一行
+    void reserve(int blocks, int lines, int words, int textBytes);
+    int addBlock(const QRect &rect, quint64 id = 0);
+    int addLine(const QRect &rect);
+    int addWord(const QRect &rect, const char *utf8, int length, int confidence);
+    void setBlockId(int index, quint64 id);
+
+    // 追加other的全部区域，坐标先乘以scale再平移offset；other只有一个区域时可指定其编号
+    void append(const OCRResult &other, const QPoint &offset = QPoint(), int scale = 1, quint64 id = 0);
+    // 坐标乘以factor后的副本
+    OCRResult scaled(int factor) const;
+    // 只保留置信度不低于minConfidence的词，空行保留以维持行结构
+    OCRResult filtered(int minConfidence) const;
+
+private:
+    friend OCR_EXPORT QDataStream &operator<<(QDataStream &out, const OCRResult &result);
+    friend OCR_EXPORT QDataStream &operator>>(QDataStream &in, OCRResult &result);
+
+    QSharedDataPointer<OCRResultData> d;
+    int screenIndex;
+};
+
+// 序列化，用于识别进程把结果传回宿主进程
+OCR_EXPORT QDataStream &operator<<(QDataStream &out, const OCRResult &result);
+OCR_EXPORT QDataStream &operator>>(QDataStream &in, OCRResult &result);
+
+Q_DECLARE_METATYPE(OCRResult)
+
+#endif // OCRRESULT_H
@@ -0,0 +1,103 @@
+#include "ocrresultcache.h"
+#include <QVector>
+
+OCRResultCache::OCRResultCache(int capacity, qint64 maxBytes, int ttlSeconds)
+    : cache(capacity, maxBytes, ttlSeconds)
+{
+}
+
+QByteArray OCRResultCache::perceptualHash(const QImage &gray, const QRect &rect)
+{
+    const QRect r = rect.intersected(gray.rect());
+    if (r.isEmpty() || gray.format() != QImage::Format_Grayscale8) return QByteArray();
+
+    const int cell = qMax(2, r.height() / 8);
+    const int gridWidth = qMax(2, r.width() / cell);
+    const int gridHeight = qMax(1, r.height() / cell);
+
+    // 每个格子的像素和
+    QVector<quint32> sums(gridWidth * gridHeight, 0);
+    for (int gy = 0; gy < gridHeight; ++gy) {
+        const int y0 = r.top() + gy * r.height() / gridHeight;
+        const int y1 = r.top() + (gy + 1) * r.height() / gridHeight;
+        quint32 *rowSums = sums.data() + gy * gridWidth;
+        for (int y = y0; y < y1; ++y) {
+            const uchar *line = gray.constScanLine(y);
+            for (int gx = 0; gx < gridWidth; ++gx) {
+                const int x0 = r.left() + gx * r.width() / gridWidth;
+                const int x1 = r.left() + (gx + 1) * r.width() / gridWidth;
+                quint32 s = 0;
+                for (int x = x0; x < x1; ++x) {
+                    s += line[x];
+                }
+                rowSums[gx] += s;
+            }
+        }
+    }
+
+    // 键 = 格子数 + 每行 gridWidth-1 个比较位
+    const int bitCount = (gridWidth - 1) * gridHeight;
+    QByteArray key(4 + (bitCount + 7) / 8, '\0');
+    key[0] = char(gridWidth & 0xFF);
+    key[1] = char((gridWidth >> 8) & 0xFF);
+    key[2] = char(gridHeight & 0xFF);
+    key[3] = char((gridHeight >> 8) & 0xFF);
+    int bit = 0;
+    for (int gy = 0; gy < gridHeight; ++gy) {
+        const quint32 *rowSums = sums.constData() + gy * gridWidth;
+        for (int gx = 0; gx + 1 < gridWidth; ++gx, ++bit) {
+            // 格子面积可能相差一个像素，比较前按面积归一化
+            const int w0 = (r.left() + (gx + 1) * r.width() / gridWidth) - (r.left() + gx * r.width() / gridWidth);
+            const int w1 = (r.left() + (gx + 2) * r.width() / gridWidth) - (r.left() + (gx + 1) * r.width() / gridWidth);
+            if (quint64(rowSums[gx]) * w1 < quint64(rowSums[gx + 1]) * w0) {
+                key[4 + bit / 8] = char(key[4 + bit / 8] | (1 << (bit % 8)));
+            }
+        }
+    }
+    return key;
+}
+
+bool OCRResultCache::lookup(const QByteArray &key, OCRCachedText &result)
+{
+    if (key.isEmpty()) return false;
+    return cache.tryGet(key, result);
+}
+
+void OCRResultCache::insert(const QByteArray &key, const OCRCachedText &result)
+{
+    if (key.isEmpty()) return;
+    // 逐词结果的字符串池按与文字相同的大小估算
+    const qint64 textBytes = result.text.size() * qint64(sizeof(QChar));
+    cache.put(key, result, key.size() + qint64(sizeof(OCRCachedText)) + 2 * textBytes +
+                               result.words.wordCount() * qint64(sizeof(OCRWord)));
+}
+
+quint64 OCRResultCache::hits() const
+{
+    return cache.hits();
+}
+
+quint64 OCRResultCache::misses() const
+{
+    return cache.misses();
+}
+
+double OCRResultCache::hitRate() const
+{
+    return cache.hitRate();
+}
+
+int OCRResultCache::size() const
+{
+    return cache.size();
+}
+
+qint64 OCRResultCache::totalBytes() const
+{
+    return cache.totalBytes();
+}
+
+void OCRResultCache::clear()
+{
+    cache.clear();
+}
@@ -0,0 +1,54 @@
+#ifndef OCRRESULTCACHE_H
+#define OCRRESULTCACHE_H
+
+#include <QtCore/qglobal.h>
+
+#ifndef OCR_EXPORT
+#ifdef OCR_LIBRARY
+#define OCR_EXPORT Q_DECL_EXPORT
+#else
+#define OCR_EXPORT Q_DECL_IMPORT
+#endif
+#endif
+
+#include <QByteArray>
+#include <QImage>
+#include <QRect>
+#include <QString>
+#include "infrastructure/cache/LRUCache.h"
+#include "ocrresult.h"
+
+// 缓存的识别结果
+struct OCRCachedText {
+    QString text;
+    int confidence = 0;
+    OCRResult words; // 坐标相对于区域左上角
+};
+
+// 识别结果缓存
+// 以文字区域截图的感知哈希为键，反复出现的菜单、工具栏和文档内容命中后直接跳过识别。
+class OCR_EXPORT OCRResultCache
+{
+public:
+    // 默认4096项、16MB、10分钟过期
+    OCRResultCache(int capacity = 4096, qint64 maxBytes = 16 * 1024 * 1024, int ttlSeconds = 600);
+
+    // 差分哈希：按行比较相邻格子的平均亮度，对整体亮度和颜色变化不敏感。
+    // 格子边长随文字高度缩放（至少2像素），键中包含量化后的尺寸。
+    static QByteArray perceptualHash(const QImage &gray, const QRect &rect);
+
+    bool lookup(const QByteArray &key, OCRCachedText &result);
+    void insert(const QByteArray &key, const OCRCachedText &result);
+
+    quint64 hits() const;
+    quint64 misses() const;
+    double hitRate() const;
+    int size() const;
+    qint64 totalBytes() const;
+    void clear();
+
+private:
+    LRUCache<QByteArray, OCRCachedText> cache;
+};
+
+#endif // OCRRESULTCACHE_H
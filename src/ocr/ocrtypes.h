@@ -0,0 +1,32 @@
+#ifndef OCRTYPES_H
+#define OCRTYPES_H
+
+#include <QMetaType>
+#include <QRect>
+#include <QString>
+#include <QVector>
+#include "ocrresult.h"
+
+// 一个文字区域及其识别结果，rect为所在屏幕截图的像素坐标
+struct OCRTextBlock {
+    QRect rect;
+    QString text;
+    int screen = 0; // QGuiApplication::screens()中的序号
+    quint64 id = 0; // 区域在连续帧之间保持不变的编号，进程内唯一
+    OCRResult words; // 区域内的行和词，坐标为相对于rect左上角的截图像素；识别引擎不提供逐词结果时为空
+};
+
+// 相邻两次输出之间文字区域的变化
+struct OCRTextDelta {
+    int screen = 0;
+    QVector<OCRTextBlock> added;
+    QVector<OCRTextBlock> changed; // 文字或位置变化，id不变
+    QVector<quint64> removed;
+
+    bool isEmpty() const { return added.isEmpty() && changed.isEmpty() && removed.isEmpty(); }
+};
+
+Q_DECLARE_METATYPE(OCRTextBlock)
+Q_DECLARE_METATYPE(OCRTextDelta)
+
+#endif // OCRTYPES_H
@@ -0,0 +1,82 @@
+// 识别进程：由WorkerProcessPool启动，从共享内存帧环读取帧，结果经本地套接字返回。
+// 宿主断开连接时退出。
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QLocalSocket>
+#include <QDebug>
+#include "sharedframering.h"
+#include "tesseractengine.h"
+#include "workerprotocol.h"
+
+static const int CONNECT_TIMEOUT_MS = 5000;
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    const QCommandLineOption serverOption("server", "Local server of the host process.", "name");
+    const QCommandLineOption ringOption("ring", "Shared frame ring key.", "key");
+    const QCommandLineOption indexOption("index", "Worker index.", "n", "0");
+    const QCommandLineOption languageOption("language", "Tesseract language.", "lang", "chi_sim+eng");
+    parser.addOptions({serverOption, ringOption, indexOption, languageOption});
+    parser.addHelpOption();
+    parser.process(app);
+
+    const QString index = parser.value(indexOption);
+    SharedFrameRing ring;
+    if (!ring.attach(parser.value(ringOption))) {
+        return 1;
+    }
+
+    QLocalSocket socket;
+    socket.connectToServer(parser.value(serverOption));
+    if (!socket.waitForConnected(CONNECT_TIMEOUT_MS)) {
+        qDebug() << "OCR worker" << index << "cannot connect:" << socket.errorString();
+        return 1;
+    }
+
+    // 模型只加载一次，之后一直处理请求
+    TesseractEngine engine(parser.value(languageOption));
+    if (!engine.init()) {
+        qDebug() << "OCR worker" << index << "falling back to the tesseract command line";
+    }
+    OCRWorkerMessage::write(&socket, OCRWorkerMessage::Hello, QByteArray());
+    socket.waitForBytesWritten(CONNECT_TIMEOUT_MS);
+
+    while (socket.state() == QLocalSocket::ConnectedState) {
+        OCRWorkerMessage::Type type;
+        QByteArray body;
+        if (!OCRWorkerMessage::read(&socket, &type, &body)) {
+            socket.waitForReadyRead(-1);
+            continue;
+        }
+        OCRWorkerRequest request;
+        if (type != OCRWorkerMessage::Request || !request.decode(body)) {
+            qDebug() << "OCR worker" << index << "received a malformed message";
+            return 1;
+        }
+
+        // 直接在共享内存上识别，不复制帧。Tesseract设置图像时会复制整幅图像，
+        // 这里按帧的行跨度只构造请求区域的子图，每个区域只复制自己的像素
+        const QImage frame = ring.frame(request.slot, request.width, request.height, request.bytesPerLine);
+        const QRect region = request.region.intersected(frame.rect());
+        OCRWorkerReply reply;
+        reply.id = request.id;
+        if (!frame.isNull() && !region.isEmpty()) {
+            const QImage crop(frame.constBits() + qsizetype(region.y()) * frame.bytesPerLine() + region.x(), region.width(),
+                              region.height(), frame.bytesPerLine(), QImage::Format_Grayscale8);
+            QVector<int> confidences;
+            QVector<OCRResult> layouts;
+            const QStringList texts = engine.recognizeRegions(crop, QVector<QRect>() << crop.rect(), &confidences,
+                                                              request.wantLayout ? &layouts : nullptr);
+            reply.text = texts.value(0);
+            reply.confidence = confidences.value(0);
+            reply.layout = layouts.value(0);
+        }
+        OCRWorkerMessage::write(&socket, OCRWorkerMessage::Reply, reply.encode());
+        while (socket.bytesToWrite() > 0 && socket.waitForBytesWritten(-1)) {
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include "recognizerpool.h"
+#include "tesseractengine.h"
+#include <QThread>
+#include <algorithm>
+
+RecognizerPool::RecognizerPool(int threads, const QString &language)
+    : stopping(false)
+{
+    const int count = threads > 0 ? threads : qMax(1, QThread::idealThreadCount());
+    for (int i = 0; i < count; ++i) {
+        TesseractEngine *engine = new TesseractEngine(language);
+        engines.append(engine);
+        // 模型在各自的工作线程中并行加载
+        QThread *worker = QThread::create([this, engine]() { workerLoop(engine); });
+        workers.append(worker);
+        worker->start();
+    }
+}
+
+RecognizerPool::~RecognizerPool()
+{
+    {
+        QMutexLocker locker(&mutex);
+        stopping = true;
+        jobAvailable.wakeAll();
+    }
+    for (QThread *worker : workers) {
+        worker->wait();
+        delete worker;
+    }
+    qDeleteAll(engines);
+}
+
+int RecognizerPool::threadCount() const
+{
+    return workers.size();
+}
+
+QStringList RecognizerPool::recognize(const QImage &image, const QVector<QRect> &regions, QVector<int> *confidences,
+                                      QVector<OCRResult> *layouts)
+{
+    Batch batch;
+    batch.remaining = 0;
+    batch.wantLayouts = layouts != nullptr;
+    for (int i = 0; i < regions.size(); ++i) {
+        batch.texts << QString();
+        batch.confidences << 0;
+    }
+    if (layouts) {
+        batch.layouts.resize(regions.size());
+    }
+
+    // 按面积从大到小排列，大区域先开始，避免最后只剩一个线程在处理大区域
+    QVector<Job> pending;
+    for (int i = 0; i < regions.size(); ++i) {
+        const QRect rect = regions[i].intersected(image.rect());
+        if (rect.isEmpty()) continue;
+        Job job;
+        job.crop = image.copy(rect);
+        job.index = i;
+        job.area = qint64(rect.width()) * rect.height();
+        job.batch = &batch;
+        pending.append(job);
+    }
+    std::sort(pending.begin(), pending.end(), [](const Job &a, const Job &b) { return a.area > b.area; });
+
+    QMutexLocker locker(&mutex);
+    if (!pending.isEmpty() && !stopping) {
+        batch.remaining = pending.size();
+        for (const Job &job : pending) {
+            jobs.enqueue(job);
+        }
+        jobAvailable.wakeAll();
+        while (batch.remaining > 0) {
+            batchDone.wait(&mutex);
+        }
+    }
+    locker.unlock();
+
+    if (confidences) {
+        *confidences = batch.confidences;
+    }
+    if (layouts) {
+        *layouts = batch.layouts;
+    }
+    return batch.texts;
+}
+
+void RecognizerPool::workerLoop(TesseractEngine *engine)
+{
+    engine->init();
+
+    QMutexLocker locker(&mutex);
+    while (true) {
+        while (jobs.isEmpty() && !stopping) {
+            jobAvailable.wait(&mutex);
+        }
+        // 退出前把已排队的任务做完，等待中的调用方才能返回
+        if (jobs.isEmpty()) return;
+        Job job = jobs.dequeue();
+        locker.unlock();
+
+        // 裁剪图的原点就是区域左上角，逐词坐标已经是相对坐标
+        QVector<int> confidence;
+        QVector<OCRResult> layout;
+        const QStringList text = engine->recognizeRegions(job.crop, QVector<QRect>() << job.crop.rect(), &confidence,
+                                                          job.batch->wantLayouts ? &layout : nullptr);
+
+        locker.relock();
+        job.batch->texts[job.index] = text.value(0);
+        job.batch->confidences[job.index] = confidence.value(0);
+        if (job.batch->wantLayouts) {
+            job.batch->layouts[job.index] = layout.value(0);
+        }
+        if (--job.batch->remaining == 0) {
+            batchDone.wakeAll();
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef RECOGNIZERPOOL_H
+#define RECOGNIZERPOOL_H
+
+#include <QtCore/qglobal.h>
+
+#ifndef OCR_EXPORT
+#ifdef OCR_LIBRARY
+#define OCR_EXPORT Q_DECL_EXPORT
+#else
+#define OCR_EXPORT Q_DECL_IMPORT
+#endif
+#endif
+
+#include <QImage>
+#include <QMutex>
+#include <QQueue>
+#include <QRect>
+#include <QStringList>
+#include <QVector>
+#include <QWaitCondition>
+#include "ocrresult.h"
+#include "regionrecognizer.h"
+
+class QThread;
+class TesseractEngine;
+
+// 识别线程池
+// 每个工作线程持有自己的Tesseract实例（TessBaseAPI不能跨线程共享）。
+// 一批区域按面积从大到小排队，空闲线程依次取走，耗时最长的区域最先开始，各线程负载接近。
+// 可被多条流水线同时使用，每次recognize()调用只等待自己的那一批。
+class OCR_EXPORT RecognizerPool : public RegionRecognizer
+{
+public:
+    // threads为0时使用QThread::idealThreadCount()
+    explicit RecognizerPool(int threads = 0, const QString &language = "chi_sim+eng");
+    ~RecognizerPool() override;
+
+    int threadCount() const;
+
+    QStringList recognize(const QImage &image, const QVector<QRect> &regions, QVector<int> *confidences = nullptr,
+                          QVector<OCRResult> *layouts = nullptr) override;
+
+private:
+    struct Batch {
+        QStringList texts;
+        QVector<int> confidences;
+        QVector<OCRResult> layouts;
+        bool wantLayouts;
+        int remaining;
+    };
+
+    struct Job {
+        QImage crop;
+        int index;
+        qint64 area;
+        Batch *batch;
+    };
+
+    void workerLoop(TesseractEngine *engine);
+
+    QVector<QThread *> workers;
+    QVector<TesseractEngine *> engines;
+    QMutex mutex;
+    QWaitCondition jobAvailable;
+    QWaitCondition batchDone;
+    QQueue<Job> jobs;
+    bool stopping;
+};
+
+#endif // RECOGNIZERPOOL_H
@@ -0,0 +1,22 @@
+#ifndef REGIONRECOGNIZER_H
+#define REGIONRECOGNIZER_H
+
+#include <QImage>
+#include <QRect>
+#include <QStringList>
+#include <QVector>
+#include "ocrresult.h"
+
+// 批量区域识别接口，由识别线程池（进程内）和识别进程池（进程外）实现。
+// 实现必须允许多个流水线同时调用
+class RegionRecognizer
+{
+public:
+    virtual ~RegionRecognizer() {}
+
+    // 阻塞直到所有区域识别完成，结果与regions一一对应；layouts的坐标相对于各区域左上角
+    virtual QStringList recognize(const QImage &image, const QVector<QRect> &regions, QVector<int> *confidences = nullptr,
+                                  QVector<OCRResult> *layouts = nullptr) = 0;
+};
+
+#endif // REGIONRECOGNIZER_H
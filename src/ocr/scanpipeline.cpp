@@ -0,0 +1,578 @@
+#include "scanpipeline.h"
+#include "tesseractengine.h"
+#include "dirtyregiontracker.h"
+#include "textdetector.h"
+#include "ocrresultcache.h"
+#include "scrolldetector.h"
+#include "regionrecognizer.h"
+#include "contentclassifier.h"
+#include "blockmatcher.h"
+#include <algorithm>
+#include <QHash>
+#include <QThread>
+#include <QDebug>
+
+static const int CACHE_MIN_CONFIDENCE = 60; // 低置信度的结果可能是渲染中途的画面，不写入缓存
+static const int MIN_SCROLL_TILES = 4;      // 变化瓦片太少时（光标闪烁、输入）不做滚动检测
+static const double MIN_ID_OVERLAP = 0.5;   // 与上一帧区域的交并比达到该值时沿用其编号
+static const int DEFAULT_REFINE_CONFIDENCE = 70; // 降采样识别结果低于该置信度时用原始分辨率重新识别
+static const int DEFAULT_COARSE_SCALE = 2;  // 大尺寸截图粗识别时的降采样倍数，与屏幕缩放无关
+static const qint64 COARSE_MIN_PIXELS = qint64(2560) * 1440; // 截图达到该像素数时才做粗识别
+static const int REFINE_LINE_PADDING = 4;   // 精细识别单行时上下左右多取的原始分辨率像素
+static const int PAUSE_AFTER_FRAMES = 3;    // 连续多少帧非文字画面后暂停识别，避免滚动、切换窗口时误判
+
+// 行内各词置信度的平均值，没有词时为0
+static int lineConfidence(const OCRResult &layout, int index)
+{
+    const OCRLine &line = layout.line(index);
+    if (line.wordCount == 0) return 0;
+    int sum = 0;
+    for (quint32 i = 0; i < line.wordCount; ++i) {
+        sum += layout.word(int(line.firstWord + i)).confidence;
+    }
+    return sum / int(line.wordCount);
+}
+
+static int meanConfidence(const OCRResult &layout)
+{
+    if (layout.wordCount() == 0) return 0;
+    int sum = 0;
+    for (const OCRWord &word : layout.words()) {
+        sum += word.confidence;
+    }
+    return sum / layout.wordCount();
+}
+
+ScanPipeline::ScanPipeline(QObject *parent)
+    : QObject(parent), captureQueue(1), preprocessQueue(1), preprocessThread(nullptr), recognizeThread(nullptr),
+      engine(new TesseractEngine()), pool(nullptr), tracker(new DirtyRegionTracker()), detector(new TextDetector()),
+      resultCache(new OCRResultCache()), scroller(new ScrollDetector()), classifier(new ContentClassifier()),
+      nonTextFrames(0), nextSequence(0), running(0), downscaleFactor(1), binarization(ImageKernels::NoBinarization),
+      textDetection(1), lossless(0), contentFilter(1), paused(0), refineConfidence(DEFAULT_REFINE_CONFIDENCE),
+      coarseScale(DEFAULT_COARSE_SCALE), latency(0), processed(0), skipped(0), refined(0), scanned(0)
+{
+    qRegisterMetaType<QVector<OCRTextBlock>>();
+    qRegisterMetaType<OCRTextDelta>();
+    qRegisterMetaType<OCRResult>();
+    clock.start();
+}
+
+ScanPipeline::~ScanPipeline()
+{
+    stop();
+    delete classifier;
+    delete scroller;
+    delete resultCache;
+    delete detector;
+    delete tracker;
+    delete engine;
+}
+
+void ScanPipeline::start()
+{
+    if (running.loadAcquire()) return;
+
+    captureQueue.reopen();
+    preprocessQueue.reopen();
+    tracker->reset();
+    blocks.clear();
+    reported.clear();
+    lastText.clear();
+    previousImage = QImage();
+    classifier->reset();
+    nonTextFrames = 0;
+    paused.storeRelaxed(0);
+    running.storeRelease(1);
+
+    preprocessThread = QThread::create([this]() { preprocessLoop(); });
+    recognizeThread = QThread::create([this]() { recognizeLoop(); });
+    preprocessThread->start();
+    recognizeThread->start();
+}
+
+void ScanPipeline::stop()
+{
+    if (!running.loadAcquire()) return;
+
+    running.storeRelease(0);
+    captureQueue.close();
+    preprocessQueue.close();
+
+    // 识别线程可能正在处理一帧，等待其完成后再释放
+    preprocessThread->wait();
+    recognizeThread->wait();
+    delete preprocessThread;
+    delete recognizeThread;
+    preprocessThread = nullptr;
+    recognizeThread = nullptr;
+}
+
+bool ScanPipeline::isRunning() const
+{
+    return running.loadAcquire();
+}
+
+void ScanPipeline::submitFrame(const QImage &frame, const QPoint &origin)
+{
+    if (!running.loadAcquire() || frame.isNull()) return;
+
+    ScanFrame item;
+    item.image = frame;
+    item.origin = origin;
+    item.captureTime = clock.elapsed();
+    item.sequence = nextSequence++;
+    if (lossless.loadRelaxed()) {
+        captureQueue.pushWait(item);
+    } else {
+        captureQueue.push(item);
+    }
+}
+
+void ScanPipeline::setDownscaleFactor(int factor)
+{
+    downscaleFactor.storeRelaxed(qMax(1, factor));
+}
+
+void ScanPipeline::setBinarization(ImageKernels::Binarization mode)
+{
+    binarization.storeRelaxed(mode);
+}
+
+void ScanPipeline::setTextDetectionEnabled(bool enabled)
+{
+    textDetection.storeRelaxed(enabled ? 1 : 0);
+}
+
+void ScanPipeline::setContentFilterEnabled(bool enabled)
+{
+    contentFilter.storeRelaxed(enabled ? 1 : 0);
+}
+
+bool ScanPipeline::isRecognitionPaused() const
+{
+    return paused.loadRelaxed();
+}
+
+void ScanPipeline::setRefineConfidence(int threshold)
+{
+    refineConfidence.storeRelaxed(qBound(0, threshold, 100));
+}
+
+void ScanPipeline::setCoarseScale(int factor)
+{
+    coarseScale.storeRelaxed(qMax(1, factor));
+}
+
+void ScanPipeline::setRecognizerPool(RegionRecognizer *recognizerPool)
+{
+    if (running.loadAcquire()) {
+        qDebug() << "ScanPipeline::setRecognizerPool called while running, ignored";
+        return;
+    }
+    pool = recognizerPool;
+}
+
+void ScanPipeline::setLossless(bool enabled)
+{
+    lossless.storeRelaxed(enabled ? 1 : 0);
+}
+
+bool ScanPipeline::isLossless() const
+{
+    return lossless.loadRelaxed();
+}
+
+quint64 ScanPipeline::processedFrames() const
+{
+    return processed.loadAcquire();
+}
+
+quint64 ScanPipeline::skippedFrames() const
+{
+    return skipped.loadRelaxed();
+}
+
+quint64 ScanPipeline::droppedFrames() const
+{
+    return captureQueue.droppedCount() + preprocessQueue.droppedCount();
+}
+
+qint64 ScanPipeline::lastLatency() const
+{
+    return latency.loadRelaxed();
+}
+
+quint64 ScanPipeline::cacheHits() const
+{
+    return resultCache->hits();
+}
+
+quint64 ScanPipeline::cacheMisses() const
+{
+    return resultCache->misses();
+}
+
+double ScanPipeline::cacheHitRate() const
+{
+    return resultCache->hitRate();
+}
+
+quint64 ScanPipeline::refinedPixels() const
+{
+    return refined.loadRelaxed();
+}
+
+quint64 ScanPipeline::scannedPixels() const
+{
+    return scanned.loadRelaxed();
+}
+
+double ScanPipeline::refinedAreaRatio() const
+{
+    const quint64 total = scanned.loadRelaxed();
+    return total > 0 ? double(refined.loadRelaxed()) / total : 0.0;
+}
+
+void ScanPipeline::preprocessLoop()
+{
+    ScanFrame item;
+    while (running.loadAcquire()) {
+        if (!captureQueue.pop(item)) continue;
+
+        // 转为灰度，后续哈希和识别的数据量只有ARGB32的四分之一
+        const QImage original = item.image;
+        item.image = ImageKernels::toGray(item.image);
+
+        // 视频、游戏、照片占满画面时识别结果基本是乱码，跳过识别；
+        // 报告耗时为0、无变化，调度器会退避到最低帧率，只保留分类的开销
+        bool pause = false;
+        if (contentFilter.loadRelaxed()) {
+            const bool text = classifier->classify(original, item.image) == ContentClassifier::Text;
+            nonTextFrames = text ? 0 : nonTextFrames + 1;
+            pause = nonTextFrames >= PAUSE_AFTER_FRAMES;
+        }
+        if (pause != bool(paused.loadRelaxed())) {
+            paused.storeRelaxed(pause ? 1 : 0);
+            emit recognitionPausedChanged(pause);
+        }
+        if (pause) {
+            skipped.fetchAndAddRelaxed(1);
+            processed.fetchAndAddRelease(1);
+            emit frameProcessed(0, 0.0);
+            continue;
+        }
+
+        // HiDPI屏幕按缩放比例降采样；100%缩放的大屏幕开启两遍识别时另按粗识别倍数降采样
+        const bool refining = refineConfidence.loadRelaxed() > 0;
+        int factor = downscaleFactor.loadRelaxed();
+        if (refining && qint64(item.image.width()) * item.image.height() >= COARSE_MIN_PIXELS) {
+            factor = qMax(factor, int(coarseScale.loadRelaxed()));
+        }
+        if (factor > 1) {
+            // 精细识别需要原始分辨率的灰度图，不做二值化，由Tesseract自行阈值化
+            item.fullImage = refining ? item.image : QImage();
+            item.image = ImageKernels::downscale(item.image, factor);
+            item.scale = factor;
+        }
+        const int mode = binarization.loadRelaxed();
+        if (mode != ImageKernels::NoBinarization) {
+            item.image = ImageKernels::binarize(item.image, ImageKernels::Binarization(mode));
+        }
+        if (lossless.loadRelaxed()) {
+            preprocessQueue.pushWait(item);
+        } else {
+            preprocessQueue.push(item);
+        }
+    }
+}
+
+void ScanPipeline::recognizeLoop()
+{
+    // 模型在识别线程中加载，不阻塞GUI线程；使用线程池时由池中各线程加载
+    if (!pool && !engine->isReady()) {
+        engine->init();
+    }
+
+    ScanFrame item;
+    while (running.loadAcquire()) {
+        if (!preprocessQueue.pop(item)) continue;
+        QElapsedTimer processingTimer;
+        processingTimer.start();
+
+        QString recognizedText = textDetection.loadRelaxed() ? recognizeBlocks(item) : recognizeDirtyRuns(item);
+        latency.storeRelaxed(clock.elapsed() - item.captureTime);
+        scanned.fetchAndAddRelaxed(quint64(item.image.width()) * item.image.height() * quint64(item.scale * item.scale));
+        processed.fetchAndAddRelease(1);
+        const int tiles = tracker->tileCount();
+        emit frameProcessed(processingTimer.elapsed(), tiles > 0 ? double(tracker->dirtyTileCount()) / tiles : 0.0);
+
+        // 文字没有变化时不重复输出
+        if (recognizedText != lastText) {
+            lastText = recognizedText;
+            emit textRecognized(recognizedText);
+        }
+    }
+}
+
+QString ScanPipeline::recognizeBlocks(const ScanFrame &item)
+{
+    tracker->update(item.image);
+
+    // 整帧未变化时直接复用上一帧的文字区域
+    if (tracker->dirtyTileCount() > 0) {
+        // 滚动时区域内几乎所有瓦片都会变化：估计位移后平移上一帧的文字区域，只识别新露出的部分
+        QRect scrollRegion;
+        QRect exposed;
+        QPoint scrollOffset;
+        if (tracker->dirtyTileCount() >= MIN_SCROLL_TILES && !blocks.isEmpty()) {
+            const QRect dirty = tracker->dirtyBounds();
+            if (scroller->estimate(previousImage, item.image, dirty, scrollOffset)) {
+                scrollRegion = dirty;
+                exposed = ScrollDetector::exposedRect(dirty, scrollOffset);
+            }
+        }
+
+        const QVector<QRect> boxes = detector->detect(item.image);
+        QVector<OCRTextBlock> next;
+        QVector<QRect> pending;
+        QVector<int> pendingIndex;
+        QVector<QByteArray> pendingKeys;
+        for (const QRect &box : boxes) {
+            OCRTextBlock block;
+            block.rect = box;
+            // 位置相同且覆盖的瓦片都没有变化的区域沿用上一帧的文字，滚动区域内按平移前的位置对应
+            int match = tracker->isDirty(box) ? -1 : BlockMatcher::findSame(blocks, box);
+            if (match < 0 && !scrollRegion.isNull() && !box.intersects(exposed)) {
+                match = BlockMatcher::findShifted(blocks, box, scrollRegion, scrollOffset, detector->scale());
+            }
+            const bool reused = match >= 0;
+            if (reused) {
+                block.text = blocks[match].text;
+                block.id = blocks[match].id;
+                block.words = blocks[match].words;
+            }
+            // 内容相同的区域（滚动、切换回来的窗口、重复的菜单项）从缓存中取结果
+            if (!reused) {
+                const QByteArray key = OCRResultCache::perceptualHash(item.image, box);
+                OCRCachedText cached;
+                if (resultCache->lookup(key, cached)) {
+                    block.text = cached.text;
+                    block.words = cached.words;
+                } else {
+                    pending.append(box);
+                    pendingIndex.append(next.size());
+                    pendingKeys.append(key);
+                }
+            }
+            next.append(block);
+        }
+
+        if (!pending.isEmpty()) {
+            QVector<int> confidences;
+            QVector<OCRResult> layouts;
+            QStringList texts = recognizeCoarseToFine(item, pending, &confidences, &layouts);
+            for (int i = 0; i < pendingIndex.size(); ++i) {
+                next[pendingIndex[i]].text = texts.value(i);
+                next[pendingIndex[i]].words = layouts.value(i);
+                if (confidences.value(i) >= CACHE_MIN_CONFIDENCE) {
+                    OCRCachedText result;
+                    result.text = texts.value(i);
+                    result.confidence = confidences.value(i);
+                    result.words = layouts.value(i);
+                    resultCache->insert(pendingKeys[i], result);
+                }
+            }
+        }
+
+        // 新识别的区域与上一帧重叠足够多时视为同一区域（文字被编辑），沿用编号
+        BlockMatcher::assignIds(next, blocks, MIN_ID_OVERLAP);
+
+        // 按阅读顺序排列：先上后下，再从左到右
+        std::sort(next.begin(), next.end(), [](const OCRTextBlock &a, const OCRTextBlock &b) {
+            return a.rect.top() != b.rect.top() ? a.rect.top() < b.rect.top() : a.rect.left() < b.rect.left();
+        });
+        blocks = next;
+    }
+    previousImage = item.image;
+
+    QStringList lines;
+    QVector<OCRTextBlock> screenBlocks;
+    for (const OCRTextBlock &block : blocks) {
+        if (block.text.isEmpty()) continue;
+        lines << block.text;
+        OCRTextBlock mapped = block;
+        mapped.rect = QRect(block.rect.topLeft() * item.scale + item.origin, block.rect.size() * item.scale);
+        screenBlocks.append(mapped);
+    }
+
+    // 只在有变化时输出，下游的工作量与变化量成正比
+    OCRTextDelta delta = BlockMatcher::diff(reported, screenBlocks);
+    if (!delta.isEmpty()) {
+        reported = screenBlocks;
+        emit blocksChanged(delta);
+        emit blocksRecognized(screenBlocks);
+
+        // 各区域的逐词结果拼成整帧结果，每个数组只扩容一次
+        int lineTotal = 0;
+        int wordTotal = 0;
+        for (const OCRTextBlock &block : screenBlocks) {
+            lineTotal += block.words.lineCount();
+            wordTotal += block.words.wordCount();
+        }
+        OCRResult result;
+        result.reserve(screenBlocks.size(), lineTotal, wordTotal, 0);
+        for (const OCRTextBlock &block : screenBlocks) {
+            if (block.words.blockCount() > 0) {
+                result.append(block.words, block.rect.topLeft(), 1, block.id);
+            } else {
+                result.addBlock(block.rect, block.id);
+            }
+        }
+        emit resultRecognized(result);
+    }
+    return lines.join('\n');
+}
+
+QString ScanPipeline::recognizeDirtyRuns(const ScanFrame &item)
+{
+    // 只识别与上一帧相比发生变化的区域，未变化区域复用缓存文字
+    QVector<QRect> dirtyRegions = tracker->update(item.image);
+    if (!dirtyRegions.isEmpty()) {
+        QStringList texts = recognizeCoarseToFine(item, dirtyRegions, nullptr);
+        for (int i = 0; i < dirtyRegions.size(); ++i) {
+            tracker->storeText(dirtyRegions[i], texts.value(i));
+        }
+    }
+    return tracker->text();
+}
+
+QStringList ScanPipeline::recognizeRegions(const QImage &image, const QVector<QRect> &regions, QVector<int> *confidences,
+                                           QVector<OCRResult> *layouts)
+{
+    if (pool) {
+        return pool->recognize(image, regions, confidences, layouts);
+    }
+    return engine->recognizeRegions(image, regions, confidences, layouts);
+}
+
+QStringList ScanPipeline::recognizeCoarseToFine(const ScanFrame &item, const QVector<QRect> &regions, QVector<int> *confidences,
+                                                QVector<OCRResult> *layouts)
+{
+    const int threshold = refineConfidence.loadRelaxed();
+    const bool refining = threshold > 0 && item.scale > 1 && !item.fullImage.isNull();
+
+    // 逐行精细识别要用到粗识别的行和词，调用方不需要时也取一份
+    QVector<int> scores;
+    QVector<OCRResult> coarse;
+    QStringList texts = recognizeRegions(item.image, regions, &scores, (layouts || refining) ? &coarse : nullptr);
+    if (item.scale > 1) {
+        for (OCRResult &layout : coarse) {
+            layout = layout.scaled(item.scale);
+        }
+    }
+
+    if (refining) {
+        // 只把低置信度的行放大回原始分辨率，大部分像素只经过便宜的降采样识别。
+        // 每个精细区域记下所属区域和行号，行号为-1表示整个区域
+        QVector<QRect> fine;
+        QVector<QPair<int, int>> fineTarget;
+        quint64 area = 0;
+        for (int i = 0; i < regions.size(); ++i) {
+            const QPoint regionOrigin = regions[i].topLeft() * item.scale;
+            const QRect regionRect = QRect(regionOrigin, regions[i].size() * item.scale).intersected(item.fullImage.rect());
+            if (regionRect.isEmpty()) continue;
+            const OCRResult layout = coarse.value(i);
+            if (layout.lineCount() == 0) {
+                // 没有逐行结果（未识别出文字或引擎不支持），按区域平均置信度决定
+                if (scores.value(i) >= threshold) continue;
+                fine.append(regionRect);
+                fineTarget.append(qMakePair(i, -1));
+                area += quint64(regionRect.width()) * regionRect.height();
+                continue;
+            }
+            for (int l = 0; l < layout.lineCount(); ++l) {
+                if (lineConfidence(layout, l) >= threshold) continue;
+                const QRect lineRect = layout.line(l).rect.translated(regionOrigin)
+                                           .adjusted(-REFINE_LINE_PADDING, -REFINE_LINE_PADDING,
+                                                     REFINE_LINE_PADDING, REFINE_LINE_PADDING)
+                                           .intersected(regionRect);
+                if (lineRect.isEmpty()) continue;
+                fine.append(lineRect);
+                fineTarget.append(qMakePair(i, l));
+                area += quint64(lineRect.width()) * lineRect.height();
+            }
+        }
+
+        if (!fine.isEmpty()) {
+            QVector<int> fineScores;
+            QVector<OCRResult> fineLayouts;
+            const QStringList fineTexts = recognizeRegions(item.fullImage, fine, &fineScores, &fineLayouts);
+
+            // 按区域收集要替换的行：行号 -> 精细结果下标
+            QHash<int, QHash<int, int>> replacedLines;
+            for (int j = 0; j < fineTarget.size(); ++j) {
+                const int i = fineTarget[j].first;
+                const int l = fineTarget[j].second;
+                if (l < 0) {
+                    // 原始分辨率的结果不一定更好，保留置信度较高的一个
+                    if (fineScores.value(j) >= scores.value(i)) {
+                        texts[i] = fineTexts.value(j);
+                        scores[i] = fineScores.value(j);
+                        coarse[i] = fineLayouts.value(j);
+                    }
+                    continue;
+                }
+                const OCRResult fineLayout = fineLayouts.value(j);
+                if (fineLayout.wordCount() > 0 && fineScores.value(j) >= lineConfidence(coarse[i], l)) {
+                    replacedLines[i].insert(l, j);
+                }
+            }
+
+            for (auto region = replacedLines.cbegin(); region != replacedLines.cend(); ++region) {
+                const int i = region.key();
+                const QPoint regionOrigin = regions[i].topLeft() * item.scale;
+                const OCRResult &layout = coarse[i];
+                OCRResult merged;
+                for (int b = 0; b < layout.blockCount(); ++b) {
+                    const OCRBlock &block = layout.block(b);
+                    merged.addBlock(block.rect, block.id);
+                    for (quint32 k = 0; k < block.lineCount; ++k) {
+                        const int l = int(block.firstLine + k);
+                        const OCRLine &line = layout.line(l);
+                        merged.addLine(line.rect);
+                        const auto found = region.value().find(l);
+                        if (found == region.value().end()) {
+                            for (quint32 w = 0; w < line.wordCount; ++w) {
+                                const int index = int(line.firstWord + w);
+                                const QByteArrayView utf8 = layout.wordUtf8(index);
+                                merged.addWord(layout.word(index).rect, utf8.data(), int(utf8.size()),
+                                               layout.word(index).confidence);
+                            }
+                            continue;
+                        }
+                        // 精细结果的坐标相对于裁剪的行，换算回相对于区域
+                        const OCRResult &fineLayout = fineLayouts[found.value()];
+                        const QPoint offset = fine[found.value()].topLeft() - regionOrigin;
+                        for (int w = 0; w < fineLayout.wordCount(); ++w) {
+                            const QByteArrayView utf8 = fineLayout.wordUtf8(w);
+                            merged.addWord(fineLayout.word(w).rect.translated(offset), utf8.data(), int(utf8.size()),
+                                           fineLayout.word(w).confidence);
+                        }
+                    }
+                }
+                texts[i] = merged.text();
+                scores[i] = meanConfidence(merged);
+                coarse[i] = merged;
+            }
+            refined.fetchAndAddRelaxed(area);
+        }
+    }
+
+    if (layouts) {
+        *layouts = coarse;
+    }
+    if (confidences) {
+        *confidences = scores;
+    }
+    return texts;
+}
@@ -0,0 +1,164 @@
+#ifndef SCANPIPELINE_H
+#define SCANPIPELINE_H
+
+#include <QtCore/qglobal.h>
+
+#ifndef OCR_EXPORT
+#ifdef OCR_LIBRARY
+#define OCR_EXPORT Q_DECL_EXPORT
+#else
+#define OCR_EXPORT Q_DECL_IMPORT
+#endif
+#endif
+
+#include <QObject>
+#include <QImage>
+#include <QPoint>
+#include <QString>
+#include <QElapsedTimer>
+#include <QAtomicInteger>
+#include "boundedqueue.h"
+#include "imagekernels.h"
+#include "ocrtypes.h"
+
+class QThread;
+class TesseractEngine;
+class DirtyRegionTracker;
+class TextDetector;
+class OCRResultCache;
+class ScrollDetector;
+class RegionRecognizer;
+class ContentClassifier;
+
+// 流水线中传递的一帧
+struct ScanFrame {
+    QImage image;
+    qint64 captureTime = 0; // 流水线时钟，毫秒
+    quint64 sequence = 0;
+    int scale = 1;          // 预处理降采样倍数，识别结果坐标需要乘回去
+    QPoint origin;          // 截图左上角在屏幕中的像素位置，只截取部分区域时不为零
+    QImage fullImage;       // 降采样前的灰度图，只在需要精细识别时保留
+};
+
+// 屏幕识别流水线：采集 -> 预处理 -> 识别 -> textRecognized
+// 预处理和识别各自运行在工作线程上，阶段之间用容量为1的有界队列连接，
+// 下游忙时旧帧直接丢弃。GUI线程只负责提交截图和接收最终结果。
+class OCR_EXPORT ScanPipeline : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ScanPipeline(QObject *parent = nullptr);
+    ~ScanPipeline();
+
+    void start();
+    void stop();
+    bool isRunning() const;
+
+    // 采集阶段调用，除无丢帧模式外不会阻塞。origin为截图在屏幕中的位置，识别结果坐标会加上该偏移
+    void submitFrame(const QImage &frame, const QPoint &origin = QPoint());
+
+    // 预处理选项：HiDPI屏幕按整数倍降采样，可选二值化
+    void setDownscaleFactor(int factor);
+    void setBinarization(ImageKernels::Binarization mode);
+
+    // 只识别检测到的文字区域，关闭时按脏瓦片区间识别
+    void setTextDetectionEnabled(bool enabled);
+
+    // 视频、游戏、照片占满画面时暂停识别，默认开启
+    void setContentFilterEnabled(bool enabled);
+    bool isRecognitionPaused() const;
+
+    // 两遍识别：先在降采样图像上识别，置信度低于threshold的行再裁剪原始分辨率图像重新识别，
+    // 没有逐行结果的区域按区域平均置信度整块重新识别。0表示关闭；未降采样时不起作用
+    void setRefineConfidence(int threshold);
+    // 两遍识别开启时，大尺寸截图（2560x1440及以上）即使屏幕缩放为100%也按该倍数降采样做粗识别，
+    // 屏幕缩放比例更大时取两者中较大的一个。1表示只按屏幕缩放降采样，默认2
+    void setCoarseScale(int factor);
+
+    // 使用共享的识别器（线程池或识别进程池）并行识别各区域，为空时在识别线程中用自己的引擎逐个识别。
+    // 识别器由调用方持有，只能在start()之前设置
+    void setRecognizerPool(RegionRecognizer *pool);
+
+    // 无丢帧模式：submitFrame()在下游忙时阻塞而不是丢弃旧帧，用于回放录制帧做基准测试
+    void setLossless(bool enabled);
+    bool isLossless() const;
+
+    // 已处理完成的帧数
+    quint64 processedFrames() const;
+    // 其中因画面不含文字而跳过识别的帧数
+    quint64 skippedFrames() const;
+
+    quint64 droppedFrames() const;
+    qint64 lastLatency() const;
+
+    // 识别结果缓存统计
+    quint64 cacheHits() const;
+    quint64 cacheMisses() const;
+    double cacheHitRate() const;
+
+    // 精细识别统计：原始分辨率下重新识别的像素数与处理过的帧的总像素数
+    quint64 refinedPixels() const;
+    quint64 scannedPixels() const;
+    double refinedAreaRatio() const;
+
+signals:
+    // 以下信号在识别线程中发出，连接到GUI对象时自动排队；内容没有变化的帧不发出
+    void textRecognized(const QString &text);
+    // 每个文字区域的屏幕坐标和识别结果
+    void blocksRecognized(const QVector<OCRTextBlock> &blocks);
+    // 与上一次输出相比新增、变化和消失的文字区域
+    void blocksChanged(const OCRTextDelta &delta);
+    // 与blocksRecognized同时发出：整帧的区域、行、词及置信度，坐标为屏幕像素坐标。仅在文字区域检测模式下发出
+    void resultRecognized(const OCRResult &result);
+    // 每处理完一帧发出：识别阶段耗时（毫秒）和变化瓦片占比，供调度器使用
+    void frameProcessed(qint64 processingMs, double changeRatio);
+    // 连续多帧判为非文字画面时暂停识别，出现文字画面后立即恢复；在预处理线程中发出
+    void recognitionPausedChanged(bool paused);
+
+private:
+    void preprocessLoop();
+    void recognizeLoop();
+    QString recognizeBlocks(const ScanFrame &item);
+    QString recognizeDirtyRuns(const ScanFrame &item);
+    QStringList recognizeRegions(const QImage &image, const QVector<QRect> &regions, QVector<int> *confidences,
+                                 QVector<OCRResult> *layouts = nullptr);
+    // 先粗后精：regions为预处理后坐标，低置信度区域在item.fullImage上重新识别。
+    // layouts的坐标统一换算为截图像素
+    QStringList recognizeCoarseToFine(const ScanFrame &item, const QVector<QRect> &regions, QVector<int> *confidences,
+                                      QVector<OCRResult> *layouts = nullptr);
+
+    BoundedQueue<ScanFrame> captureQueue;
+    BoundedQueue<ScanFrame> preprocessQueue;
+    QThread *preprocessThread;
+    QThread *recognizeThread;
+    TesseractEngine *engine;     // 只在识别线程中使用
+    RegionRecognizer *pool;      // 不为空时代替engine
+    DirtyRegionTracker *tracker; // 只在识别线程中使用
+    TextDetector *detector;      // 只在识别线程中使用
+    OCRResultCache *resultCache; // 内部加锁，统计可在任意线程读取
+    ScrollDetector *scroller;    // 只在识别线程中使用
+    ContentClassifier *classifier; // 只在预处理线程中使用
+    int nonTextFrames;           // 连续的非文字帧数，只在预处理线程中使用
+    QVector<OCRTextBlock> blocks; // 上一帧的文字区域（预处理后坐标），只在识别线程中使用
+    QVector<OCRTextBlock> reported; // 最近一次输出的文字区域（屏幕坐标），只在识别线程中使用
+    QString lastText;             // 最近一次输出的文字，只在识别线程中使用
+    QImage previousImage;         // 上一帧预处理后的图像，用于滚动检测，只在识别线程中使用
+    QElapsedTimer clock;
+    quint64 nextSequence;
+    QAtomicInteger<int> running;
+    QAtomicInteger<int> downscaleFactor;
+    QAtomicInteger<int> binarization;
+    QAtomicInteger<int> textDetection;
+    QAtomicInteger<int> lossless;
+    QAtomicInteger<int> contentFilter;
+    QAtomicInteger<int> paused;
+    QAtomicInteger<int> refineConfidence;
+    QAtomicInteger<int> coarseScale;
+    QAtomicInteger<qint64> latency;
+    QAtomicInteger<quint64> processed;
+    QAtomicInteger<quint64> skipped;
+    QAtomicInteger<quint64> refined;
+    QAtomicInteger<quint64> scanned;
+};
+
+#endif // SCANPIPELINE_H
@@ -0,0 +1,149 @@
+#include "scanscheduler.h"
+#include <QtGlobal>
+#include <QThread>
+#include <cmath>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+static const double PROCESSING_SMOOTHING = 0.3; // 耗时指数平均的权重
+static const double LOAD_SMOOTHING = 0.3;       // CPU占用指数平均的权重
+static const double IDLE_BACKOFF = 1.5;         // 每个静止帧的间隔增长倍数
+static const int IDLE_GRACE_FRAMES = 3;         // 连续静止多少帧后开始退避
+static const double THROTTLE_STEP = 1.25;       // 超出或低于预算时每帧调整的最大倍数
+static const qint64 MIN_SAMPLE_NSECS = 100 * 1000 * 1000; // 测量CPU占用的最短时间窗，太短时时钟精度不够
+
+ScanScheduler::ScanScheduler()
+    : minRate(1.0), maxRate(30.0), loadBudget(0.5), processingEma(0.0), loadEma(0.0), throttle(1.0),
+      intervalMs(1000.0 / 30.0), idleFrames(0), cores(qMax(1, QThread::idealThreadCount())), measuredLoad(0.0),
+      sampleCpu(-1)
+{
+}
+
+void ScanScheduler::setFpsRange(double minFps, double maxFps)
+{
+    if (minFps <= 0.0 || maxFps < minFps) return;
+    minRate = minFps;
+    maxRate = maxFps;
+    intervalMs = qBound(1000.0 / maxRate, intervalMs, 1000.0 / minRate);
+}
+
+double ScanScheduler::minFps() const
+{
+    return minRate;
+}
+
+double ScanScheduler::maxFps() const
+{
+    return maxRate;
+}
+
+void ScanScheduler::setMaxCpuLoad(double load)
+{
+    loadBudget = qBound(0.05, load, 1.0);
+}
+
+double ScanScheduler::maxCpuLoad() const
+{
+    return loadBudget;
+}
+
+int ScanScheduler::update(qint64 processingMs, double changeRatio)
+{
+    // 两次测量之间进程用掉的CPU时间 / (墙钟时间 x 核心数)
+    const qint64 cpu = processCpuTime();
+    if (cpu >= 0) {
+        if (sampleCpu < 0 || !sampleClock.isValid()) {
+            sampleCpu = cpu;
+            sampleClock.start();
+        } else if (sampleClock.nsecsElapsed() >= MIN_SAMPLE_NSECS) {
+            const double wallUs = double(sampleClock.nsecsElapsed()) / 1000.0;
+            measuredLoad = qMax(0.0, double(cpu - sampleCpu) / (wallUs * cores));
+            sampleCpu = cpu;
+            sampleClock.restart();
+        }
+    }
+    return update(processingMs, changeRatio, measuredLoad);
+}
+
+int ScanScheduler::update(qint64 processingMs, double changeRatio, double cpuLoad)
+{
+    processingEma = processingEma <= 0.0
+        ? double(processingMs)
+        : (1.0 - PROCESSING_SMOOTHING) * processingEma + PROCESSING_SMOOTHING * double(processingMs);
+    loadEma = (1.0 - LOAD_SMOOTHING) * loadEma + LOAD_SMOOTHING * qMax(0.0, cpuLoad);
+
+    const double slowest = 1000.0 / minRate;
+    const double base = qMax(1000.0 / maxRate, processingEma);
+
+    // 占用超出预算时放大倍数逐帧增大，低于预算时逐帧回落，最终稳定在预算附近
+    const double ratio = loadEma / loadBudget;
+    throttle = qBound(1.0, throttle * qBound(1.0 / THROTTLE_STEP, ratio, THROTTLE_STEP), qMax(1.0, slowest / base));
+
+    // 最短间隔：不快于识别速度，也不超出CPU余量
+    const double fastest = base * throttle;
+
+    if (changeRatio > 0.0) {
+        // 输入、滚动等活动：立即回到最快频率
+        idleFrames = 0;
+        intervalMs = fastest;
+    } else if (++idleFrames > IDLE_GRACE_FRAMES) {
+        intervalMs = qMax(intervalMs, fastest) * IDLE_BACKOFF;
+    } else {
+        intervalMs = qMax(intervalMs, fastest);
+    }
+
+    intervalMs = qBound(fastest, intervalMs, qMax(fastest, slowest));
+    return interval();
+}
+
+int ScanScheduler::interval() const
+{
+    return int(std::lround(intervalMs));
+}
+
+double ScanScheduler::currentFps() const
+{
+    return intervalMs > 0.0 ? 1000.0 / intervalMs : maxRate;
+}
+
+double ScanScheduler::cpuLoad() const
+{
+    return loadEma;
+}
+
+void ScanScheduler::reset()
+{
+    processingEma = 0.0;
+    loadEma = 0.0;
+    throttle = 1.0;
+    intervalMs = 1000.0 / maxRate;
+    idleFrames = 0;
+    measuredLoad = 0.0;
+    sampleCpu = -1;
+    sampleClock.invalidate();
+}
+
+qint64 ScanScheduler::processCpuTime()
+{
+#ifdef Q_OS_WIN
+    FILETIME creation;
+    FILETIME exit;
+    FILETIME kernel;
+    FILETIME user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) return -1;
+    // FILETIME以100纳秒为单位
+    auto toMicroseconds = [](const FILETIME &time) {
+        return qint64((quint64(time.dwHighDateTime) << 32) | time.dwLowDateTime) / 10;
+    };
+    return toMicroseconds(kernel) + toMicroseconds(user);
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+    return (qint64(usage.ru_utime.tv_sec) + usage.ru_stime.tv_sec) * 1000000 + usage.ru_utime.tv_usec +
+           usage.ru_stime.tv_usec;
+#endif
+}
@@ -0,0 +1,65 @@
+#ifndef SCANSCHEDULER_H
+#define SCANSCHEDULER_H
+
+#include <QtCore/qglobal.h>
+
+#ifndef OCR_EXPORT
+#ifdef OCR_LIBRARY
+#define OCR_EXPORT Q_DECL_EXPORT
+#else
+#define OCR_EXPORT Q_DECL_IMPORT
+#endif
+#endif
+
+#include <QElapsedTimer>
+
+// 自适应扫描频率调度
+// 根据识别耗时、屏幕变化率和CPU余量计算采集间隔：
+// 屏幕静止时逐帧指数退避到最低帧率，一旦有变化立即回到允许的最高帧率；
+// 间隔不短于识别耗时。进程的CPU占用按进程CPU时间（getrusage / GetProcessTimes）与墙钟时间之比测量，
+// 除以核心数得到占整机的比例，超过maxCpuLoad时逐帧拉长间隔，回落后逐步恢复。
+class OCR_EXPORT ScanScheduler
+{
+public:
+    ScanScheduler();
+
+    void setFpsRange(double minFps, double maxFps);
+    double minFps() const;
+    double maxFps() const;
+
+    // 进程允许占用整机CPU的比例，0~1，默认0.5
+    void setMaxCpuLoad(double load);
+    double maxCpuLoad() const;
+
+    // 每处理完一帧调用一次，changeRatio为变化瓦片占比，返回新的采集间隔（毫秒）。
+    // 进程CPU占用在调用之间自行测量
+    int update(qint64 processingMs, double changeRatio);
+    // 同上，cpuLoad为调用方给出的进程CPU占用（占整机的比例）
+    int update(qint64 processingMs, double changeRatio, double cpuLoad);
+
+    int interval() const;
+    double currentFps() const;
+    // 平滑后的进程CPU占用，占整机的比例
+    double cpuLoad() const;
+
+    void reset();
+
+    // 进程累计使用的CPU时间（用户态+内核态，所有线程），微秒；获取失败时返回-1
+    static qint64 processCpuTime();
+
+private:
+    double minRate;
+    double maxRate;
+    double loadBudget;
+    double processingEma;
+    double loadEma;
+    double throttle;      // CPU占用超出预算时最短间隔的放大倍数，不小于1
+    double intervalMs;
+    int idleFrames;
+    int cores;
+    double measuredLoad;  // 最近一次测量的占用
+    qint64 sampleCpu;     // 上一次测量时的进程CPU时间
+    QElapsedTimer sampleClock;
+};
+
+#endif // SCANSCHEDULER_H
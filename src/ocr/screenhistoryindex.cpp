@@ -0,0 +1,320 @@
+#include "screenhistoryindex.h"
+#include "ocr.h"
+#include <QDateTime>
+#include <QStringList>
+#include <algorithm>
+
+static const qint64 TEXT_OVERHEAD = 96;     // 每份文字的哈希节点和容器开销估计
+static const qint64 POSTING_OVERHEAD = 48;  // 每个二元组倒排表的固定开销估计
+static const qint64 OCCURRENCE_BYTES = 64;  // 每条出现记录（含open表项）的估计
+static const quint64 TEXT_KEY_BIT = quint64(1) << 63; // 纯文字输出的行与区域编号区分开
+
+// 小写化并把连续空白合并为一个空格
+static QString normalize(const QString &text)
+{
+    QString out;
+    out.reserve(text.size());
+    bool space = false;
+    for (const QChar ch : text.toCaseFolded()) {
+        if (ch.isSpace()) {
+            space = !out.isEmpty();
+            continue;
+        }
+        if (space) {
+            out += QLatin1Char(' ');
+            space = false;
+        }
+        out += ch;
+    }
+    return out;
+}
+
+// 字母数字连续段内相邻两个字符组成一个词项，去重后升序
+static QVector<quint32> bigrams(const QString &normalized)
+{
+    QVector<quint32> grams;
+    for (int i = 0; i + 1 < normalized.size(); ++i) {
+        const QChar a = normalized.at(i);
+        const QChar b = normalized.at(i + 1);
+        if (!a.isLetterOrNumber() || !b.isLetterOrNumber()) continue;
+        grams.append((quint32(a.unicode()) << 16) | b.unicode());
+    }
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+    return grams;
+}
+
+static qint64 now()
+{
+    return QDateTime::currentMSecsSinceEpoch();
+}
+
+ScreenHistoryIndex::ScreenHistoryIndex(qint64 maxBytes, QObject *parent)
+    : QObject(parent), firstSequence(0), positional(false), nextTextId(0), budget(maxBytes), used(0)
+{
+}
+
+void ScreenHistoryIndex::attach(OCRModule *module)
+{
+    connect(module, &OCRModule::blocksChanged, this, &ScreenHistoryIndex::onBlocksChanged);
+    connect(module, &OCRModule::textRecognized, this, [this](const QString &text) {
+        bool blocks = false;
+        {
+            QReadLocker locker(&lock);
+            blocks = positional;
+        }
+        if (!blocks) onTextRecognized(text);
+    });
+}
+
+void ScreenHistoryIndex::setMaxBytes(qint64 maxBytes)
+{
+    QWriteLocker locker(&lock);
+    budget = maxBytes;
+    evict();
+}
+
+qint64 ScreenHistoryIndex::maxBytes() const
+{
+    QReadLocker locker(&lock);
+    return budget;
+}
+
+qint64 ScreenHistoryIndex::usedBytes() const
+{
+    QReadLocker locker(&lock);
+    return used;
+}
+
+int ScreenHistoryIndex::textCount() const
+{
+    QReadLocker locker(&lock);
+    return texts.size();
+}
+
+int ScreenHistoryIndex::occurrenceCount() const
+{
+    QReadLocker locker(&lock);
+    return int(occurrences.size());
+}
+
+qint64 ScreenHistoryIndex::oldestTimestamp() const
+{
+    QReadLocker locker(&lock);
+    return occurrences.empty() ? -1 : occurrences.front().firstSeen;
+}
+
+void ScreenHistoryIndex::onBlocksChanged(const OCRTextDelta &delta)
+{
+    const qint64 timestamp = now();
+    QWriteLocker locker(&lock);
+    if (!positional) {
+        // 此前按纯文字记录的行到此为止，之后只按区域记录
+        positional = true;
+        for (const QString &line : std::as_const(currentLines)) {
+            removeBlockLocked(TEXT_KEY_BIT | quint64(qHash(line)), timestamp);
+        }
+        currentLines.clear();
+    }
+    for (quint64 id : delta.removed) {
+        removeBlockLocked(id, timestamp);
+    }
+    // 变化的区域：旧文字到此为止，新文字记为新的出现
+    for (const OCRTextBlock &block : delta.changed) {
+        removeBlockLocked(block.id, timestamp);
+        addBlockLocked(block.id, block.text, delta.screen, block.rect, timestamp);
+    }
+    for (const OCRTextBlock &block : delta.added) {
+        addBlockLocked(block.id, block.text, delta.screen, block.rect, timestamp);
+    }
+    evict();
+}
+
+void ScreenHistoryIndex::onTextRecognized(const QString &text)
+{
+    const qint64 timestamp = now();
+    QSet<QString> lines;
+    for (const QString &line : text.split(QLatin1Char('\n'))) {
+        const QString trimmed = line.trimmed();
+        if (!trimmed.isEmpty()) lines.insert(trimmed);
+    }
+
+    QWriteLocker locker(&lock);
+    for (const QString &line : std::as_const(currentLines)) {
+        if (!lines.contains(line)) removeBlockLocked(TEXT_KEY_BIT | quint64(qHash(line)), timestamp);
+    }
+    for (const QString &line : std::as_const(lines)) {
+        if (!currentLines.contains(line)) addBlockLocked(TEXT_KEY_BIT | quint64(qHash(line)), line, -1, QRect(), timestamp);
+    }
+    currentLines = lines;
+    evict();
+}
+
+void ScreenHistoryIndex::addBlock(quint64 key, const QString &text, int screen, const QRect &rect, qint64 timestamp)
+{
+    QWriteLocker locker(&lock);
+    addBlockLocked(key, text, screen, rect, timestamp < 0 ? now() : timestamp);
+    evict();
+}
+
+void ScreenHistoryIndex::removeBlock(quint64 key, qint64 timestamp)
+{
+    QWriteLocker locker(&lock);
+    removeBlockLocked(key, timestamp < 0 ? now() : timestamp);
+}
+
+void ScreenHistoryIndex::addBlockLocked(quint64 key, const QString &text, int screen, const QRect &rect, qint64 timestamp)
+{
+    if (text.trimmed().isEmpty()) return;
+    removeBlockLocked(key, timestamp);
+
+    const quint32 textId = internText(text);
+    Occurrence occurrence;
+    occurrence.textId = textId;
+    occurrence.screen = screen;
+    occurrence.rect = rect;
+    occurrence.firstSeen = timestamp;
+    occurrence.lastSeen = -1;
+    occurrence.key = key;
+    const quint64 sequence = firstSequence + occurrences.size();
+    occurrences.push_back(occurrence);
+    texts[textId].occurrences.push_back(sequence);
+    open.insert(key, sequence);
+    used += OCCURRENCE_BYTES;
+}
+
+void ScreenHistoryIndex::removeBlockLocked(quint64 key, qint64 timestamp)
+{
+    auto it = open.find(key);
+    if (it == open.end()) return;
+    if (it.value() >= firstSequence) {
+        occurrences[it.value() - firstSequence].lastSeen = timestamp;
+    }
+    open.erase(it);
+}
+
+quint32 ScreenHistoryIndex::internText(const QString &text)
+{
+    // 相同的文字只建一次索引
+    auto found = textIds.constFind(text);
+    if (found != textIds.constEnd()) return found.value();
+
+    const quint32 id = nextTextId++;
+    TextEntry entry;
+    entry.text = text;
+    entry.normalized = normalize(text);
+    const QVector<quint32> grams = bigrams(entry.normalized);
+    entry.bytes = TEXT_OVERHEAD + 2 * (text.size() + entry.normalized.size()) * qint64(sizeof(QChar)) +
+                  grams.size() * qint64(sizeof(quint32));
+    for (quint32 gram : grams) {
+        QVector<quint32> &list = postings[gram];
+        if (list.isEmpty()) entry.bytes += POSTING_OVERHEAD;
+        list.append(id); // 编号递增，追加后仍然有序
+    }
+    used += entry.bytes;
+    textIds.insert(text, id);
+    texts.insert(id, entry);
+    return id;
+}
+
+void ScreenHistoryIndex::releaseText(quint32 id)
+{
+    auto it = texts.find(id);
+    if (it == texts.end()) return;
+    for (quint32 gram : bigrams(it->normalized)) {
+        auto list = postings.find(gram);
+        if (list == postings.end()) continue;
+        auto pos = std::lower_bound(list->begin(), list->end(), id);
+        if (pos != list->end() && *pos == id) list->erase(pos);
+        if (list->isEmpty()) postings.erase(list);
+    }
+    used -= it->bytes;
+    textIds.remove(it->text);
+    texts.erase(it);
+}
+
+void ScreenHistoryIndex::evict()
+{
+    // 从最早的出现记录开始淘汰，最后一条记录引用的文字随之删除
+    while (used > budget && !occurrences.empty()) {
+        const Occurrence &oldest = occurrences.front();
+        auto entry = texts.find(oldest.textId);
+        if (entry != texts.end()) {
+            entry->occurrences.pop_front();
+            if (entry->occurrences.empty()) releaseText(oldest.textId);
+        }
+        auto openIt = open.find(oldest.key);
+        if (openIt != open.end() && openIt.value() == firstSequence) open.erase(openIt);
+        occurrences.pop_front();
+        ++firstSequence;
+        used -= OCCURRENCE_BYTES;
+    }
+}
+
+QVector<ScreenHistoryHit> ScreenHistoryIndex::search(const QString &query, int limit) const
+{
+    QVector<ScreenHistoryHit> hits;
+    const QString needle = normalize(query);
+    if (needle.isEmpty() || limit <= 0) return hits;
+
+    QReadLocker locker(&lock);
+
+    // 候选文字：各二元组倒排表的交集，从最短的表开始；单个字符的查询没有二元组，逐个检查
+    QVector<quint32> candidates;
+    const QVector<quint32> grams = bigrams(needle);
+    if (grams.isEmpty()) {
+        candidates = texts.keys();
+    } else {
+        QVector<const QVector<quint32> *> lists;
+        for (quint32 gram : grams) {
+            auto list = postings.constFind(gram);
+            if (list == postings.constEnd()) return hits;
+            lists.append(&list.value());
+        }
+        std::sort(lists.begin(), lists.end(), [](const QVector<quint32> *a, const QVector<quint32> *b) {
+            return a->size() < b->size();
+        });
+        candidates = *lists.first();
+        for (int i = 1; i < lists.size() && !candidates.isEmpty(); ++i) {
+            QVector<quint32> common;
+            std::set_intersection(candidates.cbegin(), candidates.cend(), lists[i]->cbegin(), lists[i]->cend(),
+                                  std::back_inserter(common));
+            candidates.swap(common);
+        }
+    }
+
+    // 二元组都命中不代表连续出现，用子串校验
+    for (quint32 id : std::as_const(candidates)) {
+        const TextEntry &entry = *texts.constFind(id);
+        if (!entry.normalized.contains(needle)) continue;
+        for (quint64 sequence : entry.occurrences) {
+            const Occurrence &occurrence = occurrences[sequence - firstSequence];
+            ScreenHistoryHit hit;
+            hit.text = entry.text;
+            hit.firstSeen = occurrence.firstSeen;
+            hit.lastSeen = occurrence.lastSeen;
+            hit.screen = occurrence.screen;
+            hit.rect = occurrence.rect;
+            hits.append(hit);
+        }
+    }
+
+    std::sort(hits.begin(), hits.end(), [](const ScreenHistoryHit &a, const ScreenHistoryHit &b) {
+        return a.firstSeen > b.firstSeen;
+    });
+    if (hits.size() > limit) hits.resize(limit);
+    return hits;
+}
+
+void ScreenHistoryIndex::clear()
+{
+    QWriteLocker locker(&lock);
+    texts.clear();
+    textIds.clear();
+    postings.clear();
+    occurrences.clear();
+    open.clear();
+    currentLines.clear();
+    firstSequence = 0;
+    used = 0;
+}
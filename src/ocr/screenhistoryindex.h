@@ -0,0 +1,111 @@
+#ifndef SCREENHISTORYINDEX_H
+#define SCREENHISTORYINDEX_H
+
+#include <QtCore/qglobal.h>
+
+#ifndef OCR_EXPORT
+#ifdef OCR_LIBRARY
+#define OCR_EXPORT Q_DECL_EXPORT
+#else
+#define OCR_EXPORT Q_DECL_IMPORT
+#endif
+#endif
+
+#include <QObject>
+#include <QHash>
+#include <QRect>
+#include <QReadWriteLock>
+#include <QSet>
+#include <QString>
+#include <QVector>
+#include <deque>
+#include "ocrtypes.h"
+
+class OCRModule;
+
+// 一次"在哪里、什么时候看到过"的查询结果
+struct ScreenHistoryHit {
+    QString text;
+    qint64 firstSeen = 0; // 出现时间，毫秒时间戳
+    qint64 lastSeen = -1; // 消失时间，仍在屏幕上时为-1
+    int screen = -1;      // 屏幕序号，来自纯文字输出时为-1
+    QRect rect;           // 屏幕像素坐标，来自纯文字输出时为空
+};
+
+// 屏幕文字历史索引
+// 相同的文字只存一份，倒排索引以字符二元组为词项（中日韩文字无需分词，拉丁文字不区分大小写），
+// 每次出现单独记录时间和位置。查询时先求各二元组倒排表的交集，再对候选文字做子串校验。
+// 估算内存超过预算时从最早的出现记录开始淘汰，文字不再被任何记录引用时从索引中删除。
+// 内部加读写锁，查询可以在任意线程进行。
+class OCR_EXPORT ScreenHistoryIndex : public QObject
+{
+    Q_OBJECT
+public:
+    // 默认预算32MB
+    explicit ScreenHistoryIndex(qint64 maxBytes = 32 * 1024 * 1024, QObject *parent = nullptr);
+
+    // 连接OCRModule的输出：textRecognized在任何扫描模式下都有；文字区域检测模式下另有带位置的
+    // blocksChanged，收到后改用它记录（同一帧的文字不重复记录），textRecognized不再使用
+    void attach(OCRModule *module);
+
+    void setMaxBytes(qint64 maxBytes);
+    qint64 maxBytes() const;
+    qint64 usedBytes() const;
+
+    int textCount() const;
+    int occurrenceCount() const;
+    qint64 oldestTimestamp() const;
+
+    // 包含query的所有出现记录，按出现时间从新到旧，最多limit条
+    QVector<ScreenHistoryHit> search(const QString &query, int limit = 50) const;
+
+    void clear();
+
+public slots:
+    // 逐区域输出：新增和变化的区域记为新的出现，消失的区域记录消失时间
+    void onBlocksChanged(const OCRTextDelta &delta);
+    // 纯文字输出：按行与上一次的文字比较，新出现的行记为新的出现
+    void onTextRecognized(const QString &text);
+
+    // timestamp为负时使用当前时间
+    void addBlock(quint64 key, const QString &text, int screen, const QRect &rect, qint64 timestamp = -1);
+    void removeBlock(quint64 key, qint64 timestamp = -1);
+
+private:
+    struct TextEntry {
+        QString text;
+        QString normalized;
+        std::deque<quint64> occurrences; // 出现记录的序号，从旧到新
+        qint64 bytes = 0;
+    };
+
+    struct Occurrence {
+        quint32 textId;
+        int screen;
+        QRect rect;
+        qint64 firstSeen;
+        qint64 lastSeen;
+        quint64 key;
+    };
+
+    quint32 internText(const QString &text);
+    void releaseText(quint32 id);
+    void evict();
+    void addBlockLocked(quint64 key, const QString &text, int screen, const QRect &rect, qint64 timestamp);
+    void removeBlockLocked(quint64 key, qint64 timestamp);
+
+    mutable QReadWriteLock lock;
+    QHash<quint32, TextEntry> texts;
+    QHash<QString, quint32> textIds;
+    QHash<quint32, QVector<quint32>> postings; // 二元组 -> 文字编号，升序
+    std::deque<Occurrence> occurrences;        // 按时间从旧到新
+    quint64 firstSequence;                     // occurrences.front()的序号
+    QHash<quint64, quint64> open;              // 仍在屏幕上的区域 -> 出现记录的序号
+    QSet<QString> currentLines;                // 纯文字输出中当前的行
+    bool positional;                           // 已收到带位置的区域输出
+    quint32 nextTextId;
+    qint64 budget;
+    qint64 used;
+};
+
+#endif // SCREENHISTORYINDEX_H
@@ -1,16 +1,15 @@
 #include "screenscanlib.h"
+#include "scanpipeline.h"
 #include <QApplication>
 #include <QScreen>
 #include <QPixmap>
-#include <QPainter>
-#include <QBuffer>
 #include <QDebug>
-#include <QProcess>
-#include <QTemporaryFile>
-#include <QDir>
 
 ScreenScanLib::ScreenScanLib(QObject *parent) : QObject(parent), scanning(false) {
     timer = new QTimer(this);
+    pipeline = new ScanPipeline(this);
+    connect(pipeline, &ScanPipeline::textRecognized, this, &ScreenScanLib::textRecognized);
+    connect(pipeline, &ScanPipeline::resultRecognized, this, &ScreenScanLib::resultRecognized);
     connect(timer, &QTimer::timeout, this, &ScreenScanLib::onTimeout);
 }
 
@@ -21,6 +20,8 @@ ScreenScanLib::~ScreenScanLib() {
 void ScreenScanLib::startScanning() {
     if (!scanning) {
         scanning = true;
+        // 预处理和识别在流水线工作线程中进行，定时器只负责截图
+        pipeline->start();
         timer->start(1000 / 30); // 每秒30次
     }
 }
@@ -29,6 +30,7 @@ void ScreenScanLib::stopScanning() {
     if (scanning) {
         scanning = false;
         timer->stop();
+        pipeline->stop();
     }
 }
 
@@ -39,45 +41,6 @@ void ScreenScanLib::onTimeout() {
     QScreen *screen = QGuiApplication::primaryScreen();
     if (!screen) return;
 
-    // 截取全屏
-    QPixmap pixmap = screen->grabWindow(0);
-
-    // 保存为临时文件
-    QTemporaryFile tempFile(QDir::tempPath() + "/screen_XXXXXX.png");
-    if (!tempFile.open()) {
-        qDebug() << "Failed to create temp file";
-        return;
-    }
-
-    if (!pixmap.save(&tempFile, "PNG")) {
-        qDebug() << "Failed to save screenshot";
-        return;
-    }
-
-    QString tempFileName = tempFile.fileName();
-    tempFile.close();
-
-    // 使用QProcess调用tesseract命令行
-    QProcess process;
-    QStringList arguments;
-    arguments << tempFileName << "stdout" << "-l" << "chi_sim+eng";
-
-    process.start("tesseract", arguments);
-    if (!process.waitForFinished(5000)) { // 5秒超时
-        qDebug() << "Tesseract process timeout";
-        return;
-    }
-
-    QByteArray output = process.readAllStandardOutput();
-    QString recognizedText = QString::fromUtf8(output).trimmed();
-
-    // 清理临时文件
-    tempFile.remove();
-
-    if (!recognizedText.isEmpty()) {
-        emit textRecognized(recognizedText);
-    } else {
-        // 如果没有识别到文字，发送模拟文本
-        emit textRecognized("屏幕内容识别模拟");
-    }
+    // 截取全屏交给流水线，下游忙时旧帧会被丢弃
+    pipeline->submitFrame(screen->grabWindow(0).toImage());
 }
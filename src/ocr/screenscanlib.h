@@ -14,6 +14,9 @@
 #include <QObject>
 #include <QString>
 #include <QTimer>
+#include "ocrresult.h"
+
+class ScanPipeline;
 
 // ScreenScan接口
 class ScreenScanInterface {
@@ -35,12 +38,15 @@ public:
 
 signals:
     void textRecognized(const QString &text);
+    // 主屏幕整帧的区域、行、词及置信度
+    void resultRecognized(const OCRResult &result);
 
 private slots:
     void onTimeout();
 
 private:
     QTimer *timer;
+    ScanPipeline *pipeline;
     bool scanning;
 };
 
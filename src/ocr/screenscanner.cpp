@@ -0,0 +1,309 @@
+#include "screenscanner.h"
+#include "scanpipeline.h"
+#include "scanscheduler.h"
+#include "capturesource.h"
+#include "framerecording.h"
+#include <QScreen>
+#include <QDebug>
+
+ScreenScanner::ScreenScanner(QScreen *screen, int index, QObject *parent)
+    : QObject(parent), target(screen), screenIndex(index), scheduler(new ScanScheduler()),
+      recorder(new FrameRecorder()), paused(false), scanning(false)
+{
+    timer = new QTimer(this);
+    source = CaptureSource::create(screen, this);
+    connect(source, &CaptureSource::damaged, this, &ScreenScanner::onDamaged);
+    pipeline = new ScanPipeline(this);
+    connect(pipeline, &ScanPipeline::textRecognized, this, &ScreenScanner::onTextRecognized);
+    connect(pipeline, &ScanPipeline::blocksRecognized, this, &ScreenScanner::onBlocksRecognized);
+    connect(pipeline, &ScanPipeline::blocksChanged, this, &ScreenScanner::onBlocksChanged);
+    connect(pipeline, &ScanPipeline::resultRecognized, this, &ScreenScanner::onResultRecognized);
+    connect(pipeline, &ScanPipeline::frameProcessed, this, &ScreenScanner::onFrameProcessed);
+    connect(pipeline, &ScanPipeline::recognitionPausedChanged, this, &ScreenScanner::onRecognitionPausedChanged);
+    connect(timer, &QTimer::timeout, this, &ScreenScanner::onTimeout);
+}
+
+ScreenScanner::~ScreenScanner()
+{
+    stop();
+    delete recorder;
+    delete scheduler;
+}
+
+void ScreenScanner::start()
+{
+    if (scanning || !target) return;
+
+    scanning = true;
+    updatePipeline();
+    scheduler->reset();
+    requestFullCapture();
+    timer->start(scheduler->interval()); // 从最高帧率开始，之后按负载自适应
+    emit scanRateChanged(screenIndex, scheduler->currentFps());
+}
+
+void ScreenScanner::stop()
+{
+    if (!scanning) return;
+
+    scanning = false;
+    timer->stop();
+    pipeline->stop();
+    lastBlocks.clear();
+    clearPaused();
+    emit scanRateChanged(screenIndex, 0.0);
+}
+
+bool ScreenScanner::isRunning() const
+{
+    return scanning;
+}
+
+QScreen *ScreenScanner::screen() const
+{
+    return target;
+}
+
+int ScreenScanner::index() const
+{
+    return screenIndex;
+}
+
+void ScreenScanner::setIndex(int index)
+{
+    screenIndex = index;
+}
+
+void ScreenScanner::setCaptureRegion(const QRect &rect)
+{
+    region = rect;
+    if (scanning) {
+        updatePipeline();
+        requestFullCapture();
+    }
+}
+
+void ScreenScanner::requestFullCapture()
+{
+    if (!target) return;
+    pendingDamage = QRect(QPoint(0, 0), target->geometry().size());
+    if (scanning && !timer->isActive()) {
+        timer->start(scheduler->interval());
+    }
+}
+
+void ScreenScanner::setRecognizerPool(RegionRecognizer *pool)
+{
+    pipeline->setRecognizerPool(pool);
+}
+
+bool ScreenScanner::isRecognitionPaused() const
+{
+    return paused;
+}
+
+void ScreenScanner::clearPaused()
+{
+    if (!paused) return;
+    paused = false;
+    emit recognitionPausedChanged(screenIndex, false);
+}
+
+QString ScreenScanner::captureBackend() const
+{
+    return source->name();
+}
+
+bool ScreenScanner::startRecording(const QString &path)
+{
+    if (!recorder->open(path)) return false;
+    recordClock.start();
+    return true;
+}
+
+void ScreenScanner::stopRecording()
+{
+    recorder->close();
+}
+
+bool ScreenScanner::isRecording() const
+{
+    return recorder->isOpen();
+}
+
+void ScreenScanner::updatePipeline()
+{
+    const bool covered = coversRegion();
+    if (covered && !pipeline->isRunning()) {
+        pipeline->start();
+    } else if (!covered && pipeline->isRunning()) {
+        // 停止后尚未处理的排队信号会被丢弃，见各槽函数中的isRunning()检查
+        pipeline->stop();
+        clearPaused();
+        if (!lastBlocks.isEmpty()) {
+            OCRTextDelta delta;
+            delta.screen = screenIndex;
+            for (const OCRTextBlock &block : lastBlocks) {
+                delta.removed.append(block.id);
+            }
+            lastBlocks.clear();
+            emit blocksChanged(delta);
+            emit blocksRecognized(screenIndex, lastBlocks);
+            OCRResult empty;
+            empty.setScreen(screenIndex);
+            emit resultRecognized(empty);
+        }
+        emit textRecognized(screenIndex, QString());
+    }
+}
+
+QRect ScreenScanner::captureRegion() const
+{
+    return region;
+}
+
+bool ScreenScanner::coversRegion() const
+{
+    return target && (region.isNull() || region.intersects(target->geometry()));
+}
+
+void ScreenScanner::setScanRateRange(double minFps, double maxFps)
+{
+    scheduler->setFpsRange(minFps, maxFps);
+    if (scanning) {
+        timer->setInterval(scheduler->interval());
+        emit scanRateChanged(screenIndex, scheduler->currentFps());
+    }
+}
+
+double ScreenScanner::currentScanRate() const
+{
+    return scanning ? scheduler->currentFps() : 0.0;
+}
+
+quint64 ScreenScanner::cacheHits() const
+{
+    return pipeline->cacheHits();
+}
+
+quint64 ScreenScanner::cacheMisses() const
+{
+    return pipeline->cacheMisses();
+}
+
+void ScreenScanner::setRefineConfidence(int threshold)
+{
+    pipeline->setRefineConfidence(threshold);
+}
+
+quint64 ScreenScanner::refinedPixels() const
+{
+    return pipeline->refinedPixels();
+}
+
+quint64 ScreenScanner::scannedPixels() const
+{
+    return pipeline->scannedPixels();
+}
+
+void ScreenScanner::onTimeout()
+{
+    if (!scanning || !target || !pipeline->isRunning()) return;
+
+    // 截取区域换算为相对该屏幕的逻辑坐标
+    const QRect geometry = target->geometry();
+    QRect local(QPoint(0, 0), geometry.size());
+    if (!region.isNull()) {
+        local = region.intersected(geometry).translated(-geometry.topLeft());
+        if (local.isEmpty()) return; // 区域不在该屏幕上
+    }
+
+    // 事件驱动的后端：区域内没有变化时停止定时器，等下一次damaged()再启动
+    if (source->isEventDriven()) {
+        const bool changed = pendingDamage.intersects(local);
+        pendingDamage = QRegion();
+        if (!changed) {
+            timer->stop();
+            return;
+        }
+    }
+
+    // 每个屏幕的缩放比例可能不同，且运行中可能被修改，每帧重新读取
+    const qreal dpr = target->devicePixelRatio();
+    pipeline->setDownscaleFactor(int(dpr));
+
+    // 截取该屏幕交给流水线，下游忙时旧帧会被丢弃
+    QImage frame = source->grab(local);
+    if (frame.isNull()) return;
+    if (recorder->isOpen() && !recorder->append(frame, recordClock.elapsed())) {
+        qDebug() << "Frame recording stopped:" << recorder->errorString();
+        recorder->close();
+    }
+    pipeline->submitFrame(frame, QPoint(qRound(local.x() * dpr), qRound(local.y() * dpr)));
+}
+
+void ScreenScanner::onDamaged(const QRect &rect)
+{
+    pendingDamage += rect;
+    // 定时器间隔由调度器决定，连续的变化在间隔内合并为一次截图
+    if (scanning && pipeline->isRunning() && !timer->isActive()) {
+        timer->start(scheduler->interval());
+    }
+}
+
+void ScreenScanner::onTextRecognized(const QString &text)
+{
+    if (!pipeline->isRunning()) return;
+    emit textRecognized(screenIndex, text);
+}
+
+void ScreenScanner::onBlocksRecognized(const QVector<OCRTextBlock> &blocks)
+{
+    if (!pipeline->isRunning()) return;
+    lastBlocks = blocks;
+    for (OCRTextBlock &block : lastBlocks) {
+        block.screen = screenIndex;
+    }
+    emit blocksRecognized(screenIndex, lastBlocks);
+}
+
+void ScreenScanner::onBlocksChanged(const OCRTextDelta &delta)
+{
+    if (!pipeline->isRunning()) return;
+    OCRTextDelta tagged = delta;
+    tagged.screen = screenIndex;
+    for (OCRTextBlock &block : tagged.added) {
+        block.screen = screenIndex;
+    }
+    for (OCRTextBlock &block : tagged.changed) {
+        block.screen = screenIndex;
+    }
+    emit blocksChanged(tagged);
+}
+
+void ScreenScanner::onResultRecognized(const OCRResult &result)
+{
+    if (!pipeline->isRunning()) return;
+    // 屏幕序号不属于共享数据，设置时不复制数组
+    OCRResult tagged = result;
+    tagged.setScreen(screenIndex);
+    emit resultRecognized(tagged);
+}
+
+void ScreenScanner::onFrameProcessed(qint64 processingMs, double changeRatio)
+{
+    if (!scanning) return;
+
+    int interval = scheduler->update(processingMs, changeRatio);
+    if (interval != timer->interval()) {
+        timer->setInterval(interval);
+        emit scanRateChanged(screenIndex, scheduler->currentFps());
+    }
+}
+
+void ScreenScanner::onRecognitionPausedChanged(bool pause)
+{
+    if (!pipeline->isRunning() || pause == paused) return;
+    paused = pause;
+    emit recognitionPausedChanged(screenIndex, paused);
+}
@@ -0,0 +1,124 @@
+#ifndef SCREENSCANNER_H
+#define SCREENSCANNER_H
+
+#include <QtCore/qglobal.h>
+
+#ifndef OCR_EXPORT
+#ifdef OCR_LIBRARY
+#define OCR_EXPORT Q_DECL_EXPORT
+#else
+#define OCR_EXPORT Q_DECL_IMPORT
+#endif
+#endif
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QRect>
+#include <QRegion>
+#include <QString>
+#include <QTimer>
+#include "ocrtypes.h"
+
+class QScreen;
+class ScanPipeline;
+class ScanScheduler;
+class CaptureSource;
+class FrameRecorder;
+class RegionRecognizer;
+
+// 单个屏幕的扫描器
+// 每个屏幕有独立的采集定时器、自适应调度和识别流水线（各自的工作线程），
+// 多个屏幕之间互不等待。文字识别交给所有屏幕共用的识别器池，池的大小按核心数而不是屏幕数确定，
+// 各屏幕的区域在池中并行识别；未设置识别器池时流水线使用自己的Tesseract实例。
+// 截图后端支持变化通知时（X11 XDamage），只在扫描区域内有变化后才截图，屏幕静止时定时器停止。
+class OCR_EXPORT ScreenScanner : public QObject
+{
+    Q_OBJECT
+public:
+    ScreenScanner(QScreen *screen, int index, QObject *parent = nullptr);
+    ~ScreenScanner();
+
+    void start();
+    void stop();
+    bool isRunning() const;
+
+    QScreen *screen() const;
+    int index() const;
+    void setIndex(int index);
+
+    // 只扫描该区域（全局逻辑坐标），空矩形表示整个屏幕；运行中可随时修改
+    void setCaptureRegion(const QRect &region);
+    QRect captureRegion() const;
+    // 区域与该屏幕是否有交集
+    bool coversRegion() const;
+
+    void setScanRateRange(double minFps, double maxFps);
+    double currentScanRate() const;
+
+    quint64 cacheHits() const;
+    quint64 cacheMisses() const;
+
+    // 降采样识别置信度低于threshold的区域用原始分辨率重新识别，0表示关闭
+    void setRefineConfidence(int threshold);
+    quint64 refinedPixels() const;
+    quint64 scannedPixels() const;
+
+    // 多个屏幕共用的识别器，需在start()之前设置
+    void setRecognizerPool(RegionRecognizer *pool);
+
+    // 画面被判为视频、游戏或照片而暂停识别
+    bool isRecognitionPaused() const;
+
+    // 当前使用的截图后端名称
+    QString captureBackend() const;
+
+    // 把送入流水线的每一帧录制到文件，供FrameReplaySource回放
+    bool startRecording(const QString &path);
+    void stopRecording();
+    bool isRecording() const;
+
+signals:
+    void textRecognized(int screen, const QString &text);
+    // 区域坐标为该屏幕截图的设备像素坐标
+    void blocksRecognized(int screen, const QVector<OCRTextBlock> &blocks);
+    void blocksChanged(const OCRTextDelta &delta);
+    // 整帧的区域、行和词，result.screen()为屏幕序号
+    void resultRecognized(const OCRResult &result);
+    void scanRateChanged(int screen, double fps);
+    void recognitionPausedChanged(int screen, bool paused);
+
+private slots:
+    void onTimeout();
+    void onDamaged(const QRect &rect);
+    void onTextRecognized(const QString &text);
+    void onBlocksRecognized(const QVector<OCRTextBlock> &blocks);
+    void onBlocksChanged(const OCRTextDelta &delta);
+    void onResultRecognized(const OCRResult &result);
+    void onFrameProcessed(qint64 processingMs, double changeRatio);
+    void onRecognitionPausedChanged(bool paused);
+
+private:
+    // 扫描区域离开该屏幕时停止流水线，并把已输出的区域标记为消失
+    void updatePipeline();
+    // 要求下一次定时器触发时无条件截图
+    void requestFullCapture();
+    // 流水线停止后不再处于暂停状态
+    void clearPaused();
+
+    QPointer<QScreen> target;
+    int screenIndex;
+    QRect region;
+    QTimer *timer;
+    CaptureSource *source;
+    QRegion pendingDamage; // 上次截图后发生变化的区域（屏幕内逻辑坐标）
+    ScanPipeline *pipeline;
+    ScanScheduler *scheduler;
+    FrameRecorder *recorder;
+    QElapsedTimer recordClock;
+    QVector<OCRTextBlock> lastBlocks; // 最近一次输出的文字区域
+    bool paused;
+    bool scanning;
+};
+
+#endif // SCREENSCANNER_H
@@ -0,0 +1,173 @@
+#include "scriptdetector.h"
+#include <QVector>
+
+static const int MIN_LINE_HEIGHT = 8;        // 更矮的行笔画细节不足，交给组合模型
+static const double MARK_MAX_HEIGHT = 0.35;  // 低于行高此比例的窄字块视为标点
+static const double HAN_MIN_HEIGHT = 0.65;   // 汉字字块至少占行高的比例
+static const double HAN_MIN_ASPECT = 0.6;    // 汉字字块宽高比范围（相对行高）
+static const double HAN_MAX_ASPECT = 1.5;
+static const double HAN_MIN_CROSSINGS = 2.2; // 每列平均穿过的笔画数
+static const double WIDE_MIN_CROSSINGS = 2.6; // 几个汉字粘连成的宽字块要求更多笔画，拉丁单词约1.8
+static const int LATIN_PER_HAN = 5;          // 汉字行中允许夹杂少量拉丁字块（中文模型也能识别字母数字）
+static const double MIN_TALLEST_BLOB = 0.8;  // 没有字块接近行高时多半是几行粘在一起，不做判断
+
+// 区域内的大津阈值
+static int regionThreshold(const QImage &gray, const QRect &rect)
+{
+    int histogram[256] = {0};
+    for (int y = rect.top(); y <= rect.bottom(); ++y) {
+        const uchar *row = gray.constScanLine(y);
+        for (int x = rect.left(); x <= rect.right(); ++x) {
+            ++histogram[row[x]];
+        }
+    }
+    const qint64 total = qint64(rect.width()) * rect.height();
+    qint64 sum = 0;
+    for (int i = 0; i < 256; ++i) {
+        sum += qint64(i) * histogram[i];
+    }
+    qint64 sumBackground = 0;
+    qint64 weightBackground = 0;
+    double best = -1.0;
+    int level = 128;
+    for (int t = 0; t < 256; ++t) {
+        weightBackground += histogram[t];
+        if (weightBackground == 0) continue;
+        const qint64 weightForeground = total - weightBackground;
+        if (weightForeground == 0) break;
+        sumBackground += qint64(t) * histogram[t];
+        const double meanBackground = double(sumBackground) / weightBackground;
+        const double meanForeground = double(sum - sumBackground) / weightForeground;
+        const double between = double(weightBackground) * weightForeground * (meanBackground - meanForeground) *
+                               (meanBackground - meanForeground);
+        if (between > best) {
+            best = between;
+            level = t + 1;
+        }
+    }
+    return level;
+}
+
+ScriptDetector::Script ScriptDetector::detect(const QImage &gray, const QRect &region)
+{
+    const QRect rect = region.intersected(gray.rect());
+    if (gray.format() != QImage::Format_Grayscale8 || rect.height() < MIN_LINE_HEIGHT || rect.width() < MIN_LINE_HEIGHT) {
+        return Unknown;
+    }
+
+    // 二值化，像素少的一侧是墨迹
+    const int level = regionThreshold(gray, rect);
+    const int width = rect.width();
+    const int height = rect.height();
+    QVector<quint8> ink(width * height);
+    int dark = 0;
+    for (int y = 0; y < height; ++y) {
+        const uchar *row = gray.constScanLine(rect.top() + y) + rect.left();
+        for (int x = 0; x < width; ++x) {
+            const bool below = row[x] < level;
+            ink[y * width + x] = below;
+            dark += below;
+        }
+    }
+    if (dark * 2 > width * height) {
+        for (quint8 &v : ink) {
+            v = !v;
+        }
+    }
+
+    auto rowHasInk = [&](int row) {
+        const quint8 *p = ink.constData() + row * width;
+        for (int x = 0; x < width; ++x) {
+            if (p[x]) return true;
+        }
+        return false;
+    };
+    // 一列在[top, bottom)内穿过的墨迹段数和墨迹的上下端
+    auto columnInk = [&](int column, int top, int bottom, int *runs, int *first, int *last) {
+        bool previous = false;
+        for (int row = top; row < bottom; ++row) {
+            const bool v = ink.at(row * width + column);
+            if (v && !previous) {
+                ++*runs;
+                if (*first < 0) *first = row;
+            }
+            if (v) *last = row;
+            previous = v;
+        }
+    };
+
+    int hanLines = 0;
+    int latinLines = 0;
+    int mixedLines = 0;
+    int y = 0;
+    while (y < height) {
+        // 行投影：连续的有墨迹行为一个文字行
+        while (y < height && !rowHasInk(y)) ++y;
+        const int top = y;
+        while (y < height && rowHasInk(y)) ++y;
+        const int lineHeight = y - top;
+        if (lineHeight < MIN_LINE_HEIGHT) continue;
+
+        // 列投影：连续的有墨迹列为一个字块
+        int han = 0;
+        int latin = 0;
+        double tallest = 0.0;
+        int x = 0;
+        while (x < width) {
+            int runs = 0;
+            int first = -1;
+            int last = -1;
+            columnInk(x, top, y, &runs, &first, &last);
+            if (runs == 0) {
+                ++x;
+                continue;
+            }
+            const int left = x;
+            int blobRuns = runs;
+            int blobTop = first;
+            int blobBottom = last;
+            int columns = 1;
+            for (++x; x < width; ++x) {
+                int r = 0;
+                int f = -1;
+                int l = -1;
+                columnInk(x, top, y, &r, &f, &l);
+                if (r == 0) break;
+                blobRuns += r;
+                blobTop = qMin(blobTop, f);
+                blobBottom = qMax(blobBottom, l);
+                ++columns;
+            }
+
+            const double blobWidth = double(x - left) / lineHeight;
+            const double blobHeight = double(blobBottom - blobTop + 1) / lineHeight;
+            const double crossings = double(blobRuns) / columns;
+            tallest = qMax(tallest, blobHeight);
+            if (blobHeight < MARK_MAX_HEIGHT && blobWidth < 0.5) continue;
+            const bool tall = blobHeight >= HAN_MIN_HEIGHT;
+            if (tall && blobWidth >= HAN_MIN_ASPECT && blobWidth <= HAN_MAX_ASPECT && crossings >= HAN_MIN_CROSSINGS) {
+                ++han;
+            } else if (tall && blobWidth > HAN_MAX_ASPECT && crossings >= WIDE_MIN_CROSSINGS) {
+                han += qRound(blobWidth);
+            } else {
+                ++latin;
+            }
+        }
+
+        if (han + latin == 0) continue;
+        if (tallest < MIN_TALLEST_BLOB) {
+            ++mixedLines;
+        } else if (han == 0) {
+            ++latinLines;
+        } else if (latin * LATIN_PER_HAN <= han) {
+            ++hanLines;
+        } else {
+            ++mixedLines;
+        }
+    }
+
+    if (mixedLines > 0 || (hanLines > 0 && latinLines > 0)) return Mixed;
+    if (hanLines > 0) return Han;
+    if (latinLines > 0) return Latin;
+    return Unknown;
+}
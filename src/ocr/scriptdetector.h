@@ -0,0 +1,36 @@
+#ifndef SCRIPTDETECTOR_H
+#define SCRIPTDETECTOR_H
+
+#include <QtCore/qglobal.h>
+
+#ifndef OCR_EXPORT
+#ifdef OCR_LIBRARY
+#define OCR_EXPORT Q_DECL_EXPORT
+#else
+#define OCR_EXPORT Q_DECL_IMPORT
+#endif
+#endif
+
+#include <QImage>
+#include <QRect>
+
+// 文字种类识别，用于为每个区域选择最便宜的够用的模型
+// 只看字形的几何特征，不做识别：区域按大津阈值二值化后用行投影切出文字行，
+// 再用列投影切出字块。汉字字块接近方形、占满行高、每列穿过的笔画多；
+// 拉丁字母窄、高度参差（x高度与上下伸部分），每列只穿过一两笔。标点等小字块不参与判断。
+// 每行判为汉字、拉丁或混合，全部行一致时才返回单一种类，否则返回Mixed，由组合模型识别。
+class OCR_EXPORT ScriptDetector
+{
+public:
+    enum Script {
+        Unknown, // 行太矮或没有字块，无法判断
+        Latin,
+        Han,
+        Mixed
+    };
+
+    // gray为Grayscale8，深色字浅色底和浅色字深色底都可以
+    static Script detect(const QImage &gray, const QRect &region);
+};
+
+#endif // SCRIPTDETECTOR_H
@@ -0,0 +1,159 @@
+#include "scrolldetector.h"
+#include "dirtyregiontracker.h"
+#include <QHash>
+
+static const int MIN_MATCHED_LINES = 8;       // 投票数太少时偶然匹配的可能性很大
+static const quint64 FNV_OFFSET = 0xCBF29CE484222325ULL;
+static const quint64 FNV_PRIME = 0x100000001B3ULL;
+
+static void rowHashes(const QImage &image, const QRect &region, QVector<quint64> &hashes, QVector<bool> &informative)
+{
+    hashes.resize(region.height());
+    informative.resize(region.height());
+    for (int i = 0; i < region.height(); ++i) {
+        const uchar *line = image.constScanLine(region.top() + i) + region.left();
+        hashes[i] = DirtyRegionTracker::hashTile(line, image.bytesPerLine(), region.width(), 1);
+        bool varied = false;
+        for (int x = 1; x < region.width() && !varied; ++x) {
+            varied = line[x] != line[0];
+        }
+        informative[i] = varied;
+    }
+}
+
+static void columnHashes(const QImage &image, const QRect &region, QVector<quint64> &hashes, QVector<bool> &informative)
+{
+    const int width = region.width();
+    hashes.fill(FNV_OFFSET, width);
+    QVector<uchar> low(width, 255);
+    QVector<uchar> high(width, 0);
+    // 逐行累加，内层循环连续访问内存
+    for (int y = region.top(); y <= region.bottom(); ++y) {
+        const uchar *line = image.constScanLine(y) + region.left();
+        for (int x = 0; x < width; ++x) {
+            hashes[x] = (hashes[x] ^ line[x]) * FNV_PRIME;
+            low[x] = qMin(low[x], line[x]);
+            high[x] = qMax(high[x], line[x]);
+        }
+    }
+    informative.resize(width);
+    for (int x = 0; x < width; ++x) {
+        informative[x] = low[x] != high[x];
+    }
+}
+
+ScrollDetector::ScrollDetector()
+    : minRatio(0.5)
+{
+}
+
+void ScrollDetector::setMinMatchRatio(double ratio)
+{
+    minRatio = qBound(0.0, ratio, 1.0);
+}
+
+double ScrollDetector::minMatchRatio() const
+{
+    return minRatio;
+}
+
+bool ScrollDetector::estimate(const QImage &previous, const QImage &current, const QRect &region, QPoint &offset) const
+{
+    if (previous.isNull() || current.isNull() || previous.size() != current.size()) return false;
+    if (previous.format() != QImage::Format_Grayscale8 || current.format() != QImage::Format_Grayscale8) return false;
+    const QRect r = region.intersected(current.rect());
+    if (r.width() < 2 || r.height() < 2) return false;
+
+    QVector<quint64> previousHashes;
+    QVector<quint64> currentHashes;
+    QVector<bool> previousInformative;
+    QVector<bool> currentInformative;
+    int shift = 0;
+
+    rowHashes(previous, r, previousHashes, previousInformative);
+    rowHashes(current, r, currentHashes, currentInformative);
+    if (estimateShift(previousHashes, previousInformative, currentHashes, currentInformative, shift)) {
+        offset = QPoint(0, shift);
+        return true;
+    }
+
+    columnHashes(previous, r, previousHashes, previousInformative);
+    columnHashes(current, r, currentHashes, currentInformative);
+    if (estimateShift(previousHashes, previousInformative, currentHashes, currentInformative, shift)) {
+        offset = QPoint(shift, 0);
+        return true;
+    }
+    return false;
+}
+
+bool ScrollDetector::estimateShift(const QVector<quint64> &previous, const QVector<bool> &previousInformative,
+                                   const QVector<quint64> &current, const QVector<bool> &currentInformative, int &shift) const
+{
+    const int n = current.size();
+
+    // 上一帧的哈希 -> 行号；重复出现的行无法确定对应关系，记为-1
+    QHash<quint64, int> lines;
+    lines.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        if (!previousInformative[i]) continue;
+        auto found = lines.find(previous[i]);
+        if (found == lines.end()) {
+            lines.insert(previous[i], i);
+        } else {
+            found.value() = -1;
+        }
+    }
+    if (lines.isEmpty()) return false;
+
+    QHash<int, int> votes;
+    for (int i = 0; i < n; ++i) {
+        if (!currentInformative[i]) continue;
+        auto found = lines.constFind(current[i]);
+        if (found == lines.constEnd() || found.value() < 0) continue;
+        const int delta = i - found.value();
+        if (delta != 0) {
+            ++votes[delta];
+        }
+    }
+
+    int best = 0;
+    int bestVotes = 0;
+    for (auto it = votes.constBegin(); it != votes.constEnd(); ++it) {
+        if (it.value() > bestVotes) {
+            best = it.key();
+            bestVotes = it.value();
+        }
+    }
+    if (bestVotes < MIN_MATCHED_LINES) return false;
+
+    // 只有滚动后仍在区域内的行才可能匹配，比例按这些行计算
+    const int first = qMax(0, best);
+    const int last = qMin(n, n + best);
+    int candidates = 0;
+    for (int i = first; i < last; ++i) {
+        if (currentInformative[i]) ++candidates;
+    }
+    if (candidates == 0 || bestVotes < minRatio * candidates) return false;
+
+    shift = best;
+    return true;
+}
+
+QRect ScrollDetector::exposedRect(const QRect &region, const QPoint &offset)
+{
+    if (offset.y() > 0) {
+        return QRect(region.left(), region.top(), region.width(), qMin(offset.y(), region.height()));
+    }
+    if (offset.y() < 0) {
+        const int h = qMin(-offset.y(), region.height());
+        return QRect(region.left(), region.bottom() - h + 1, region.width(), h);
+    }
+    if (offset.x() > 0) {
+        return QRect(region.left(), region.top(), qMin(offset.x(), region.width()), region.height());
+    }
+    if (offset.x() < 0) {
+        const int w = qMin(-offset.x(), region.width());
+        return QRect(region.right() - w + 1, region.top(), w, region.height());
+    }
+    return QRect();
+}
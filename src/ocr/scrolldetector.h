@@ -0,0 +1,45 @@
+#ifndef SCROLLDETECTOR_H
+#define SCROLLDETECTOR_H
+
+#include <QtCore/qglobal.h>
+
+#ifndef OCR_EXPORT
+#ifdef OCR_LIBRARY
+#define OCR_EXPORT Q_DECL_EXPORT
+#else
+#define OCR_EXPORT Q_DECL_IMPORT
+#endif
+#endif
+
+#include <QImage>
+#include <QPoint>
+#include <QRect>
+#include <QVector>
+
+// 滚动检测
+// 对区域内的每一行（列）计算哈希，用上一帧的行哈希表给当前帧的每一行投票，
+// 得票最多的偏移即为滚动距离。纯色行（列）没有区分度，不参与投票。
+class OCR_EXPORT ScrollDetector
+{
+public:
+    ScrollDetector();
+
+    // 参与投票的行中至少有该比例落在同一偏移上才认为是滚动，默认0.5
+    void setMinMatchRatio(double ratio);
+    double minMatchRatio() const;
+
+    // 估计region内容从previous到current的位移，满足 current(x, y) == previous(x - dx, y - dy)。
+    // 先检测竖直滚动，没有再检测水平滚动；两幅图必须是尺寸相同的灰度图
+    bool estimate(const QImage &previous, const QImage &current, const QRect &region, QPoint &offset) const;
+
+    // 按offset滚动后region中新露出、上一帧没有的部分
+    static QRect exposedRect(const QRect &region, const QPoint &offset);
+
+private:
+    bool estimateShift(const QVector<quint64> &previous, const QVector<bool> &previousInformative,
+                       const QVector<quint64> &current, const QVector<bool> &currentInformative, int &shift) const;
+
+    double minRatio;
+};
+
+#endif // SCROLLDETECTOR_H
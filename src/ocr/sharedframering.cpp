@@ -0,0 +1,154 @@
+#include "sharedframering.h"
+#include <QDeadlineTimer>
+#include <QDebug>
+#include <cstring>
+
+static const char RING_MAGIC[8] = {'O', 'C', 'R', 'R', 'I', 'N', 'G', '1'};
+static const quint32 RING_VERSION = 1;
+static const qint64 HEADER_BYTES = 64; // 槽位按缓存行对齐
+static const qint64 SLOT_ALIGN = 64;
+
+struct RingHeader {
+    char magic[8];
+    quint32 version;
+    quint32 slotCount;
+    qint64 slotBytes;
+};
+
+SharedFrameRing::SharedFrameRing()
+    : count(0), bytesPerSlot(0)
+{
+}
+
+SharedFrameRing::~SharedFrameRing()
+{
+    detach();
+}
+
+bool SharedFrameRing::create(const QString &key, int numSlots, qint64 slotBytes)
+{
+    detach();
+    if (numSlots <= 0 || slotBytes <= 0) return false;
+
+    const qint64 aligned = (slotBytes + SLOT_ALIGN - 1) / SLOT_ALIGN * SLOT_ALIGN;
+    memory.setKey(key);
+    bool created = memory.create(HEADER_BYTES + aligned * numSlots);
+    if (!created && memory.error() == QSharedMemory::AlreadyExists) {
+        // 上次异常退出留下的段：附加再分离让系统回收后重试
+        if (memory.attach()) memory.detach();
+        created = memory.create(HEADER_BYTES + aligned * numSlots);
+    }
+    if (!created) {
+        qDebug() << "Failed to create shared frame ring" << key << memory.errorString();
+        return false;
+    }
+
+    RingHeader *header = static_cast<RingHeader *>(memory.data());
+    std::memcpy(header->magic, RING_MAGIC, sizeof(RING_MAGIC));
+    header->version = RING_VERSION;
+    header->slotCount = quint32(numSlots);
+    header->slotBytes = aligned;
+
+    count = numSlots;
+    bytesPerSlot = aligned;
+    QMutexLocker locker(&mutex);
+    freeSlots.clear();
+    for (int i = numSlots - 1; i >= 0; --i) {
+        freeSlots.append(i);
+    }
+    return true;
+}
+
+bool SharedFrameRing::attach(const QString &key)
+{
+    detach();
+    memory.setKey(key);
+    if (!memory.attach(QSharedMemory::ReadOnly)) {
+        qDebug() << "Failed to attach shared frame ring" << key << memory.errorString();
+        return false;
+    }
+    const RingHeader *header = static_cast<const RingHeader *>(memory.constData());
+    if (memory.size() < HEADER_BYTES || std::memcmp(header->magic, RING_MAGIC, sizeof(RING_MAGIC)) != 0 ||
+        header->version != RING_VERSION ||
+        memory.size() < HEADER_BYTES + header->slotBytes * qint64(header->slotCount)) {
+        qDebug() << "Shared frame ring" << key << "has an unexpected layout";
+        memory.detach();
+        return false;
+    }
+    count = int(header->slotCount);
+    bytesPerSlot = header->slotBytes;
+    return true;
+}
+
+void SharedFrameRing::detach()
+{
+    if (memory.isAttached()) memory.detach();
+    count = 0;
+    bytesPerSlot = 0;
+    QMutexLocker locker(&mutex);
+    freeSlots.clear();
+    slotFreed.wakeAll();
+}
+
+bool SharedFrameRing::isValid() const
+{
+    return memory.isAttached() && count > 0;
+}
+
+QString SharedFrameRing::key() const
+{
+    return memory.key();
+}
+
+int SharedFrameRing::slotCount() const
+{
+    return count;
+}
+
+qint64 SharedFrameRing::slotBytes() const
+{
+    return bytesPerSlot;
+}
+
+int SharedFrameRing::acquire(int timeoutMs)
+{
+    QDeadlineTimer deadline(timeoutMs);
+    QMutexLocker locker(&mutex);
+    while (freeSlots.isEmpty()) {
+        if (!isValid() || !slotFreed.wait(&mutex, deadline)) return -1;
+    }
+    return freeSlots.takeLast();
+}
+
+void SharedFrameRing::release(int slot)
+{
+    if (slot < 0 || slot >= count) return;
+    QMutexLocker locker(&mutex);
+    freeSlots.append(slot);
+    slotFreed.wakeOne();
+}
+
+bool SharedFrameRing::write(int slot, const QImage &gray)
+{
+    if (!isValid() || slot < 0 || slot >= count || gray.format() != QImage::Format_Grayscale8) return false;
+    const qint64 bytes = qint64(gray.bytesPerLine()) * gray.height();
+    if (bytes > bytesPerSlot) return false;
+    std::memcpy(slotData(slot), gray.constBits(), size_t(bytes));
+    return true;
+}
+
+QImage SharedFrameRing::frame(int slot, int width, int height, int bytesPerLine) const
+{
+    if (!isValid() || slot < 0 || slot >= count || width <= 0 || height <= 0 || bytesPerLine < width ||
+        qint64(bytesPerLine) * height > bytesPerSlot) {
+        return QImage();
+    }
+    // const构造：不复制像素，也不会写回共享内存
+    return QImage(static_cast<const uchar *>(slotData(slot)), width, height, bytesPerLine, QImage::Format_Grayscale8);
+}
+
+uchar *SharedFrameRing::slotData(int slot) const
+{
+    uchar *base = static_cast<uchar *>(const_cast<void *>(memory.constData()));
+    return base + HEADER_BYTES + bytesPerSlot * slot;
+}
@@ -0,0 +1,64 @@
+#ifndef SHAREDFRAMERING_H
+#define SHAREDFRAMERING_H
+
+#include <QtCore/qglobal.h>
+
+#ifndef OCR_EXPORT
+#ifdef OCR_LIBRARY
+#define OCR_EXPORT Q_DECL_EXPORT
+#else
+#define OCR_EXPORT Q_DECL_IMPORT
+#endif
+#endif
+
+#include <QImage>
+#include <QMutex>
+#include <QSharedMemory>
+#include <QString>
+#include <QVector>
+#include <QWaitCondition>
+
+// 共享内存帧环
+// 宿主进程创建，识别进程只读附加。固定数量的槽位，每个槽位放一帧灰度图，
+// 宿主只做一次memcpy写入，识别进程直接在共享内存上构造QImage，不经过PNG编码和临时文件。
+// 槽位的分配和归还只在宿主进程内进行：请求发出到回复收到（或识别进程退出）之前槽位不会被复用。
+class OCR_EXPORT SharedFrameRing
+{
+public:
+    SharedFrameRing();
+    ~SharedFrameRing();
+
+    // 宿主：创建numSlots个槽位，每个至少slotBytes字节
+    bool create(const QString &key, int numSlots, qint64 slotBytes);
+    // 识别进程：只读附加到已创建的帧环
+    bool attach(const QString &key);
+    void detach();
+
+    bool isValid() const;
+    QString key() const;
+    int slotCount() const;
+    qint64 slotBytes() const;
+
+    // 宿主：取一个空闲槽位，超时返回-1
+    int acquire(int timeoutMs);
+    void release(int slot);
+    // 宿主：把灰度图写入槽位，放不下时返回false
+    bool write(int slot, const QImage &gray);
+
+    // 识别进程：槽位中的帧，直接引用共享内存，在槽位归还之前有效
+    QImage frame(int slot, int width, int height, int bytesPerLine) const;
+
+private:
+    Q_DISABLE_COPY(SharedFrameRing)
+
+    uchar *slotData(int slot) const;
+
+    QSharedMemory memory;
+    int count;
+    qint64 bytesPerSlot;
+    QMutex mutex;
+    QWaitCondition slotFreed;
+    QVector<int> freeSlots;
+};
+
+#endif // SHAREDFRAMERING_H
@@ -0,0 +1,409 @@
+#include "tesseractengine.h"
+#include "scriptdetector.h"
+#include <QElapsedTimer>
+#include <QLibrary>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QProcess>
+#include <QTemporaryFile>
+#include <QDebug>
+
+// Tesseract C API (capi.h) 函数指针
+typedef void* TessBaseAPI;
+
+typedef TessBaseAPI* (*tess_base_api_create_func)();
+typedef void (*tess_base_api_delete_func)(TessBaseAPI *handle);
+typedef int (*tess_base_api_init3_func)(TessBaseAPI *handle, const char *datapath, const char *language);
+typedef void (*tess_base_api_set_page_seg_mode_func)(TessBaseAPI *handle, int mode);
+typedef void (*tess_base_api_set_image_func)(TessBaseAPI *handle, const unsigned char *imagedata, int width, int height,
+                                             int bytes_per_pixel, int bytes_per_line);
+typedef void (*tess_base_api_set_source_resolution_func)(TessBaseAPI *handle, int ppi);
+typedef void (*tess_base_api_set_rectangle_func)(TessBaseAPI *handle, int left, int top, int width, int height);
+typedef char* (*tess_base_api_get_utf8_text_func)(TessBaseAPI *handle);
+typedef int (*tess_base_api_mean_text_conf_func)(TessBaseAPI *handle);
+typedef void (*tess_base_api_clear_func)(TessBaseAPI *handle);
+typedef void (*tess_delete_text_func)(const char *text);
+
+// 逐词结果迭代器，可选；缺少时只输出整段文字
+typedef void* TessResultIterator;
+typedef int (*tess_base_api_recognize_func)(TessBaseAPI *handle, void *monitor);
+typedef TessResultIterator* (*tess_base_api_get_iterator_func)(TessBaseAPI *handle);
+typedef void (*tess_result_iterator_delete_func)(TessResultIterator *handle);
+typedef int (*tess_result_iterator_next_func)(TessResultIterator *handle, int level);
+typedef char* (*tess_result_iterator_get_utf8_text_func)(const TessResultIterator *handle, int level);
+typedef float (*tess_result_iterator_confidence_func)(const TessResultIterator *handle, int level);
+typedef void* (*tess_result_iterator_get_page_iterator_func)(TessResultIterator *handle);
+typedef int (*tess_page_iterator_bounding_box_func)(const void *handle, int level, int *left, int *top, int *right, int *bottom);
+typedef int (*tess_page_iterator_is_at_beginning_of_func)(const void *handle, int level);
+
+static QMutex tessLibMutex;
+static QLibrary *tessLib = nullptr;
+static bool tessLibResolved = false;
+static tess_base_api_create_func tess_base_api_create_ptr = nullptr;
+static tess_base_api_delete_func tess_base_api_delete_ptr = nullptr;
+static tess_base_api_init3_func tess_base_api_init3_ptr = nullptr;
+static tess_base_api_set_page_seg_mode_func tess_base_api_set_page_seg_mode_ptr = nullptr;
+static tess_base_api_set_image_func tess_base_api_set_image_ptr = nullptr;
+static tess_base_api_set_source_resolution_func tess_base_api_set_source_resolution_ptr = nullptr;
+static tess_base_api_set_rectangle_func tess_base_api_set_rectangle_ptr = nullptr;
+static tess_base_api_get_utf8_text_func tess_base_api_get_utf8_text_ptr = nullptr;
+static tess_base_api_mean_text_conf_func tess_base_api_mean_text_conf_ptr = nullptr;
+static tess_base_api_clear_func tess_base_api_clear_ptr = nullptr;
+static tess_delete_text_func tess_delete_text_ptr = nullptr;
+static bool tessLayoutResolved = false;
+static tess_base_api_recognize_func tess_base_api_recognize_ptr = nullptr;
+static tess_base_api_get_iterator_func tess_base_api_get_iterator_ptr = nullptr;
+static tess_result_iterator_delete_func tess_result_iterator_delete_ptr = nullptr;
+static tess_result_iterator_next_func tess_result_iterator_next_ptr = nullptr;
+static tess_result_iterator_get_utf8_text_func tess_result_iterator_get_utf8_text_ptr = nullptr;
+static tess_result_iterator_confidence_func tess_result_iterator_confidence_ptr = nullptr;
+static tess_result_iterator_get_page_iterator_func tess_result_iterator_get_page_iterator_ptr = nullptr;
+static tess_page_iterator_bounding_box_func tess_page_iterator_bounding_box_ptr = nullptr;
+static tess_page_iterator_is_at_beginning_of_func tess_page_iterator_is_at_beginning_of_ptr = nullptr;
+
+static const int PSM_AUTO = 3;
+static const int RIL_TEXTLINE = 2;
+static const int RIL_WORD = 3;
+static const int SCREEN_PPI = 96;
+
+static bool loadTesseractLibrary()
+{
+    QMutexLocker locker(&tessLibMutex);
+    if (tessLib) {
+        return tessLibResolved;
+    }
+
+    // 优先使用随程序发布的库，其次使用系统安装的库
+    QString appDir = QCoreApplication::applicationDirPath();
+    QStringList candidates;
+    candidates << appDir + "/../libs/tesseract/lib/libtesseract.dll"
+               << "tesseract"
+               << "libtesseract-5";
+
+    tessLib = new QLibrary();
+    for (const QString &name : candidates) {
+        tessLib->setFileName(name);
+        if (tessLib->load()) {
+            break;
+        }
+    }
+    if (!tessLib->isLoaded()) {
+        qDebug() << "Failed to load libtesseract:" << tessLib->errorString();
+        return false;
+    }
+
+    tess_base_api_create_ptr = (tess_base_api_create_func)tessLib->resolve("TessBaseAPICreate");
+    tess_base_api_delete_ptr = (tess_base_api_delete_func)tessLib->resolve("TessBaseAPIDelete");
+    tess_base_api_init3_ptr = (tess_base_api_init3_func)tessLib->resolve("TessBaseAPIInit3");
+    tess_base_api_set_page_seg_mode_ptr = (tess_base_api_set_page_seg_mode_func)tessLib->resolve("TessBaseAPISetPageSegMode");
+    tess_base_api_set_image_ptr = (tess_base_api_set_image_func)tessLib->resolve("TessBaseAPISetImage");
+    tess_base_api_set_source_resolution_ptr = (tess_base_api_set_source_resolution_func)tessLib->resolve("TessBaseAPISetSourceResolution");
+    tess_base_api_set_rectangle_ptr = (tess_base_api_set_rectangle_func)tessLib->resolve("TessBaseAPISetRectangle");
+    tess_base_api_get_utf8_text_ptr = (tess_base_api_get_utf8_text_func)tessLib->resolve("TessBaseAPIGetUTF8Text");
+    tess_base_api_mean_text_conf_ptr = (tess_base_api_mean_text_conf_func)tessLib->resolve("TessBaseAPIMeanTextConf");
+    tess_base_api_clear_ptr = (tess_base_api_clear_func)tessLib->resolve("TessBaseAPIClear");
+    tess_delete_text_ptr = (tess_delete_text_func)tessLib->resolve("TessDeleteText");
+    if (!tess_base_api_create_ptr || !tess_base_api_delete_ptr || !tess_base_api_init3_ptr ||
+        !tess_base_api_set_page_seg_mode_ptr || !tess_base_api_set_image_ptr || !tess_base_api_set_source_resolution_ptr ||
+        !tess_base_api_set_rectangle_ptr || !tess_base_api_get_utf8_text_ptr || !tess_base_api_mean_text_conf_ptr || !tess_base_api_clear_ptr || !tess_delete_text_ptr) {
+        qDebug() << "Failed to resolve Tesseract functions";
+        return false;
+    }
+
+    tess_base_api_recognize_ptr = (tess_base_api_recognize_func)tessLib->resolve("TessBaseAPIRecognize");
+    tess_base_api_get_iterator_ptr = (tess_base_api_get_iterator_func)tessLib->resolve("TessBaseAPIGetIterator");
+    tess_result_iterator_delete_ptr = (tess_result_iterator_delete_func)tessLib->resolve("TessResultIteratorDelete");
+    tess_result_iterator_next_ptr = (tess_result_iterator_next_func)tessLib->resolve("TessResultIteratorNext");
+    tess_result_iterator_get_utf8_text_ptr = (tess_result_iterator_get_utf8_text_func)tessLib->resolve("TessResultIteratorGetUTF8Text");
+    tess_result_iterator_confidence_ptr = (tess_result_iterator_confidence_func)tessLib->resolve("TessResultIteratorConfidence");
+    tess_result_iterator_get_page_iterator_ptr = (tess_result_iterator_get_page_iterator_func)tessLib->resolve("TessResultIteratorGetPageIterator");
+    tess_page_iterator_bounding_box_ptr = (tess_page_iterator_bounding_box_func)tessLib->resolve("TessPageIteratorBoundingBox");
+    tess_page_iterator_is_at_beginning_of_ptr = (tess_page_iterator_is_at_beginning_of_func)tessLib->resolve("TessPageIteratorIsAtBeginningOf");
+    tessLayoutResolved = tess_base_api_recognize_ptr && tess_base_api_get_iterator_ptr && tess_result_iterator_delete_ptr &&
+                         tess_result_iterator_next_ptr && tess_result_iterator_get_utf8_text_ptr &&
+                         tess_result_iterator_confidence_ptr && tess_result_iterator_get_page_iterator_ptr &&
+                         tess_page_iterator_bounding_box_ptr && tess_page_iterator_is_at_beginning_of_ptr;
+    if (!tessLayoutResolved) {
+        qDebug() << "Tesseract result iterator not available, word boxes disabled";
+    }
+
+    tessLibResolved = true;
+    return true;
+}
+
+// 读取当前识别结果中的行和词，坐标换算为相对于rect左上角
+static OCRResult collectLayout(TessBaseAPI *api, const QRect &rect)
+{
+    OCRResult layout;
+    layout.addBlock(QRect(QPoint(0, 0), rect.size()));
+    if (!tessLayoutResolved) return layout;
+
+    TessResultIterator *it = tess_base_api_get_iterator_ptr(api);
+    if (!it) return layout;
+    void *page = tess_result_iterator_get_page_iterator_ptr(it);
+    do {
+        int left, top, right, bottom;
+        if (!tess_page_iterator_bounding_box_ptr(page, RIL_WORD, &left, &top, &right, &bottom)) continue;
+        if (layout.lineCount() == 0 || tess_page_iterator_is_at_beginning_of_ptr(page, RIL_TEXTLINE)) {
+            int lineLeft, lineTop, lineRight, lineBottom;
+            if (tess_page_iterator_bounding_box_ptr(page, RIL_TEXTLINE, &lineLeft, &lineTop, &lineRight, &lineBottom)) {
+                layout.addLine(QRect(lineLeft, lineTop, lineRight - lineLeft, lineBottom - lineTop).translated(-rect.topLeft()));
+            }
+        }
+        char *text = tess_result_iterator_get_utf8_text_ptr(it, RIL_WORD);
+        if (!text) continue;
+        layout.addWord(QRect(left, top, right - left, bottom - top).translated(-rect.topLeft()), text, int(qstrlen(text)),
+                       qRound(tess_result_iterator_confidence_ptr(it, RIL_WORD)));
+        tess_delete_text_ptr(text);
+    } while (tess_result_iterator_next_ptr(it, RIL_WORD));
+    tess_result_iterator_delete_ptr(it);
+    return layout;
+}
+
+TesseractEngine::TesseractEngine(const QString &language)
+    : lang(language), handle(nullptr), ready(false), attempted(false), routing(qgetenv("OCR_SCRIPT_ROUTING") != "0")
+{
+    // 组合模型中同时有中文和英文时才按文字种类分流
+    const QStringList parts = language.split(QLatin1Char('+'), Qt::SkipEmptyParts);
+    if (parts.size() > 1) {
+        for (const QString &part : parts) {
+            if (hanLang.isEmpty() && part.startsWith(QLatin1String("chi_"))) hanLang = part;
+            if (latinLang.isEmpty() && part == QLatin1String("eng")) latinLang = part;
+        }
+    }
+}
+
+TesseractEngine::~TesseractEngine()
+{
+    if (!tess_base_api_delete_ptr) return;
+    for (void *api : std::as_const(subHandles)) {
+        if (api) tess_base_api_delete_ptr(static_cast<TessBaseAPI*>(api));
+    }
+    if (handle) {
+        tess_base_api_delete_ptr(static_cast<TessBaseAPI*>(handle));
+        handle = nullptr;
+    }
+}
+
+bool TesseractEngine::init()
+{
+    if (ready) return true;
+    attempted = true;
+    if (!loadTesseractLibrary()) return false;
+
+    handle = createApi(lang);
+    if (!handle) return false;
+
+    ready = true;
+    return true;
+}
+
+void *TesseractEngine::createApi(const QString &language)
+{
+    TessBaseAPI *api = tess_base_api_create_ptr();
+    if (!api) {
+        qDebug() << "Failed to create Tesseract instance";
+        return nullptr;
+    }
+
+    // 使用随程序发布的tessdata，不存在时交给TESSDATA_PREFIX
+    QString dataPath = QCoreApplication::applicationDirPath() + "/../resources/tessdata";
+    QByteArray dataPathUtf8 = QFileInfo(dataPath).isDir() ? QDir::cleanPath(dataPath).toUtf8() : QByteArray();
+    qDebug() << "Loading Tesseract model" << language;
+    if (tess_base_api_init3_ptr(api, dataPathUtf8.isEmpty() ? nullptr : dataPathUtf8.constData(),
+                                language.toUtf8().constData()) != 0) {
+        qDebug() << "Failed to load Tesseract model" << language;
+        tess_base_api_delete_ptr(api);
+        return nullptr;
+    }
+    tess_base_api_set_page_seg_mode_ptr(api, PSM_AUTO);
+    return api;
+}
+
+bool TesseractEngine::isReady() const
+{
+    return ready;
+}
+
+QString TesseractEngine::language() const
+{
+    return lang;
+}
+
+QString TesseractEngine::recognize(const QImage &image)
+{
+    if (image.isNull()) return QString();
+    if (!ready && (attempted || !init())) {
+        return recognizeWithProcess(image, lang);
+    }
+
+    // 灰度输入，带宽只有ARGB32的四分之一
+    QImage gray = image.format() == QImage::Format_Grayscale8 ? image : image.convertToFormat(QImage::Format_Grayscale8);
+
+    TessBaseAPI *api = static_cast<TessBaseAPI*>(handle);
+    tess_base_api_set_image_ptr(api, gray.constBits(), gray.width(), gray.height(), 1, int(gray.bytesPerLine()));
+    tess_base_api_set_source_resolution_ptr(api, SCREEN_PPI);
+
+    char *text = tess_base_api_get_utf8_text_ptr(api);
+    QString recognizedText;
+    if (text) {
+        recognizedText = QString::fromUtf8(text).trimmed();
+        tess_delete_text_ptr(text);
+    }
+    // 只清除识别结果，保留已加载的模型
+    tess_base_api_clear_ptr(api);
+    return recognizedText;
+}
+
+QStringList TesseractEngine::recognizeRegions(const QImage &image, const QVector<QRect> &regions, QVector<int> *confidences,
+                                              QVector<OCRResult> *layouts)
+{
+    QStringList results;
+    if (confidences) confidences->clear();
+    if (layouts) layouts->clear();
+    if (image.isNull() || regions.isEmpty()) return results;
+    if (!ready && (attempted || !init())) {
+        for (const QRect &region : regions) {
+            results << recognizeWithProcess(image.copy(region), lang);
+            if (confidences) confidences->append(0);
+            if (layouts) layouts->append(OCRResult());
+        }
+        return results;
+    }
+
+    QImage gray = image.format() == QImage::Format_Grayscale8 ? image : image.convertToFormat(QImage::Format_Grayscale8);
+
+    for (int i = 0; i < regions.size(); ++i) {
+        results << QString();
+    }
+    if (confidences) confidences->fill(0, regions.size());
+    if (layouts) layouts->resize(regions.size());
+
+    // 按区域的文字种类分组，每个模型只设置一次图像
+    const QRect bounds = gray.rect();
+    QMap<QString, QVector<int>> groups;
+    for (int i = 0; i < regions.size(); ++i) {
+        const QRect rect = regions[i].intersected(bounds);
+        if (rect.isEmpty()) continue;
+        groups[routeLanguage(gray, rect)].append(i);
+    }
+
+    for (auto group = groups.cbegin(); group != groups.cend(); ++group) {
+        TessBaseAPI *api = static_cast<TessBaseAPI*>(handleFor(group.key()));
+        // 单一语言模型加载失败时回退到组合模型
+        const QString used = api ? group.key() : lang;
+        if (!api) api = static_cast<TessBaseAPI*>(handle);
+        tess_base_api_set_image_ptr(api, gray.constBits(), gray.width(), gray.height(), 1, int(gray.bytesPerLine()));
+        tess_base_api_set_source_resolution_ptr(api, SCREEN_PPI);
+
+        RouteStats &stats = routes[used];
+        QElapsedTimer timer;
+        timer.start();
+        for (int i : group.value()) {
+            const QRect rect = regions[i].intersected(bounds);
+            // 只识别矩形区域，不需要拷贝子图
+            tess_base_api_set_rectangle_ptr(api, rect.x(), rect.y(), rect.width(), rect.height());
+            // 先显式识别，之后取整段文字和逐词结果都不会重复识别
+            if (layouts && tessLayoutResolved) {
+                tess_base_api_recognize_ptr(api, nullptr);
+            }
+            char *text = tess_base_api_get_utf8_text_ptr(api);
+            if (text) {
+                results[i] = QString::fromUtf8(text).trimmed();
+                tess_delete_text_ptr(text);
+            }
+            if (confidences) {
+                (*confidences)[i] = tess_base_api_mean_text_conf_ptr(api);
+            }
+            if (layouts) {
+                (*layouts)[i] = collectLayout(api, rect);
+            }
+            ++stats.regions;
+            stats.pixels += qint64(rect.width()) * rect.height();
+        }
+        stats.nsecs += timer.nsecsElapsed();
+        tess_base_api_clear_ptr(api);
+    }
+    return results;
+}
+
+void TesseractEngine::setScriptRouting(bool enabled)
+{
+    routing = enabled;
+}
+
+bool TesseractEngine::scriptRouting() const
+{
+    return routing && !hanLang.isEmpty() && !latinLang.isEmpty();
+}
+
+QMap<QString, TesseractEngine::RouteStats> TesseractEngine::routeStats() const
+{
+    return routes;
+}
+
+void TesseractEngine::resetRouteStats()
+{
+    routes.clear();
+}
+
+QString TesseractEngine::routeLanguage(const QImage &gray, const QRect &rect) const
+{
+    if (!scriptRouting()) return lang;
+    switch (ScriptDetector::detect(gray, rect)) {
+    case ScriptDetector::Han:
+        return hanLang;
+    case ScriptDetector::Latin:
+        return latinLang;
+    default:
+        // 混合或无法判断时用组合模型，宁可慢一点也不丢字
+        return lang;
+    }
+}
+
+void *TesseractEngine::handleFor(const QString &language)
+{
+    if (language == lang) return handle;
+    auto it = subHandles.constFind(language);
+    if (it != subHandles.constEnd()) return it.value();
+
+    // 第一次用到时才加载，失败后记为空，不再重试
+    void *api = createApi(language);
+    subHandles.insert(language, api);
+    return api;
+}
+
+QString TesseractEngine::recognizeWithProcess(const QImage &image, const QString &language)
+{
+    // 保存为临时文件
+    QTemporaryFile tempFile(QDir::tempPath() + "/screen_XXXXXX.png");
+    if (!tempFile.open()) {
+        qDebug() << "Failed to create temp file";
+        return QString();
+    }
+
+    if (!image.save(&tempFile, "PNG")) {
+        qDebug() << "Failed to save screenshot";
+        return QString();
+    }
+
+    QString tempFileName = tempFile.fileName();
+    tempFile.close();
+
+    // 使用QProcess调用tesseract命令行
+    QProcess process;
+    QStringList arguments;
+    arguments << tempFileName << "stdout" << "-l" << language;
+
+    process.start("tesseract", arguments);
+    if (!process.waitForFinished(5000)) { // 5秒超时
+        qDebug() << "Tesseract process timeout";
+        return QString();
+    }
+
+    QByteArray output = process.readAllStandardOutput();
+    return QString::fromUtf8(output).trimmed();
+}
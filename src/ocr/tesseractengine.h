@@ -0,0 +1,82 @@
+#ifndef TESSERACTENGINE_H
+#define TESSERACTENGINE_H
+
+#include <QtCore/qglobal.h>
+
+#ifndef OCR_EXPORT
+#ifdef OCR_LIBRARY
+#define OCR_EXPORT Q_DECL_EXPORT
+#else
+#define OCR_EXPORT Q_DECL_IMPORT
+#endif
+#endif
+
+#include <QHash>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QImage>
+#include <QRect>
+#include <QVector>
+#include "ocrresult.h"
+
+// 进程内Tesseract识别引擎
+// 通过QLibrary动态加载libtesseract的C API，模型只在init()时加载一次并常驻内存。
+// 每个实例持有一个TessBaseAPI句柄，不是线程安全的，每个线程应使用自己的实例。
+// 组合模型（如chi_sim+eng）识别多个区域时，先按字形判断每个区域的文字种类：
+// 纯中文区域用chi_sim，纯英文区域用eng，混合或无法判断的区域才用组合模型。
+// 单一语言模型在第一次用到时加载，与组合模型一起常驻。设置OCR_SCRIPT_ROUTING=0可关闭分流。
+class OCR_EXPORT TesseractEngine
+{
+public:
+    explicit TesseractEngine(const QString &language = QStringLiteral("chi_sim+eng"));
+    ~TesseractEngine();
+
+    bool init();
+    bool isReady() const;
+    QString language() const;
+
+    // 直接识别内存中的图像，不经过临时文件
+    QString recognize(const QImage &image);
+
+    // 图像只设置一次，依次识别其中的多个区域，结果与regions一一对应。
+    // confidences不为空时填入每个区域的平均置信度（0~100）；
+    // layouts不为空时填入每个区域的行和词，结果只有一个区域，坐标相对于该区域左上角
+    QStringList recognizeRegions(const QImage &image, const QVector<QRect> &regions, QVector<int> *confidences = nullptr,
+                                 QVector<OCRResult> *layouts = nullptr);
+
+    // 按文字种类分流，默认开启；语言不是中英组合时无效
+    void setScriptRouting(bool enabled);
+    bool scriptRouting() const;
+
+    // 各模型识别的区域数、像素数和耗时，用于比较吞吐量
+    struct RouteStats {
+        int regions = 0;
+        qint64 pixels = 0;
+        qint64 nsecs = 0;
+    };
+    QMap<QString, RouteStats> routeStats() const;
+    void resetRouteStats();
+
+    // 旧的命令行路径：PNG临时文件 + tesseract进程，仅在库加载失败时回退使用
+    static QString recognizeWithProcess(const QImage &image, const QString &language);
+
+private:
+    Q_DISABLE_COPY(TesseractEngine)
+
+    static void *createApi(const QString &language);
+    QString routeLanguage(const QImage &gray, const QRect &rect) const;
+    void *handleFor(const QString &language);
+
+    QString lang;
+    void *handle;
+    bool ready;
+    bool attempted;
+    bool routing;
+    QString hanLang;   // 组合模型中的中文部分，如chi_sim
+    QString latinLang; // 组合模型中的英文部分
+    QHash<QString, void *> subHandles; // 单一语言模型，加载失败时为空
+    QMap<QString, RouteStats> routes;
+};
+
+#endif // TESSERACTENGINE_H
@@ -0,0 +1,213 @@
+#include "textdetector.h"
+#include "imagekernels.h"
+#include <QVector>
+#include <cstdlib>
+
+static const int SMEAR_GAP = 8;          // 水平方向合并笔画的最大间隙（降采样后像素）
+static const int MIN_HEIGHT = 3;
+static const int MAX_HEIGHT = 60;
+static const int MIN_WIDTH = 4;
+static const double MIN_EDGE_DENSITY = 0.06;
+static const double MAX_EDGE_DENSITY = 0.6;
+static const double MIN_FILL_RATIO = 0.3;
+static const int BOX_PADDING = 2;
+
+struct DetectorComponent {
+    int parent;
+    int left;
+    int top;
+    int right;
+    int bottom;
+    qint64 area;
+    qint64 edges;
+};
+
+struct DetectorRun {
+    int x0;
+    int x1;
+    int label;
+};
+
+static int findRoot(QVector<DetectorComponent> &components, int label)
+{
+    while (components[label].parent != label) {
+        components[label].parent = components[components[label].parent].parent;
+        label = components[label].parent;
+    }
+    return label;
+}
+
+static void unite(QVector<DetectorComponent> &components, int a, int b)
+{
+    a = findRoot(components, a);
+    b = findRoot(components, b);
+    if (a == b) return;
+    if (b < a) qSwap(a, b);
+    DetectorComponent &ca = components[a];
+    const DetectorComponent &cb = components[b];
+    ca.left = qMin(ca.left, cb.left);
+    ca.top = qMin(ca.top, cb.top);
+    ca.right = qMax(ca.right, cb.right);
+    ca.bottom = qMax(ca.bottom, cb.bottom);
+    ca.area += cb.area;
+    ca.edges += cb.edges;
+    components[b].parent = a;
+}
+
+TextDetector::TextDetector()
+    : scaleFactor(2), edgeLevel(24)
+{
+}
+
+void TextDetector::setScale(int factor)
+{
+    scaleFactor = qMax(1, factor);
+}
+
+int TextDetector::scale() const
+{
+    return scaleFactor;
+}
+
+void TextDetector::setEdgeThreshold(int threshold)
+{
+    edgeLevel = qBound(1, threshold, 255);
+}
+
+int TextDetector::edgeThreshold() const
+{
+    return edgeLevel;
+}
+
+QVector<QRect> TextDetector::detect(const QImage &gray) const
+{
+    QVector<QRect> boxes;
+    if (gray.isNull()) return boxes;
+
+    const QImage small = ImageKernels::downscale(ImageKernels::toGray(gray), scaleFactor);
+    const int factor = gray.width() / qMax(1, small.width());
+    const int width = small.width();
+    const int height = small.height();
+    if (width < 2 || height < 2) return boxes;
+
+    // 1. 水平梯度边缘：文字的竖直笔画产生密集的水平灰度跳变
+    QVector<uchar> edges(width * height, 0);
+    for (int y = 0; y < height; ++y) {
+        const uchar *row = small.constScanLine(y);
+        uchar *out = edges.data() + y * width;
+        for (int x = 0; x + 1 < width; ++x) {
+            out[x] = std::abs(int(row[x + 1]) - int(row[x])) >= edgeLevel ? 1 : 0;
+        }
+    }
+
+    // 2. 水平游程平滑，把同一行的笔画连成文字行
+    QVector<uchar> mask(edges);
+    for (int y = 0; y < height; ++y) {
+        uchar *row = mask.data() + y * width;
+        int lastEdge = -1;
+        for (int x = 0; x < width; ++x) {
+            if (!row[x]) continue;
+            if (lastEdge >= 0 && x - lastEdge - 1 <= SMEAR_GAP) {
+                for (int fill = lastEdge + 1; fill < x; ++fill) {
+                    row[fill] = 1;
+                }
+            }
+            lastEdge = x;
+        }
+    }
+
+    // 3. 竖直方向闭合1像素的缝隙，连接汉字上下分离的部件；行间距通常更大，不会把相邻行连起来
+    QVector<uchar> closed(mask);
+    for (int y = 1; y + 1 < height; ++y) {
+        const uchar *above = mask.constData() + (y - 1) * width;
+        const uchar *below = mask.constData() + (y + 1) * width;
+        uchar *out = closed.data() + y * width;
+        for (int x = 0; x < width; ++x) {
+            if (!out[x] && above[x] && below[x]) {
+                out[x] = 1;
+            }
+        }
+    }
+
+    // 4. 基于游程的连通域标记
+    QVector<DetectorComponent> components;
+    QVector<DetectorRun> previousRuns;
+    QVector<DetectorRun> currentRuns;
+    for (int y = 0; y < height; ++y) {
+        const uchar *row = closed.constData() + y * width;
+        const uchar *edgeRow = edges.constData() + y * width;
+        currentRuns.clear();
+        int x = 0;
+        while (x < width) {
+            if (!row[x]) {
+                ++x;
+                continue;
+            }
+            DetectorRun run;
+            run.x0 = x;
+            qint64 edgeCount = 0;
+            while (x < width && row[x]) {
+                edgeCount += edgeRow[x];
+                ++x;
+            }
+            run.x1 = x - 1;
+            run.label = components.size();
+
+            DetectorComponent c;
+            c.parent = run.label;
+            c.left = run.x0;
+            c.right = run.x1;
+            c.top = y;
+            c.bottom = y;
+            c.area = run.x1 - run.x0 + 1;
+            c.edges = edgeCount;
+            components.append(c);
+
+            // 与上一行相邻（8连通）的游程合并
+            for (const DetectorRun &prev : previousRuns) {
+                if (prev.x1 + 1 >= run.x0 && prev.x0 - 1 <= run.x1) {
+                    unite(components, prev.label, run.label);
+                }
+            }
+            currentRuns.append(run);
+        }
+        qSwap(previousRuns, currentRuns);
+    }
+
+    // 5. 过滤并映射回原图坐标
+    const QRect bounds = gray.rect();
+    for (int i = 0; i < components.size(); ++i) {
+        if (components[i].parent != i) continue;
+        const DetectorComponent &c = components[i];
+        const int w = c.right - c.left + 1;
+        const int h = c.bottom - c.top + 1;
+        if (h < MIN_HEIGHT || h > MAX_HEIGHT || w < MIN_WIDTH) continue;
+
+        const double boxArea = double(w) * h;
+        const double edgeDensity = c.edges / boxArea;
+        const double fillRatio = c.area / boxArea;
+        if (edgeDensity < MIN_EDGE_DENSITY || edgeDensity > MAX_EDGE_DENSITY || fillRatio < MIN_FILL_RATIO) continue;
+
+        QRect box((c.left - BOX_PADDING) * factor, (c.top - BOX_PADDING) * factor,
+                  (w + 2 * BOX_PADDING) * factor, (h + 2 * BOX_PADDING) * factor);
+        boxes.append(box.intersected(bounds));
+    }
+
+    // 6. 合并相互重叠的候选框
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (int i = 0; i < boxes.size() && !merged; ++i) {
+            for (int j = i + 1; j < boxes.size(); ++j) {
+                if (boxes[i].intersects(boxes[j])) {
+                    boxes[i] = boxes[i].united(boxes[j]);
+                    boxes.removeAt(j);
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    return boxes;
+}
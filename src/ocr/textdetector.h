@@ -0,0 +1,42 @@
+#ifndef TEXTDETECTOR_H
+#define TEXTDETECTOR_H
+
+#include <QtCore/qglobal.h>
+
+#ifndef OCR_EXPORT
+#ifdef OCR_LIBRARY
+#define OCR_EXPORT Q_DECL_EXPORT
+#else
+#define OCR_EXPORT Q_DECL_IMPORT
+#endif
+#endif
+
+#include <QImage>
+#include <QRect>
+#include <QVector>
+
+// 文字区域检测
+// 在降采样的灰度图上计算水平梯度边缘，按行做游程平滑把笔画连成文字行，
+// 再做连通域分析，按高度、宽高比和边缘密度过滤掉图片、视频等非文字区域。
+// 返回的候选框已映射回输入图像坐标。
+class OCR_EXPORT TextDetector
+{
+public:
+    TextDetector();
+
+    // 检测前的降采样倍数，默认2
+    void setScale(int factor);
+    int scale() const;
+
+    // 边缘阈值（相邻像素灰度差），默认24
+    void setEdgeThreshold(int threshold);
+    int edgeThreshold() const;
+
+    QVector<QRect> detect(const QImage &gray) const;
+
+private:
+    int scaleFactor;
+    int edgeLevel;
+};
+
+#endif // TEXTDETECTOR_H
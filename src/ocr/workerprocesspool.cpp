@@ -0,0 +1,356 @@
+#include "workerprocesspool.h"
+#include "workerprotocol.h"
+#include <QCoreApplication>
+#include <QDeadlineTimer>
+#include <QFileInfo>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QProcess>
+#include <QThread>
+#include <QDebug>
+#include <algorithm>
+
+static const int START_TIMEOUT_MS = 30000;    // 启动进程并加载模型
+static const int REQUEST_TIMEOUT_MS = 10000;  // 一个区域超过此时间未返回视为卡死
+static const int POLL_MS = 100;               // 等待期间检查停止标志的间隔
+static const int SLOT_TIMEOUT_MS = 2000;      // 等待空闲槽位
+static const int RESTART_DELAY_MS = 200;      // 首次重启延迟，连续失败时加倍
+static const int MAX_RESTART_DELAY_MS = 5000;
+
+WorkerProcessPool::WorkerProcessPool(int workers, const QString &language, qint64 maxFrameBytes, int slotCount)
+    : workers(workers > 0 ? workers : qMax(1, QThread::idealThreadCount())), lang(language), frameBytes(maxFrameBytes),
+      ringSlots(qMax(1, slotCount)), live(0), starting(0), restarts(0), stopping(false)
+{
+}
+
+WorkerProcessPool::~WorkerProcessPool()
+{
+    {
+        QMutexLocker locker(&mutex);
+        stopping = true;
+        jobAvailable.wakeAll();
+    }
+    for (QThread *driver : drivers) {
+        driver->wait();
+        delete driver;
+    }
+    ring.detach();
+}
+
+QString WorkerProcessPool::workerExecutable()
+{
+#ifdef Q_OS_WIN
+    return QCoreApplication::applicationDirPath() + QStringLiteral("/ocrworker.exe");
+#else
+    return QCoreApplication::applicationDirPath() + QStringLiteral("/ocrworker");
+#endif
+}
+
+bool WorkerProcessPool::start()
+{
+    if (!drivers.isEmpty()) return true;
+    const QString program = workerExecutable();
+    if (!QFileInfo(program).isExecutable()) {
+        qDebug() << "OCR worker executable not found:" << program;
+        return false;
+    }
+    const QString key = QStringLiteral("ocr-frame-ring-%1").arg(QCoreApplication::applicationPid());
+    if (!ring.create(key, ringSlots, frameBytes)) {
+        return false;
+    }
+
+    // 在驱动线程真正开始启动进程之前，recognize()也要等待而不是直接返回空结果
+    starting = workers;
+    for (int i = 0; i < workers; ++i) {
+        QThread *driver = QThread::create([this, i]() { driverLoop(i); });
+        drivers.append(driver);
+        driver->start();
+    }
+    return true;
+}
+
+int WorkerProcessPool::workerCount() const
+{
+    return workers;
+}
+
+int WorkerProcessPool::liveWorkerCount()
+{
+    QMutexLocker locker(&mutex);
+    return live;
+}
+
+int WorkerProcessPool::restartCount()
+{
+    QMutexLocker locker(&mutex);
+    return restarts;
+}
+
+QStringList WorkerProcessPool::recognize(const QImage &image, const QVector<QRect> &regions, QVector<int> *confidences,
+                                         QVector<OCRResult> *layouts)
+{
+    Batch batch;
+    batch.slot = -1;
+    batch.remaining = 0;
+    batch.wantLayouts = layouts != nullptr;
+    for (int i = 0; i < regions.size(); ++i) {
+        batch.texts << QString();
+        batch.confidences << 0;
+    }
+    if (layouts) {
+        batch.layouts.resize(regions.size());
+    }
+
+    QImage gray = image.format() == QImage::Format_Grayscale8 ? image : image.convertToFormat(QImage::Format_Grayscale8);
+    QPoint origin;
+    if (!gray.isNull() && !regions.isEmpty() && qint64(gray.bytesPerLine()) * gray.height() > ring.slotBytes()) {
+        // 帧比槽位大（例如之后接入了更高分辨率的屏幕）时只传各区域的外接矩形
+        QRect bounds;
+        for (const QRect &region : regions) {
+            bounds |= region.intersected(gray.rect());
+        }
+        gray = gray.copy(bounds);
+        origin = bounds.topLeft();
+    }
+
+    QVector<Job> pending;
+    for (int i = 0; i < regions.size() && !gray.isNull(); ++i) {
+        const QRect rect = regions[i].translated(-origin).intersected(gray.rect());
+        if (rect.isEmpty()) continue;
+        Job job;
+        job.rect = rect;
+        job.index = i;
+        job.area = qint64(rect.width()) * rect.height();
+        job.batch = &batch;
+        pending.append(job);
+    }
+    if (!pending.isEmpty()) {
+        batch.slot = ring.acquire(SLOT_TIMEOUT_MS);
+        if (batch.slot < 0 || !ring.write(batch.slot, gray)) {
+            qDebug() << "OCR frame ring: no slot for a" << gray.size() << "frame, skipping" << pending.size() << "regions";
+            pending.clear();
+        }
+        batch.width = gray.width();
+        batch.height = gray.height();
+        batch.bytesPerLine = int(gray.bytesPerLine());
+    }
+    // 大区域先开始，各进程负载接近
+    std::sort(pending.begin(), pending.end(), [](const Job &a, const Job &b) { return a.area > b.area; });
+
+    QMutexLocker locker(&mutex);
+    if (!pending.isEmpty() && !stopping && (live > 0 || starting > 0)) {
+        batch.remaining = pending.size();
+        for (const Job &job : pending) {
+            jobs.enqueue(job);
+        }
+        jobAvailable.wakeAll();
+        while (batch.remaining > 0) {
+            if (live == 0 && starting == 0) {
+                // 没有可用的识别进程（都在重启退避中），撤回本批还在排队的区域
+                for (auto it = jobs.begin(); it != jobs.end();) {
+                    if (it->batch == &batch) {
+                        it = jobs.erase(it);
+                        --batch.remaining;
+                    } else {
+                        ++it;
+                    }
+                }
+                if (batch.remaining == 0) break;
+            }
+            batchDone.wait(&mutex);
+        }
+    }
+    locker.unlock();
+
+    if (batch.slot >= 0) {
+        ring.release(batch.slot);
+    }
+    if (confidences) {
+        *confidences = batch.confidences;
+    }
+    if (layouts) {
+        *layouts = batch.layouts;
+    }
+    return batch.texts;
+}
+
+void WorkerProcessPool::driverLoop(int index)
+{
+    const QString serverName = QStringLiteral("ocr-worker-%1-%2").arg(QCoreApplication::applicationPid()).arg(index);
+    QLocalServer server;
+    server.setSocketOptions(QLocalServer::UserAccessOption);
+    QLocalServer::removeServer(serverName);
+    if (!server.listen(serverName)) {
+        qDebug() << "OCR worker" << index << "cannot listen on" << serverName << server.errorString();
+        QMutexLocker locker(&mutex);
+        --starting;
+        batchDone.wakeAll();
+        return;
+    }
+
+    QProcess process;
+    process.setProcessChannelMode(QProcess::ForwardedChannels);
+    QLocalSocket *socket = nullptr;
+    int failures = 0;
+    bool first = true;
+    quint64 requestId = 0;
+
+    while (true) {
+        if (!socket) {
+            if (!first) {
+                const int delay = qMin(MAX_RESTART_DELAY_MS, RESTART_DELAY_MS << qMin(failures - 1, 5));
+                if (!waitUnlessStopping(delay)) break;
+                QMutexLocker locker(&mutex);
+                if (stopping) break;
+                ++starting;
+                ++restarts;
+            }
+            first = false;
+            socket = launchWorker(index, &server, &process);
+
+            QMutexLocker locker(&mutex);
+            --starting;
+            if (!socket) {
+                ++failures;
+                batchDone.wakeAll();
+                continue;
+            }
+            ++live;
+        }
+
+        Job job;
+        {
+            QMutexLocker locker(&mutex);
+            while (jobs.isEmpty() && !stopping) {
+                jobAvailable.wait(&mutex);
+            }
+            // 退出前把已排队的任务做完，等待中的调用方才能返回
+            if (jobs.isEmpty()) break;
+            job = jobs.dequeue();
+        }
+
+        OCRWorkerRequest request;
+        request.id = ++requestId;
+        request.slot = job.batch->slot;
+        request.width = job.batch->width;
+        request.height = job.batch->height;
+        request.bytesPerLine = job.batch->bytesPerLine;
+        request.region = job.rect;
+        request.wantLayout = job.batch->wantLayouts;
+        OCRWorkerMessage::write(socket, OCRWorkerMessage::Request, request.encode());
+        while (socket->bytesToWrite() > 0 && socket->waitForBytesWritten(REQUEST_TIMEOUT_MS)) {
+        }
+
+        QByteArray body;
+        OCRWorkerReply reply;
+        const bool ok = socket->bytesToWrite() == 0 &&
+                        readMessage(socket, REQUEST_TIMEOUT_MS, &body, OCRWorkerMessage::Reply) &&
+                        reply.decode(body) && reply.id == request.id;
+
+        QMutexLocker locker(&mutex);
+        if (ok) {
+            job.batch->texts[job.index] = reply.text;
+            job.batch->confidences[job.index] = reply.confidence;
+            if (job.batch->wantLayouts) {
+                job.batch->layouts[job.index] = reply.layout;
+            }
+        }
+        if (--job.batch->remaining == 0) {
+            batchDone.wakeAll();
+        }
+        if (ok) {
+            failures = 0;
+            continue;
+        }
+
+        // 崩溃、断开或超时：这个区域返回空结果，结束进程后按退避重启
+        --live;
+        ++failures;
+        batchDone.wakeAll();
+        locker.unlock();
+        qDebug() << "OCR worker" << index << "failed on a" << job.rect.size() << "region, restarting";
+        process.kill();
+        process.waitForFinished(1000);
+        delete socket;
+        socket = nullptr;
+    }
+
+    if (socket) {
+        // 断开后识别进程自行退出
+        socket->disconnectFromServer();
+        delete socket;
+        QMutexLocker locker(&mutex);
+        --live;
+    }
+    if (process.state() != QProcess::NotRunning && !process.waitForFinished(1000)) {
+        process.kill();
+        process.waitForFinished(1000);
+    }
+    QMutexLocker locker(&mutex);
+    batchDone.wakeAll();
+}
+
+QLocalSocket *WorkerProcessPool::launchWorker(int index, QLocalServer *server, QProcess *process)
+{
+    QStringList arguments;
+    arguments << QStringLiteral("--server") << server->serverName() << QStringLiteral("--ring") << ring.key()
+              << QStringLiteral("--index") << QString::number(index) << QStringLiteral("--language") << lang;
+    process->start(workerExecutable(), arguments);
+    if (!process->waitForStarted(START_TIMEOUT_MS)) {
+        qDebug() << "OCR worker" << index << "failed to start:" << process->errorString();
+        return nullptr;
+    }
+
+    QDeadlineTimer deadline(START_TIMEOUT_MS);
+    while (!server->hasPendingConnections()) {
+        if (deadline.hasExpired() || isStopping() || process->waitForFinished(0)) {
+            qDebug() << "OCR worker" << index << "did not connect";
+            process->kill();
+            process->waitForFinished(1000);
+            return nullptr;
+        }
+        server->waitForNewConnection(POLL_MS);
+    }
+
+    QLocalSocket *socket = server->nextPendingConnection();
+    socket->setParent(nullptr);
+    // 识别进程加载完模型后才发送Hello
+    QByteArray hello;
+    if (!readMessage(socket, int(deadline.remainingTime()), &hello, OCRWorkerMessage::Hello)) {
+        qDebug() << "OCR worker" << index << "did not become ready";
+        delete socket;
+        process->kill();
+        process->waitForFinished(1000);
+        return nullptr;
+    }
+    return socket;
+}
+
+bool WorkerProcessPool::readMessage(QLocalSocket *socket, int timeoutMs, QByteArray *body, quint8 expected)
+{
+    QDeadlineTimer deadline(timeoutMs);
+    OCRWorkerMessage::Type type;
+    while (!OCRWorkerMessage::read(socket, &type, body)) {
+        // 进程退出时套接字随之断开
+        if (socket->state() != QLocalSocket::ConnectedState && socket->bytesAvailable() == 0) return false;
+        if (deadline.hasExpired() || isStopping()) return false;
+        socket->waitForReadyRead(POLL_MS);
+    }
+    return type == expected;
+}
+
+bool WorkerProcessPool::waitUnlessStopping(int ms)
+{
+    QDeadlineTimer deadline(ms);
+    QMutexLocker locker(&mutex);
+    while (!stopping && !deadline.hasExpired()) {
+        jobAvailable.wait(&mutex, deadline);
+    }
+    return !stopping;
+}
+
+bool WorkerProcessPool::isStopping()
+{
+    QMutexLocker locker(&mutex);
+    return stopping;
+}
@@ -0,0 +1,101 @@
+#ifndef WORKERPROCESSPOOL_H
+#define WORKERPROCESSPOOL_H
+
+#include <QtCore/qglobal.h>
+
+#ifndef OCR_EXPORT
+#ifdef OCR_LIBRARY
+#define OCR_EXPORT Q_DECL_EXPORT
+#else
+#define OCR_EXPORT Q_DECL_IMPORT
+#endif
+#endif
+
+#include <QImage>
+#include <QMutex>
+#include <QQueue>
+#include <QRect>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QWaitCondition>
+#include "ocrresult.h"
+#include "regionrecognizer.h"
+#include "sharedframering.h"
+
+class QLocalServer;
+class QLocalSocket;
+class QProcess;
+class QThread;
+
+// 识别进程池
+// 常驻的ocrworker进程各自加载一次模型，识别进程崩溃或卡死不会影响宿主进程。
+// 帧写入共享内存帧环的一个槽位，请求和结果经本地套接字传递，每个区域一次往返。
+// 每个识别进程由宿主中的一个驱动线程负责：启动、收发、超时判定和重启。
+// 区域按面积从大到小排队，与RecognizerPool相同；进程退出或超时时正在识别的区域返回空结果，
+// 驱动线程按指数退避重启该进程，其它进程继续工作。
+class OCR_EXPORT WorkerProcessPool : public RegionRecognizer
+{
+public:
+    // workers为0时使用QThread::idealThreadCount()；maxFrameBytes为一帧灰度图的最大字节数
+    explicit WorkerProcessPool(int workers = 0, const QString &language = "chi_sim+eng",
+                               qint64 maxFrameBytes = 3840 * 2160, int slotCount = 4);
+    ~WorkerProcessPool() override;
+
+    // 找不到ocrworker或无法创建帧环时返回false；识别进程在后台启动，不阻塞调用方
+    bool start();
+
+    int workerCount() const;
+    int liveWorkerCount();
+    // 累计重启次数
+    int restartCount();
+
+    // 识别进程的可执行文件，与主程序放在同一目录
+    static QString workerExecutable();
+
+    QStringList recognize(const QImage &image, const QVector<QRect> &regions, QVector<int> *confidences = nullptr,
+                          QVector<OCRResult> *layouts = nullptr) override;
+
+private:
+    struct Batch {
+        int slot;
+        int width;
+        int height;
+        int bytesPerLine;
+        QStringList texts;
+        QVector<int> confidences;
+        QVector<OCRResult> layouts;
+        bool wantLayouts;
+        int remaining;
+    };
+
+    struct Job {
+        QRect rect;
+        int index;
+        qint64 area;
+        Batch *batch;
+    };
+
+    void driverLoop(int index);
+    QLocalSocket *launchWorker(int index, QLocalServer *server, QProcess *process);
+    bool readMessage(QLocalSocket *socket, int timeoutMs, QByteArray *body, quint8 expected);
+    bool waitUnlessStopping(int ms);
+    bool isStopping();
+
+    int workers;
+    QString lang;
+    qint64 frameBytes;
+    int ringSlots;
+    SharedFrameRing ring;
+    QVector<QThread *> drivers;
+    QMutex mutex;
+    QWaitCondition jobAvailable;
+    QWaitCondition batchDone;
+    QQueue<Job> jobs;
+    int live;     // 已就绪的识别进程
+    int starting; // 正在启动的识别进程
+    int restarts;
+    bool stopping;
+};
+
+#endif // WORKERPROCESSPOOL_H
@@ -0,0 +1,98 @@
+#ifndef WORKERPROTOCOL_H
+#define WORKERPROTOCOL_H
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QIODevice>
+#include <QRect>
+#include <QString>
+#include <QVector>
+#include <QtEndian>
+#include "ocrresult.h"
+
+// 宿主进程与识别进程之间的本地套接字消息
+// 每条消息为：quint32长度（大端，不含自身）+ quint8类型 + QDataStream编码的内容。
+// 帧的像素不经过套接字，只传共享内存帧环的槽位号。
+struct OCRWorkerMessage
+{
+    enum Type : quint8 {
+        Hello = 1,   // 识别进程 -> 宿主：模型已加载
+        Request = 2, // 宿主 -> 识别进程：识别槽位中的一个区域
+        Reply = 3    // 识别进程 -> 宿主：识别结果
+    };
+
+    static void write(QIODevice *device, Type type, const QByteArray &body)
+    {
+        uchar prefix[5];
+        qToBigEndian<quint32>(quint32(body.size() + 1), prefix);
+        prefix[4] = type;
+        device->write(reinterpret_cast<const char *>(prefix), sizeof(prefix));
+        device->write(body);
+    }
+
+    // 缓冲区中已有一条完整的消息时取出并返回true，否则不消耗任何数据
+    static bool read(QIODevice *device, Type *type, QByteArray *body)
+    {
+        if (device->bytesAvailable() < 5) return false;
+        uchar prefix[5];
+        if (device->peek(reinterpret_cast<char *>(prefix), sizeof(prefix)) != sizeof(prefix)) return false;
+        const quint32 length = qFromBigEndian<quint32>(prefix);
+        if (length == 0 || device->bytesAvailable() < qint64(length) + 4) return false;
+        device->skip(sizeof(prefix));
+        *type = Type(prefix[4]);
+        *body = device->read(length - 1);
+        return true;
+    }
+};
+
+struct OCRWorkerRequest
+{
+    quint64 id = 0;
+    qint32 slot = -1;
+    qint32 width = 0;
+    qint32 height = 0;
+    qint32 bytesPerLine = 0;
+    QRect region;
+    bool wantLayout = false;
+
+    QByteArray encode() const
+    {
+        QByteArray body;
+        QDataStream out(&body, QIODevice::WriteOnly);
+        out << id << slot << width << height << bytesPerLine << region << wantLayout;
+        return body;
+    }
+
+    bool decode(const QByteArray &body)
+    {
+        QDataStream in(body);
+        in >> id >> slot >> width >> height >> bytesPerLine >> region >> wantLayout;
+        return in.status() == QDataStream::Ok;
+    }
+};
+
+struct OCRWorkerReply
+{
+    quint64 id = 0;
+    QString text;
+    qint32 confidence = 0;
+    OCRResult layout; // 坐标相对于请求区域的左上角
+
+    QByteArray encode() const
+    {
+        QByteArray body;
+        QDataStream out(&body, QIODevice::WriteOnly);
+        out << id << text << confidence << layout;
+        return body;
+    }
+
+    bool decode(const QByteArray &body)
+    {
+        QDataStream in(body);
+        // 结果来自另一个进程，layout在解码时校验下标和偏移，损坏时按识别进程故障处理
+        in >> id >> text >> confidence >> layout;
+        return in.status() == QDataStream::Ok && confidence >= 0 && confidence <= 100;
+    }
+};
+
+#endif // WORKERPROTOCOL_H
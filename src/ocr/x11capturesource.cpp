@@ -0,0 +1,246 @@
+#include "x11capturesource.h"
+#include <QScreen>
+#include <QRegion>
+#include <QRectF>
+#include <QSocketNotifier>
+#include <QDebug>
+#include <qpa/qplatformscreen.h>
+
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#include <X11/extensions/Xdamage.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include "x11errortrap.h"
+
+struct X11CaptureState {
+    Display *display = nullptr;
+    Window root = 0;
+    Damage damage = 0;
+    int damageEventBase = 0;
+    int damageErrorBase = 0;
+    XImage *image = nullptr;
+    XShmSegmentInfo shm;
+    bool attached = false;
+};
+
+X11CaptureSource::X11CaptureSource(QScreen *screen, QObject *parent)
+    : CaptureSource(parent), target(screen), state(new X11CaptureState()), notifier(nullptr)
+{
+}
+
+X11CaptureSource::~X11CaptureSource()
+{
+    close();
+    delete state;
+}
+
+bool X11CaptureSource::open()
+{
+    if (state->display) return true;
+
+    state->display = XOpenDisplay(nullptr);
+    if (!state->display) {
+        qDebug() << "XOpenDisplay failed";
+        return false;
+    }
+
+    const bool ready = [this]() {
+        X11ErrorTrap trap(state->display);
+        if (!XShmQueryExtension(state->display)) {
+            qDebug() << "X server does not support MIT-SHM";
+            return false;
+        }
+        if (!XDamageQueryExtension(state->display, &state->damageEventBase, &state->damageErrorBase)) {
+            qDebug() << "X server does not support XDamage";
+            return false;
+        }
+
+        state->root = DefaultRootWindow(state->display);
+        // 远程显示无法共享内存，先试着创建一块小图像，挂接失败时退回grabWindow
+        if (!createImage(QSize(16, 16))) {
+            qDebug() << "XShmAttach failed, shared memory not available";
+            return false;
+        }
+
+        state->damage = XDamageCreate(state->display, state->root, XDamageReportRawRectangles);
+        return trap.sync() == 0;
+    }();
+    if (!ready) {
+        close();
+        return false;
+    }
+
+    notifier = new QSocketNotifier(ConnectionNumber(state->display), QSocketNotifier::Read, this);
+    connect(notifier, &QSocketNotifier::activated, this, &X11CaptureSource::processEvents);
+    return true;
+}
+
+void X11CaptureSource::close()
+{
+    if (!state->display) return;
+
+    delete notifier;
+    notifier = nullptr;
+    {
+        X11ErrorTrap trap(state->display);
+        destroyImage();
+        if (state->damage) {
+            XDamageDestroy(state->display, state->damage);
+            state->damage = 0;
+        }
+        trap.sync();
+    }
+    XCloseDisplay(state->display);
+    state->display = nullptr;
+}
+
+bool X11CaptureSource::isOpen() const
+{
+    return state->display != nullptr;
+}
+
+QString X11CaptureSource::name() const
+{
+    return QStringLiteral("xshm");
+}
+
+bool X11CaptureSource::isEventDriven() const
+{
+    return state->display != nullptr;
+}
+
+QRect X11CaptureSource::nativeGeometry() const
+{
+    if (!target || !target->handle()) return QRect();
+    // 由逻辑坐标换算不可靠：缩放后屏幕的逻辑原点与物理原点不一定对应，小数缩放时尺寸也会有舍入误差
+    return target->handle()->geometry();
+}
+
+bool X11CaptureSource::createImage(const QSize &size)
+{
+    X11ErrorTrap trap(state->display);
+    destroyImage();
+
+    Screen *screen = DefaultScreenOfDisplay(state->display);
+    Visual *visual = DefaultVisualOfScreen(screen);
+    const int depth = DefaultDepthOfScreen(screen);
+
+    XImage *image = XShmCreateImage(state->display, visual, depth, ZPixmap, nullptr, &state->shm,
+                                    size.width(), size.height());
+    if (!image) return false;
+
+    // 只支持与QImage::Format_RGB32内存布局一致的32位TrueColor
+    if (image->bits_per_pixel != 32 || visual->red_mask != 0xFF0000 || visual->green_mask != 0x00FF00 ||
+        visual->blue_mask != 0x0000FF || image->byte_order != LSBFirst) {
+        qDebug() << "Unsupported X11 visual, depth" << depth << "bpp" << image->bits_per_pixel;
+        XDestroyImage(image);
+        return false;
+    }
+
+    state->shm.shmid = shmget(IPC_PRIVATE, size_t(image->bytes_per_line) * image->height, IPC_CREAT | 0600);
+    if (state->shm.shmid < 0) {
+        XDestroyImage(image);
+        return false;
+    }
+    state->shm.shmaddr = image->data = static_cast<char *>(shmat(state->shm.shmid, nullptr, 0));
+    state->shm.readOnly = False;
+
+    trap.take();
+    XShmAttach(state->display, &state->shm);
+    const int error = trap.sync();
+    // 双方都挂接后标记删除，进程退出时由系统回收
+    shmctl(state->shm.shmid, IPC_RMID, nullptr);
+
+    if (error != 0) {
+        shmdt(state->shm.shmaddr);
+        XDestroyImage(image);
+        return false;
+    }
+
+    state->image = image;
+    state->attached = true;
+    return true;
+}
+
+void X11CaptureSource::destroyImage()
+{
+    if (!state->image) return;
+
+    if (state->attached) {
+        X11ErrorTrap trap(state->display);
+        XShmDetach(state->display, &state->shm);
+        trap.sync();
+        shmdt(state->shm.shmaddr);
+        state->attached = false;
+    }
+    XDestroyImage(state->image); // XShm图像的销毁函数不会释放共享内存
+    state->image = nullptr;
+}
+
+QImage X11CaptureSource::grab(const QRect &region)
+{
+    if (!state->display || !target || region.isEmpty()) return QImage();
+
+    const QRect screenRect = nativeGeometry();
+    const qreal dpr = target->devicePixelRatio();
+    const QRect native = QRect(screenRect.topLeft() + region.topLeft() * dpr, region.size() * dpr).intersected(screenRect);
+    if (native.isEmpty()) return QImage();
+
+    QImage frame;
+    {
+        X11ErrorTrap trap(state->display);
+        if (!state->image || state->image->width != native.width() || state->image->height != native.height()) {
+            createImage(native.size());
+        }
+        if (state->image && XShmGetImage(state->display, state->root, state->image, native.x(), native.y(), AllPlanes) &&
+            trap.take() == 0) {
+            // 共享内存会被下一次截图覆盖，而图像要交给工作线程，这里复制一份
+            frame = QImage(reinterpret_cast<const uchar *>(state->image->data), state->image->width,
+                           state->image->height, state->image->bytes_per_line, QImage::Format_RGB32).copy();
+        }
+    }
+    // 等待回复时Xlib会把套接字上的XDamage事件一并读入队列，之后套接字通知器不会再为它们触发；
+    // 不在这里处理的话，屏幕静止前的最后一次变化可能一直留在队列中
+    processEvents();
+    return frame;
+}
+
+void X11CaptureSource::processEvents()
+{
+    if (!state->display) return;
+
+    QRegion changed;
+    bool more = true;
+    while (more) {
+        // XPending只读取已到达的数据，不发出请求
+        bool damagedNow = false;
+        while (XPending(state->display) > 0) {
+            XEvent event;
+            XNextEvent(state->display, &event);
+            if (event.type == state->damageEventBase + XDamageNotify) {
+                const XDamageNotifyEvent *notify = reinterpret_cast<const XDamageNotifyEvent *>(&event);
+                changed += QRect(notify->area.x, notify->area.y, notify->area.width, notify->area.height);
+                damagedNow = true;
+            }
+        }
+        more = false;
+        if (damagedNow && state->damage) {
+            X11ErrorTrap trap(state->display);
+            XDamageSubtract(state->display, state->damage, None, None);
+            trap.sync();
+            // 同步时读入队列的事件同样不会触发通知器，继续处理
+            more = XEventsQueued(state->display, QueuedAlready) > 0;
+        }
+    }
+
+    // 根窗口覆盖所有屏幕，只通知落在本屏幕上的部分
+    const QRect screenRect = nativeGeometry();
+    const qreal dpr = target ? target->devicePixelRatio() : 1.0;
+    for (const QRect &rect : changed.intersected(screenRect)) {
+        const QRect local = rect.translated(-screenRect.topLeft());
+        // 向外取整，避免小矩形换算后变为空
+        emit damaged(QRectF(local.x() / dpr, local.y() / dpr, local.width() / dpr, local.height() / dpr).toAlignedRect());
+    }
+}
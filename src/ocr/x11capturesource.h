@@ -0,0 +1,43 @@
+#ifndef X11CAPTURESOURCE_H
+#define X11CAPTURESOURCE_H
+
+#include "capturesource.h"
+
+class QSocketNotifier;
+struct X11CaptureState; // Xlib类型只出现在实现文件中
+
+// X11截图后端
+// 通过MIT-SHM让X服务器把像素直接写入共享内存，省去经由socket传输整幅图像；
+// 通过XDamage接收屏幕变化通知，只有屏幕真正变化时才需要截图。
+// 使用独立的Xlib连接，不依赖Qt的xcb平台插件内部实现，可在Xvfb下运行。
+class X11CaptureSource : public CaptureSource
+{
+    Q_OBJECT
+public:
+    explicit X11CaptureSource(QScreen *screen, QObject *parent = nullptr);
+    ~X11CaptureSource();
+
+    // 连接X服务器并检查XShm与XDamage扩展，任一不可用时返回false
+    bool open();
+    void close();
+    bool isOpen() const;
+
+    QString name() const override;
+    QImage grab(const QRect &region) override;
+    bool isEventDriven() const override;
+
+private slots:
+    void processEvents();
+
+private:
+    bool createImage(const QSize &size);
+    void destroyImage();
+    // 屏幕在根窗口中的位置（设备像素），取自平台插件
+    QRect nativeGeometry() const;
+
+    QPointer<QScreen> target;
+    X11CaptureState *state;
+    QSocketNotifier *notifier;
+};
+
+#endif // X11CAPTURESOURCE_H
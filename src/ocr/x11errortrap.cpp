@@ -0,0 +1,43 @@
+#include "x11errortrap.h"
+#include <QAtomicInteger>
+
+static QAtomicInteger<int> lastX11Error(0);
+static Display *trappedDisplay = nullptr;
+static XErrorHandler previousHandler = nullptr;
+
+static int onX11Error(Display *display, XErrorEvent *event)
+{
+    if (display != trappedDisplay) {
+        return previousHandler ? previousHandler(display, event) : 0;
+    }
+    lastX11Error.storeRelaxed(event->error_code);
+    return 0;
+}
+
+X11ErrorTrap::X11ErrorTrap(Display *display)
+    : display(display), nested(trappedDisplay == display)
+{
+    if (nested) return;
+    lastX11Error.storeRelaxed(0);
+    trappedDisplay = display;
+    previousHandler = XSetErrorHandler(onX11Error);
+}
+
+X11ErrorTrap::~X11ErrorTrap()
+{
+    if (nested) return;
+    XSetErrorHandler(previousHandler);
+    previousHandler = nullptr;
+    trappedDisplay = nullptr;
+}
+
+int X11ErrorTrap::sync()
+{
+    XSync(display, False);
+    return take();
+}
+
+int X11ErrorTrap::take()
+{
+    return lastX11Error.fetchAndStoreRelaxed(0);
+}
@@ -0,0 +1,28 @@
+#ifndef X11ERRORTRAP_H
+#define X11ERRORTRAP_H
+
+#include <X11/Xlib.h>
+
+// 作用域内截获display上的X错误（只在库内部使用）
+// Xlib默认的错误处理会直接退出进程，而错误处理函数是进程全局的：
+// 只在截获期间替换，其它连接的错误转交原来的处理函数，离开时恢复。
+// 发出请求后要在离开前调用sync()，错误才会在截获期间到达；
+// 同一连接上嵌套时只有最外层替换和恢复处理函数。
+class X11ErrorTrap
+{
+public:
+    explicit X11ErrorTrap(Display *display);
+    ~X11ErrorTrap();
+
+    // 等服务器处理完已发出的请求，返回期间发生的错误码并清零
+    int sync();
+
+    // 带回复的请求返回时错误已经到达，不需要同步
+    int take();
+
+private:
+    Display *display;
+    bool nested;
+};
+
+#endif // X11ERRORTRAP_H
@@ -0,0 +1,138 @@
+#include "audioring.h"
+#include <cstring>
+
+static int roundUpPowerOfTwo(int value)
+{
+    int result = 1;
+    while (result < value) result <<= 1;
+    return result;
+}
+
+AudioRing::AudioRing(int capacitySamples)
+    : buffer(roundUpPowerOfTwo(qMax(2, capacitySamples))), mask(buffer.size() - 1), head(0), tail(0), dropped(0),
+      produced(0)
+{
+}
+
+int AudioRing::capacity() const
+{
+    return buffer.size();
+}
+
+int AudioRing::write(const qint16 *samples, int count)
+{
+    if (count <= 0) return 0;
+    produced.fetch_add(count, std::memory_order_relaxed);
+
+    const quint64 w = head.load(std::memory_order_relaxed);
+    const quint64 r = tail.load(std::memory_order_acquire);
+    const int space = buffer.size() - int(w - r);
+    const int n = qMin(count, space);
+    if (n < count) {
+        dropped.fetch_add(count - n, std::memory_order_relaxed);
+    }
+    if (n <= 0) return 0;
+
+    // 环尾放不下时分两段拷贝
+    qint16 *data = buffer.data();
+    const int offset = int(w & quint64(mask));
+    const int first = qMin(n, buffer.size() - offset);
+    std::memcpy(data + offset, samples, size_t(first) * sizeof(qint16));
+    if (n > first) {
+        std::memcpy(data, samples + first, size_t(n - first) * sizeof(qint16));
+    }
+    head.store(w + quint64(n), std::memory_order_release);
+    return n;
+}
+
+int AudioRing::read(qint16 *out, int max)
+{
+    if (max <= 0) return 0;
+    const quint64 r = tail.load(std::memory_order_relaxed);
+    const quint64 w = head.load(std::memory_order_acquire);
+    const int n = qMin(max, int(w - r));
+    if (n <= 0) return 0;
+
+    const qint16 *data = buffer.constData();
+    const int offset = int(r & quint64(mask));
+    const int first = qMin(n, buffer.size() - offset);
+    std::memcpy(out, data + offset, size_t(first) * sizeof(qint16));
+    if (n > first) {
+        std::memcpy(out + first, data, size_t(n - first) * sizeof(qint16));
+    }
+    tail.store(r + quint64(n), std::memory_order_release);
+    return n;
+}
+
+int AudioRing::available() const
+{
+    return int(head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire));
+}
+
+qint64 AudioRing::overflowSamples() const
+{
+    return dropped.load(std::memory_order_relaxed);
+}
+
+qint64 AudioRing::totalSamples() const
+{
+    return produced.load(std::memory_order_relaxed);
+}
+
+void AudioRing::reset()
+{
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+    dropped.store(0, std::memory_order_relaxed);
+    produced.store(0, std::memory_order_relaxed);
+}
+
+AudioRingSink::AudioRingSink(AudioRing *ring, QObject *parent)
+    : QIODevice(parent), ring(ring), pending(0), hasPending(false)
+{
+}
+
+bool AudioRingSink::isSequential() const
+{
+    return true;
+}
+
+qint64 AudioRingSink::readData(char *data, qint64 maxSize)
+{
+    Q_UNUSED(data)
+    Q_UNUSED(maxSize)
+    return -1; // 只写
+}
+
+qint64 AudioRingSink::writeData(const char *data, qint64 maxSize)
+{
+    if (maxSize <= 0) return 0;
+    const char *bytes = data;
+    qint64 size = maxSize;
+    int lost = 0;
+
+    // 上次回调的字节数是奇数时，先拼出跨回调的那个采样
+    if (hasPending) {
+        char joined[2] = {pending, bytes[0]};
+        qint16 sample;
+        std::memcpy(&sample, joined, sizeof(sample));
+        lost += 1 - ring->write(&sample, 1);
+        hasPending = false;
+        ++bytes;
+        --size;
+    }
+
+    const int samples = int(size / 2);
+    lost += samples - ring->write(reinterpret_cast<const qint16 *>(bytes), samples);
+    if (size % 2) {
+        pending = bytes[size - 1];
+        hasPending = true;
+    }
+
+    emit samplesWritten();
+    if (lost > 0) {
+        emit overflowed(lost);
+    }
+    // 溢出的部分也算作已接收，否则QAudioSource会重试写入同一段旧数据
+    return maxSize;
+}
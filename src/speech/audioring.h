@@ -0,0 +1,80 @@
+#ifndef AUDIORING_H
+#define AUDIORING_H
+
+#include <QtCore/qglobal.h>
+
+#ifndef SPEECH_EXPORT
+#ifdef SPEECH_LIBRARY
+#define SPEECH_EXPORT Q_DECL_EXPORT
+#else
+#define SPEECH_EXPORT Q_DECL_IMPORT
+#endif
+#endif
+
+#include <QIODevice>
+#include <QVector>
+#include <atomic>
+
+// 单生产者单消费者的PCM采样环形缓冲区，无锁
+// 容量在构造时一次分配（向上取2的幂），读写只移动两个原子计数，稳定运行时不分配内存。
+// 写满时丢弃放不下的新采样并计数：生产者不能移动读位置，否则会与消费者竞争。
+class SPEECH_EXPORT AudioRing
+{
+public:
+    explicit AudioRing(int capacitySamples = 16000 * 4);
+
+    int capacity() const;
+
+    // 生产者：写入尽量多的采样，返回实际写入数
+    int write(const qint16 *samples, int count);
+    // 消费者：读出至多max个采样，返回实际读出数
+    int read(qint16 *out, int max);
+
+    // 可读的采样数，消费者调用时准确，生产者调用时是下限
+    int available() const;
+    // 累计因写满而丢弃的采样数
+    qint64 overflowSamples() const;
+    // 累计写入的采样数（含丢弃的），用于换算时间戳
+    qint64 totalSamples() const;
+
+    // 清空，只能在读写两端都停止时调用
+    void reset();
+
+private:
+    Q_DISABLE_COPY(AudioRing)
+
+    QVector<qint16> buffer;
+    int mask;
+    alignas(64) std::atomic<quint64> head; // 写位置，只由生产者修改
+    alignas(64) std::atomic<quint64> tail; // 读位置，只由消费者修改
+    std::atomic<qint64> dropped;
+    std::atomic<qint64> produced;
+};
+
+// 把QAudioSource推送的字节写入AudioRing的只写设备
+// 代替QBuffer：不随每次回调扩容，也不与读取方共用同一个QByteArray。
+class SPEECH_EXPORT AudioRingSink : public QIODevice
+{
+    Q_OBJECT
+public:
+    explicit AudioRingSink(AudioRing *ring, QObject *parent = nullptr);
+
+    bool isSequential() const override;
+
+signals:
+    // 有新采样写入，在生产者线程发出
+    void samplesWritten();
+    // 发生溢出，dropped为本次丢弃的采样数
+    void overflowed(int dropped);
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 maxSize) override;
+
+private:
+    AudioRing *ring;
+    char pending;       // 上次回调留下的半个采样
+    bool hasPending;
+};
+
+#endif // AUDIORING_H
@@ -2,69 +2,41 @@
 #include <QAudioFormat>
 #include <QAudioDevice>
 #include <QMediaDevices>
-#include <QTimer>
 #include <QDebug>
 #include <QJsonDocument>
 #include <QJsonObject>
-#include <QCoreApplication>
-
-// Vosk function pointers
-typedef void* VoskModel;
-typedef void* VoskRecognizer;
-
-typedef VoskModel* (*vosk_model_new_func)(const char *model_path);
-typedef VoskRecognizer* (*vosk_recognizer_new_func)(VoskModel *model, float sample_rate);
-typedef void (*vosk_recognizer_free_func)(VoskRecognizer *recognizer);
-typedef void (*vosk_model_free_func)(VoskModel *model);
-typedef int (*vosk_recognizer_accept_waveform_func)(VoskRecognizer *recognizer, const char *data, int length);
-typedef const char* (*vosk_recognizer_result_func)(VoskRecognizer *recognizer);
-typedef const char* (*vosk_recognizer_partial_result_func)(VoskRecognizer *recognizer);
-
-static QLibrary *voskLib = nullptr;
-static vosk_model_new_func vosk_model_new_ptr = nullptr;
-static vosk_recognizer_new_func vosk_recognizer_new_ptr = nullptr;
-static vosk_recognizer_free_func vosk_recognizer_free_ptr = nullptr;
-static vosk_model_free_func vosk_model_free_ptr = nullptr;
-static vosk_recognizer_accept_waveform_func vosk_recognizer_accept_waveform_ptr = nullptr;
-static vosk_recognizer_result_func vosk_recognizer_result_ptr = nullptr;
-static vosk_recognizer_partial_result_func vosk_recognizer_partial_result_ptr = nullptr;
+#include <QThread>
+
+static const int SAMPLE_RATE = 16000;
+static const int RING_SECONDS = 4; // 识别线程卡顿时最多缓冲的音频
+static const int SAMPLES_PER_MS = SAMPLE_RATE / 1000;
+static const int MIN_CHUNK_MS = 20;
+static const int MAX_CHUNK_MS = 100;
+static const int DEFAULT_CHUNK_MS = 40;
 
 MicLib::MicLib(QObject *parent)
-    : QObject(parent), audioSource(nullptr), audioBuffer(nullptr), timer(nullptr), model(nullptr), recognizer(nullptr)
-{
-    if (!voskLib) {
-        QString appDir = QCoreApplication::applicationDirPath();
-        QString voskLibPath = appDir + "/../libs/vosk/lib/libvosk.dll";
-        voskLib = new QLibrary(voskLibPath);
-        if (!voskLib->load()) {
-            qDebug() << "Failed to load libvosk.dll:" << voskLib->errorString();
-            return;
-        }
-        vosk_model_new_ptr = (vosk_model_new_func)voskLib->resolve("vosk_model_new");
-        vosk_recognizer_new_ptr = (vosk_recognizer_new_func)voskLib->resolve("vosk_recognizer_new");
-        vosk_recognizer_free_ptr = (vosk_recognizer_free_func)voskLib->resolve("vosk_recognizer_free");
-        vosk_model_free_ptr = (vosk_model_free_func)voskLib->resolve("vosk_model_free");
-        vosk_recognizer_accept_waveform_ptr = (vosk_recognizer_accept_waveform_func)voskLib->resolve("vosk_recognizer_accept_waveform");
-        vosk_recognizer_result_ptr = (vosk_recognizer_result_func)voskLib->resolve("vosk_recognizer_result");
-        vosk_recognizer_partial_result_ptr = (vosk_recognizer_partial_result_func)voskLib->resolve("vosk_recognizer_partial_result");
-        if (!vosk_model_new_ptr || !vosk_recognizer_new_ptr || !vosk_recognizer_free_ptr || !vosk_model_free_ptr ||
-            !vosk_recognizer_accept_waveform_ptr || !vosk_recognizer_result_ptr || !vosk_recognizer_partial_result_ptr) {
-            qDebug() << "Failed to resolve Vosk functions";
-        }
-    }
+    : QObject(parent), ring(SAMPLE_RATE * RING_SECONDS), audioSink(nullptr), audioSource(nullptr), startPending(false),
+      decodeThread(nullptr), stopping(false), chunkSamples(DEFAULT_CHUNK_MS * SAMPLES_PER_MS),
+      vadEnabled(qgetenv("SPEECH_VAD") != "0"), chunk(MAX_CHUNK_MS * SAMPLES_PER_MS), vad(SAMPLE_RATE),
+      gated(MAX_CHUNK_MS * SAMPLES_PER_MS + vad.paddingSamples()), utteranceStartMs(-1),
+      vosk(VoskModelRegistry::instance()->api()), recognizer(nullptr)
+{
+    // 启动时就在后台加载模型，第一次开始监听时不再等待
+    VoskModelRegistry *registry = VoskModelRegistry::instance();
+    connect(registry, &VoskModelRegistry::stateChanged, this, &MicLib::onModelStateChanged);
+    registry->preload();
 }
 
 MicLib::~MicLib()
 {
     stopListening();
-    if (recognizer && vosk_recognizer_free_ptr) {
-        vosk_recognizer_free_ptr(recognizer);
+    // 等解码线程送完最后一句，之后才能释放识别器
+    waitForDecoder();
+    if (recognizer) {
+        vosk.recognizer_free(recognizer);
         recognizer = nullptr;
     }
-    if (model && vosk_model_free_ptr) {
-        vosk_model_free_ptr(model);
-        model = nullptr;
-    }
+    model.reset();
 }
 
 void MicLib::startListening()
@@ -74,26 +46,25 @@ void MicLib::startListening()
         qDebug() << "Already listening";
         return;
     }
+    // 模型还在后台加载（或加载失败后重试）时只记下请求，就绪后自动开始
+    VoskModelRegistry *registry = VoskModelRegistry::instance();
+    if (registry->state() != VoskModelRegistry::Ready) {
+        qDebug() << "Vosk model not ready, listening starts when it is loaded";
+        startPending = true;
+        registry->preload();
+        return;
+    }
+    startPending = false;
+    // 上次的解码线程可能还在送出最后一句
+    waitForDecoder();
 
-    // 初始化Vosk模型和识别器
+    // 挂到共享模型上创建识别器
     if (!model) {
-        qDebug() << "Loading Vosk model...";
-        QString appDir = QCoreApplication::applicationDirPath();
-        QString modelPath = appDir + "/../resources/models/vosk-model-cn-0.22";
-        if (vosk_model_new_ptr) {
-            model = vosk_model_new_ptr(modelPath.toUtf8().constData()); // 使用相对路径
-        }
-        if (!model) {
-            qDebug() << "Failed to load Vosk model from" << modelPath;
-            return;
-        }
-        qDebug() << "Model loaded successfully";
+        model = registry->model();
     }
     if (!recognizer) {
         qDebug() << "Creating Vosk recognizer...";
-        if (vosk_recognizer_new_ptr) {
-            recognizer = vosk_recognizer_new_ptr(model, 16000.0f);
-        }
+        recognizer = vosk.recognizer_new(model.data(), float(SAMPLE_RATE));
         if (!recognizer) {
             qDebug() << "Failed to create Vosk recognizer";
             return;
@@ -103,7 +74,7 @@ void MicLib::startListening()
 
     qDebug() << "Setting up audio format...";
     QAudioFormat format;
-    format.setSampleRate(16000);
+    format.setSampleRate(SAMPLE_RATE);
     format.setChannelCount(1);
     format.setSampleFormat(QAudioFormat::Int16);
 
@@ -117,92 +88,222 @@ void MicLib::startListening()
 
     qDebug() << "Creating audio source...";
     audioSource = new QAudioSource(defaultDevice, format, this);
-    audioBuffer = new QBuffer(this);
-    audioBuffer->open(QIODevice::ReadWrite);
-
-    qDebug() << "Starting audio recording...";
-    audioSource->start(audioBuffer);
+    // 采集直接写入预分配的环形缓冲区
+    ring.reset();
+    audioSink = new AudioRingSink(&ring, this);
+    audioSink->open(QIODevice::WriteOnly);
+    connect(audioSink, &AudioRingSink::overflowed, this, &MicLib::onOverflow);
+    // 在采集所在的线程直接唤醒解码线程，不经过GUI事件循环
+    connect(audioSink, &AudioRingSink::samplesWritten, this, [this]() { wakeDecoder(); }, Qt::DirectConnection);
+    lastPartial.clear();
+    utteranceStartMs = -1;
+    vad.reset();
 
-    qDebug() << "Connecting signals...";
-    connect(audioBuffer, &QBuffer::readyRead, this, &MicLib::onReadyRead);
+    qDebug() << "Starting decode thread...";
+    stopping = false;
+    clock.start();
+    decodeThread = QThread::create([this]() { decodeLoop(); });
+    connect(decodeThread, &QThread::finished, this, &MicLib::onDecodeFinished);
+    decodeThread->start();
 
-    qDebug() << "Starting timer...";
-    timer = new QTimer(this);
-    connect(timer, &QTimer::timeout, this, &MicLib::processAudio);
-    timer->start(1000); // 每1秒处理一次，实时更新
+    qDebug() << "Starting audio recording...";
+    audioSource->start(audioSink);
 
     qDebug() << "Start listening completed";
 }
 
 void MicLib::stopListening()
 {
+    startPending = false;
     if (audioSource) {
         audioSource->stop();
         delete audioSource;
         audioSource = nullptr;
     }
-    if (audioBuffer) {
-        audioBuffer->close();
-        delete audioBuffer;
-        audioBuffer = nullptr;
+    if (audioSink) {
+        audioSink->close();
+        delete audioSink;
+        audioSink = nullptr;
     }
-    if (timer) {
-        timer->stop();
-        delete timer;
-        timer = nullptr;
+    // 不等待：解码线程送出剩余音频和最后一句后自行退出
+    QMutexLocker locker(&decodeMutex);
+    stopping = true;
+    samplesReady.wakeOne();
+}
+
+void MicLib::onModelStateChanged(VoskModelRegistry::State state)
+{
+    if (state == VoskModelRegistry::Ready && startPending) {
+        startListening();
+    } else if (state == VoskModelRegistry::Failed && startPending) {
+        qDebug() << "Vosk model failed to load, listening cancelled";
+        startPending = false;
     }
 }
 
-void MicLib::onReadyRead()
+void MicLib::setChunkDuration(int ms)
 {
-    // 累积音频数据
-    audioBuffer->seek(0);
-    QByteArray newData = audioBuffer->readAll();
-    accumulatedAudioData.append(newData);
-    // 清空buffer以准备下次写入
-    audioBuffer->buffer().clear();
-    audioBuffer->seek(0);
+    chunkSamples.storeRelaxed(qBound(MIN_CHUNK_MS, ms, MAX_CHUNK_MS) * SAMPLES_PER_MS);
+    wakeDecoder();
 }
 
-void MicLib::processAudio()
+int MicLib::chunkDuration() const
 {
-    if (accumulatedAudioData.isEmpty() || !recognizer) return;
+    return chunkSamples.loadRelaxed() / SAMPLES_PER_MS;
+}
+
+qint64 MicLib::streamTimeMs() const
+{
+    return clock.isValid() ? clock.elapsed() : 0;
+}
+
+void MicLib::setVoiceActivityDetection(bool enabled)
+{
+    vadEnabled.storeRelaxed(enabled);
+}
+
+bool MicLib::voiceActivityDetection() const
+{
+    return vadEnabled.loadRelaxed();
+}
 
-    // 发送累积的音频数据到Vosk
+double MicLib::skippedAudioPercent() const
+{
+    return vad.skippedPercent();
+}
+
+void MicLib::wakeDecoder()
+{
+    QMutexLocker locker(&decodeMutex);
+    samplesReady.wakeOne();
+}
+
+void MicLib::waitForDecoder()
+{
+    if (!decodeThread) return;
+    decodeThread->wait();
+    delete decodeThread;
+    decodeThread = nullptr;
+}
+
+void MicLib::onDecodeFinished()
+{
+    // 排队到达时该线程可能已在startListening中回收，并换成了新的线程
+    if (decodeThread && sender() == decodeThread) {
+        waitForDecoder();
+    }
+}
+
+void MicLib::decodeLoop()
+{
+    QMutexLocker locker(&decodeMutex);
+    while (true) {
+        // 检查和等待都在锁内，采集端在写入之后加锁唤醒，不会漏掉通知
+        while (!stopping && ring.available() < chunkSamples.loadRelaxed()) {
+            samplesReady.wait(&decodeMutex);
+        }
+        const bool flush = stopping;
+        locker.unlock();
+        processAudio(flush);
+        if (flush) return;
+        locker.relock();
+    }
+}
+
+qint64 MicLib::droppedSamples() const
+{
+    return ring.overflowSamples();
+}
+
+void MicLib::onOverflow(int dropped)
+{
+    qDebug() << "Audio ring overflow, dropped" << dropped << "samples, total" << ring.overflowSamples();
+}
+
+void MicLib::processAudio(bool flush)
+{
+    if (!recognizer) return;
+
+    // 凑够一块就送出；停止时把剩余的也送出
+    const int size = chunkSamples.loadRelaxed();
+    const bool gate = vadEnabled.loadRelaxed();
+    while (ring.available() >= size || (flush && ring.available() > 0)) {
+        const int samples = ring.read(chunk.data(), size);
+        // 块末尾在采集流中的位置
+        const qint64 position = ring.totalSamples() - ring.available();
+        const qint64 timestampMs = position / SAMPLES_PER_MS;
+        if (!gate) {
+            feedChunk(chunk.constData(), samples, timestampMs);
+            continue;
+        }
+        // 只送语音段（含前置音频和拖尾），语音段结束后不必等识别器自己凭静音断句
+        bool segmentEnded = false;
+        const int speech = vad.process(chunk.constData(), samples, gated.data(), &segmentEnded);
+        if (speech > 0) {
+            feedChunk(gated.constData(), speech, timestampMs);
+        }
+        if (segmentEnded) {
+            finishUtterance(takeFinalResult(), timestampMs);
+        }
+    }
+
+    if (flush) {
+        finishUtterance(takeFinalResult(), streamTimeMs());
+        if (gate) {
+            qDebug() << "VAD skipped" << vad.skippedPercent() << "% of" << vad.totalSamples() / SAMPLES_PER_MS
+                     << "ms audio";
+        }
+    }
+}
+
+const char *MicLib::takeFinalResult()
+{
+    // 没有vosk_recognizer_final_result时退回到普通结果
+    if (vosk.final_result) return vosk.final_result(recognizer);
+    return vosk.result(recognizer);
+}
+
+void MicLib::feedChunk(const qint16 *samples, int count, qint64 timestampMs)
+{
     try {
-        if (vosk_recognizer_accept_waveform_ptr) {
-            int result = vosk_recognizer_accept_waveform_ptr(recognizer, accumulatedAudioData.data(), accumulatedAudioData.size());
-            if (result) {
-                if (vosk_recognizer_result_ptr) {
-                    const char *final_result = vosk_recognizer_result_ptr(recognizer);
-                    if (final_result) {
-                        QJsonDocument doc = QJsonDocument::fromJson(final_result);
-                        QString text = doc.object().value("text").toString();
-                        if (!text.isEmpty()) {
-                            emit textRecognized(text);
-                            qDebug() << "Recognized text:" << text;
-                        }
-                    }
-                }
-            } else {
-                // 获取partial result
-                if (vosk_recognizer_partial_result_ptr) {
-                    const char *partial_result = vosk_recognizer_partial_result_ptr(recognizer);
-                    if (partial_result) {
-                        QJsonDocument doc = QJsonDocument::fromJson(partial_result);
-                        QString text = doc.object().value("partial").toString();
-                        if (!text.isEmpty()) {
-                            emit textRecognized(text);
-                            qDebug() << "Partial text:" << text;
-                        }
+        int result = vosk.accept_waveform(recognizer, reinterpret_cast<const char *>(samples),
+                                                         count * int(sizeof(qint16)));
+        if (result) {
+            finishUtterance(vosk.result(recognizer), timestampMs);
+        } else {
+            // 部分结果只在变化时发出
+            const char *partial_result = vosk.partial_result(recognizer);
+            if (partial_result) {
+                QJsonDocument doc = QJsonDocument::fromJson(partial_result);
+                QString text = doc.object().value("partial").toString();
+                if (!text.isEmpty() && text != lastPartial) {
+                    if (utteranceStartMs < 0) {
+                        utteranceStartMs = timestampMs;
+                        qDebug() << "First partial latency (ms):" << streamTimeMs() - timestampMs;
                     }
+                    lastPartial = text;
+                    emit partialTextRecognized(text, timestampMs);
+                    emit textRecognized(text);
                 }
             }
         }
     } catch (...) {
         qDebug() << "Exception in Vosk processing";
     }
+}
+
+void MicLib::finishUtterance(const char *json, qint64 timestampMs)
+{
+    lastPartial.clear();
+    const qint64 start = utteranceStartMs;
+    utteranceStartMs = -1;
+    if (!json) return;
 
-    // 清空累积数据
-    accumulatedAudioData.clear();
+    QJsonDocument doc = QJsonDocument::fromJson(json);
+    QString text = doc.object().value("text").toString();
+    if (text.isEmpty()) return;
+    qDebug() << "Recognized text:" << text << "utterance" << start << "-" << timestampMs << "ms, final latency (ms):"
+             << streamTimeMs() - timestampMs;
+    emit finalTextRecognized(text, timestampMs);
+    emit textRecognized(text);
 }
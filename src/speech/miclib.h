@@ -3,15 +3,24 @@
 
 #include <QObject>
 #include <QAudioSource>
+#include <QElapsedTimer>
 #include <QIODevice>
-#include <QBuffer>
-#include <QTimer>
-#include <QLibrary>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QVector>
+#include <QWaitCondition>
+#include "audioring.h"
+#include "voiceactivitydetector.h"
+#include "voskmodelregistry.h"
 
-// Vosk types
-typedef void* VoskModel;
-typedef void* VoskRecognizer;
+class QThread;
 
+// 麦克风采集与Vosk识别
+// 采集写入无锁环形缓冲区，识别在独立的解码线程中进行：凑够一个音频块就送给识别器，
+// 结果通过信号发出（接收方在其他线程时自动排队），GUI线程不运行任何解码。
+// 识别器只由解码线程使用；停止监听时解码线程送出剩余音频和最后一句后自行退出。
+// 送给识别器之前先经过语音活动检测，静音段不解码，语音段结束时直接取出整句结果。
+// 模型由VoskModelRegistry在后台预加载并共享；模型未就绪时startListening不阻塞，就绪后自动开始。
 class MicLib : public QObject
 {
     Q_OBJECT
@@ -22,20 +31,63 @@ public:
     void startListening();
     void stopListening();
 
+    // 采集缓冲区写满而丢弃的采样数（本次开始监听以来）
+    qint64 droppedSamples() const;
+
+    // 每次送给识别器的音频块时长，20~100毫秒，默认40
+    void setChunkDuration(int ms);
+    int chunkDuration() const;
+
+    // 本次开始监听以来的毫秒数，与结果的timestampMs同一时间基准，相减即为识别延迟
+    qint64 streamTimeMs() const;
+
+    // 语音活动检测，默认开启；环境变量SPEECH_VAD=0时默认关闭
+    void setVoiceActivityDetection(bool enabled);
+    bool voiceActivityDetection() const;
+    // 本次开始监听以来被语音活动检测跳过、未送给识别器的音频占比，0~100
+    double skippedAudioPercent() const;
+
 signals:
+    // 以下信号在解码线程中发出
     void textRecognized(const QString &text);
+    // timestampMs为产生该结果的音频块末尾在本次监听中的位置（毫秒）
+    void partialTextRecognized(const QString &text, qint64 timestampMs);
+    void finalTextRecognized(const QString &text, qint64 timestampMs);
 
 private slots:
-    void onReadyRead();
+    void onOverflow(int dropped);
+    void onDecodeFinished();
+    void onModelStateChanged(VoskModelRegistry::State state);
 
 private:
+    void decodeLoop();
+    void wakeDecoder();
+    void waitForDecoder();
+    void processAudio(bool flush);
+    void feedChunk(const qint16 *samples, int count, qint64 timestampMs);
+    void finishUtterance(const char *json, qint64 timestampMs);
+    const char *takeFinalResult();
+
+    AudioRing ring;          // 采集线程写入，processAudio读出
+    AudioRingSink *audioSink;
     QAudioSource *audioSource;
-    QBuffer *audioBuffer;
-    QTimer *timer;
-    QByteArray accumulatedAudioData;
-    VoskModel *model;
-    VoskRecognizer *recognizer;
-    void processAudio();
+    bool startPending;       // 模型就绪后自动开始监听
+    QThread *decodeThread;
+    QMutex decodeMutex;
+    QWaitCondition samplesReady;
+    bool stopping;           // 受decodeMutex保护
+    QAtomicInt chunkSamples;
+    QAtomicInt vadEnabled;
+    QElapsedTimer clock;     // 解码线程启动前开始计时，之后只读
+    // 以下只在解码线程中使用
+    QVector<qint16> chunk;   // 预分配的读出缓冲区，一个音频块
+    VoiceActivityDetector vad;
+    QVector<qint16> gated;   // 预分配，一个音频块加上前置音频
+    QString lastPartial;
+    qint64 utteranceStartMs; // 当前句子第一次出现部分结果的音频位置，没有时为-1
+    const VoskApi &vosk;
+    QSharedPointer<VoskModel> model; // 注册表中的共享模型，识别器存在期间一直持有
+    VoskRecognizer *recognizer;      // 解码线程运行期间只由解码线程使用
 };
 
 #endif // MICLIB_H
@@ -5,6 +5,9 @@ SpeechModule::SpeechModule(QObject *parent)
     : QObject(parent), micLib(new MicLib(this))
 {
     connect(micLib, &MicLib::textRecognized, this, &SpeechModule::textRecognized);
+    connect(micLib, &MicLib::partialTextRecognized, this, &SpeechModule::partialTextRecognized);
+    connect(micLib, &MicLib::finalTextRecognized, this, &SpeechModule::finalTextRecognized);
+    connect(VoskModelRegistry::instance(), &VoskModelRegistry::stateChanged, this, &SpeechModule::modelStateChanged);
 }
 
 SpeechModule::~SpeechModule()
@@ -23,3 +26,13 @@ void SpeechModule::stopListening()
     qDebug() << "SpeechModule::stopListening called";
     micLib->stopListening();
 }
+
+VoskModelRegistry::State SpeechModule::modelState() const
+{
+    return VoskModelRegistry::instance()->state();
+}
+
+double SpeechModule::skippedAudioPercent() const
+{
+    return micLib->skippedAudioPercent();
+}
@@ -25,8 +25,18 @@ public:
     void startListening();
     void stopListening();
 
+    // 被语音活动检测跳过的音频占比，见MicLib
+    double skippedAudioPercent() const;
+
+    // 语音模型的加载状态，启动时已在后台开始加载
+    VoskModelRegistry::State modelState() const;
+
 signals:
     void textRecognized(const QString &text);
+    // 带音频块时间戳的部分结果和整句结果，见MicLib
+    void partialTextRecognized(const QString &text, qint64 timestampMs);
+    void finalTextRecognized(const QString &text, qint64 timestampMs);
+    void modelStateChanged(VoskModelRegistry::State state);
 
 private:
     MicLib *micLib;
@@ -0,0 +1,178 @@
+#include "voiceactivitydetector.h"
+#include <cmath>
+#include <cstring>
+
+static const int FRAME_MS = 10;
+static const int DEFAULT_PADDING_MS = 200;
+static const int DEFAULT_HANGOVER_MS = 300;
+static const int ONSET_FRAMES = 2;            // 连续语音帧数达到后才进入语音段，滤掉单次的咔哒声
+static const double MIN_SPEECH_DB = 30.0;     // 绝对下限，约为满幅的-60dB
+static const double VOICED_MARGIN_DB = 10.0;  // 浊音高出噪声的幅度
+static const double UNVOICED_MARGIN_DB = 5.0; // 清音高出噪声的幅度
+static const double UNVOICED_MIN_ZCR = 0.3;   // 清音的过零率下限
+static const double NOISE_RISE = 0.02;        // 噪声电平上升很慢，避免被持续的语音拉高
+static const double NOISE_FALL = 0.2;         // 下降较快，环境变安静后很快跟上
+
+VoiceActivityDetector::VoiceActivityDetector(int sampleRate)
+    : frameSamples(qMax(1, sampleRate * FRAME_MS / 1000)), onsetFrames(ONSET_FRAMES),
+      hangoverFrames(DEFAULT_HANGOVER_MS / FRAME_MS), frame(frameSamples), frameFill(0),
+      padding(frameSamples * (DEFAULT_PADDING_MS / FRAME_MS)), padStart(0), padCount(0), speech(false), speechRun(0),
+      hangover(0), noiseDb(0.0), noiseInitialized(false), total(0), emitted(0)
+{
+}
+
+void VoiceActivityDetector::setPaddingMs(int ms)
+{
+    padding.resize(frameSamples * qMax(0, ms / FRAME_MS));
+    padStart = 0;
+    padCount = 0;
+}
+
+void VoiceActivityDetector::setHangoverMs(int ms)
+{
+    hangoverFrames = qMax(0, ms / FRAME_MS);
+}
+
+bool VoiceActivityDetector::isSpeech() const
+{
+    return speech;
+}
+
+int VoiceActivityDetector::paddingSamples() const
+{
+    return padding.size();
+}
+
+double VoiceActivityDetector::noiseLevelDb() const
+{
+    return noiseDb;
+}
+
+qint64 VoiceActivityDetector::totalSamples() const
+{
+    return total.load(std::memory_order_relaxed);
+}
+
+qint64 VoiceActivityDetector::skippedSamples() const
+{
+    return totalSamples() - emitted.load(std::memory_order_relaxed);
+}
+
+double VoiceActivityDetector::skippedPercent() const
+{
+    const qint64 all = totalSamples();
+    return all > 0 ? 100.0 * double(skippedSamples()) / double(all) : 0.0;
+}
+
+void VoiceActivityDetector::reset()
+{
+    frameFill = 0;
+    padStart = 0;
+    padCount = 0;
+    speech = false;
+    speechRun = 0;
+    hangover = 0;
+    noiseDb = 0.0;
+    noiseInitialized = false;
+    total.store(0, std::memory_order_relaxed);
+    emitted.store(0, std::memory_order_relaxed);
+}
+
+int VoiceActivityDetector::process(const qint16 *samples, int count, qint16 *out, bool *segmentEnded)
+{
+    if (segmentEnded) *segmentEnded = false;
+    if (count <= 0) return 0;
+    total.fetch_add(count, std::memory_order_relaxed);
+
+    int written = 0;
+    int consumed = 0;
+    while (consumed < count) {
+        // 凑满一帧再判断，余下的留到下次
+        const int take = qMin(count - consumed, frameSamples - frameFill);
+        std::memcpy(frame.data() + frameFill, samples + consumed, size_t(take) * sizeof(qint16));
+        frameFill += take;
+        consumed += take;
+        if (frameFill < frameSamples) break;
+        frameFill = 0;
+
+        const bool voiced = classifyFrame(frame.constData());
+        if (speech) {
+            if (voiced) {
+                hangover = hangoverFrames;
+            } else if (--hangover < 0) {
+                // 拖尾用完，语音段结束；这一帧作为下一段的前置音频
+                speech = false;
+                speechRun = 0;
+                if (segmentEnded) *segmentEnded = true;
+            }
+        } else {
+            speechRun = voiced ? speechRun + 1 : 0;
+        }
+
+        if (speech) {
+            std::memcpy(out + written, frame.constData(), size_t(frameSamples) * sizeof(qint16));
+            written += frameSamples;
+            continue;
+        }
+
+        // 语音段之外的帧先放入前置缓冲，满了覆盖最旧的
+        const int capacity = padding.size();
+        if (capacity > 0) {
+            for (int i = 0; i < frameSamples; ++i) {
+                padding[(padStart + padCount) % capacity] = frame.at(i);
+                if (padCount < capacity) {
+                    ++padCount;
+                } else {
+                    padStart = (padStart + 1) % capacity;
+                }
+            }
+        }
+        if (speechRun >= onsetFrames) {
+            // 进入语音段：前置缓冲中已经包含了确认用的几帧
+            speech = true;
+            hangover = hangoverFrames;
+            written += flushPadding(out + written);
+        }
+    }
+
+    emitted.fetch_add(written, std::memory_order_relaxed);
+    return written;
+}
+
+bool VoiceActivityDetector::classifyFrame(const qint16 *samples)
+{
+    double energy = 0.0;
+    int crossings = 0;
+    for (int i = 0; i < frameSamples; ++i) {
+        energy += double(samples[i]) * samples[i];
+        if (i > 0 && ((samples[i] >= 0) != (samples[i - 1] >= 0))) ++crossings;
+    }
+    const double db = 10.0 * std::log10(energy / frameSamples + 1.0);
+    const double zcr = frameSamples > 1 ? double(crossings) / (frameSamples - 1) : 0.0;
+
+    if (!noiseInitialized) {
+        noiseDb = db;
+        noiseInitialized = true;
+    }
+    const bool voiced = db >= MIN_SPEECH_DB && db >= noiseDb + VOICED_MARGIN_DB;
+    const bool unvoiced = db >= MIN_SPEECH_DB && db >= noiseDb + UNVOICED_MARGIN_DB && zcr >= UNVOICED_MIN_ZCR;
+    const bool isSpeechFrame = voiced || unvoiced;
+
+    // 只在非语音帧上更新噪声电平
+    if (!isSpeechFrame) {
+        noiseDb += (db > noiseDb ? NOISE_RISE : NOISE_FALL) * (db - noiseDb);
+    }
+    return isSpeechFrame;
+}
+
+int VoiceActivityDetector::flushPadding(qint16 *out)
+{
+    const int capacity = padding.size();
+    const int first = qMin(padCount, capacity - padStart);
+    std::memcpy(out, padding.constData() + padStart, size_t(first) * sizeof(qint16));
+    std::memcpy(out + first, padding.constData(), size_t(padCount - first) * sizeof(qint16));
+    const int flushed = padCount;
+    padStart = 0;
+    padCount = 0;
+    return flushed;
+}
@@ -0,0 +1,70 @@
+#ifndef VOICEACTIVITYDETECTOR_H
+#define VOICEACTIVITYDETECTOR_H
+
+#include <QtCore/qglobal.h>
+
+#ifndef SPEECH_EXPORT
+#ifdef SPEECH_LIBRARY
+#define SPEECH_EXPORT Q_DECL_EXPORT
+#else
+#define SPEECH_EXPORT Q_DECL_IMPORT
+#endif
+#endif
+
+#include <QVector>
+#include <atomic>
+
+// 语音活动检测：能量 + 过零率，带起始确认、前置补偿和拖尾
+// 按10毫秒一帧计算能量（dB）和过零率，与自适应的背景噪声电平比较：
+// 明显高于噪声的是浊音，略高于噪声但过零率高的是清音（擦音、送气音）。
+// 连续两帧是语音才进入语音段，进入时补上之前一小段音频，避免吞掉字头；
+// 语音帧之后再保留一段拖尾，之后的静音不再送给识别器。
+// 只在一个线程中调用process()，统计可以在任意线程读取。
+class SPEECH_EXPORT VoiceActivityDetector
+{
+public:
+    explicit VoiceActivityDetector(int sampleRate = 16000);
+
+    // 进入语音段时补上的前置音频，默认200毫秒
+    void setPaddingMs(int ms);
+    // 最后一个语音帧之后保留的音频，默认300毫秒
+    void setHangoverMs(int ms);
+
+    // 处理一段采样，应送给识别器的部分写入out，返回写入的采样数。
+    // out至少要能容纳count + paddingSamples()个采样。
+    // 语音段在这段采样中结束时segmentEnded置为true，调用方应取出整句结果
+    int process(const qint16 *samples, int count, qint16 *out, bool *segmentEnded = nullptr);
+
+    bool isSpeech() const;
+    int paddingSamples() const;
+    double noiseLevelDb() const;
+
+    qint64 totalSamples() const;
+    qint64 skippedSamples() const;
+    // 跳过的音频占比，0~100
+    double skippedPercent() const;
+
+    void reset();
+
+private:
+    bool classifyFrame(const qint16 *frame);
+    int flushPadding(qint16 *out);
+
+    int frameSamples;
+    int onsetFrames;
+    int hangoverFrames;
+    QVector<qint16> frame;   // 不足一帧的余下采样
+    int frameFill;
+    QVector<qint16> padding; // 语音段之外最近的音频，环形
+    int padStart;
+    int padCount;
+    bool speech;
+    int speechRun;           // 连续的语音帧数
+    int hangover;            // 剩余的拖尾帧数
+    double noiseDb;
+    bool noiseInitialized;
+    std::atomic<qint64> total;
+    std::atomic<qint64> emitted;
+};
+
+#endif // VOICEACTIVITYDETECTOR_H
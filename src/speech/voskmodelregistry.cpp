@@ -0,0 +1,122 @@
+#include "voskmodelregistry.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QThread>
+
+VoskModelRegistry *VoskModelRegistry::instance()
+{
+    static VoskModelRegistry registry;
+    return &registry;
+}
+
+VoskModelRegistry::VoskModelRegistry(QObject *parent)
+    : QObject(parent), current(Unloaded), libraryLoaded(false), loader(nullptr), loadedModel(nullptr)
+{
+}
+
+VoskModelRegistry::~VoskModelRegistry()
+{
+    // 退出时加载线程可能还在读模型，等它结束再释放
+    if (loader) {
+        loader->wait();
+        delete loader;
+        loader = nullptr;
+    }
+    if (loadedModel && functions.model_free) {
+        functions.model_free(loadedModel);
+        loadedModel = nullptr;
+    }
+}
+
+void VoskModelRegistry::preload()
+{
+    if (current == Warming || current == Ready) return;
+    setState(Warming);
+    loader = QThread::create([this]() { load(); });
+    connect(loader, &QThread::finished, this, &VoskModelRegistry::onLoaderFinished);
+    loader->start(QThread::LowPriority);
+}
+
+void VoskModelRegistry::unload()
+{
+    // 加载中不打断，完成后再unload
+    if (current != Ready) return;
+    shared.reset();
+    setState(Unloaded);
+}
+
+VoskModelRegistry::State VoskModelRegistry::state() const
+{
+    return current;
+}
+
+QSharedPointer<VoskModel> VoskModelRegistry::model() const
+{
+    return current == Ready ? shared : QSharedPointer<VoskModel>();
+}
+
+const VoskApi &VoskModelRegistry::api() const
+{
+    return functions;
+}
+
+void VoskModelRegistry::load()
+{
+    QString appDir = QCoreApplication::applicationDirPath();
+    if (!libraryLoaded) {
+        QString voskLibPath = appDir + "/../libs/vosk/lib/libvosk.dll";
+        library.setFileName(voskLibPath);
+        if (!library.load()) {
+            qDebug() << "Failed to load libvosk.dll:" << library.errorString();
+            return;
+        }
+        functions.model_new = (VoskApi::model_new_func)library.resolve("vosk_model_new");
+        functions.model_free = (VoskApi::model_free_func)library.resolve("vosk_model_free");
+        functions.recognizer_new = (VoskApi::recognizer_new_func)library.resolve("vosk_recognizer_new");
+        functions.recognizer_free = (VoskApi::recognizer_free_func)library.resolve("vosk_recognizer_free");
+        functions.accept_waveform = (VoskApi::accept_waveform_func)library.resolve("vosk_recognizer_accept_waveform");
+        functions.result = (VoskApi::result_func)library.resolve("vosk_recognizer_result");
+        functions.partial_result = (VoskApi::result_func)library.resolve("vosk_recognizer_partial_result");
+        functions.final_result = (VoskApi::result_func)library.resolve("vosk_recognizer_final_result");
+        if (!functions.model_new || !functions.model_free || !functions.recognizer_new || !functions.recognizer_free ||
+            !functions.accept_waveform || !functions.result || !functions.partial_result) {
+            qDebug() << "Failed to resolve Vosk functions";
+            return;
+        }
+        libraryLoaded = true;
+    }
+
+    qDebug() << "Loading Vosk model...";
+    QString modelPath = appDir + "/../resources/models/vosk-model-cn-0.22";
+    loadedModel = functions.model_new(modelPath.toUtf8().constData()); // 使用相对路径
+    if (!loadedModel) {
+        qDebug() << "Failed to load Vosk model from" << modelPath;
+        return;
+    }
+    qDebug() << "Model loaded successfully";
+}
+
+void VoskModelRegistry::onLoaderFinished()
+{
+    if (!loader || sender() != loader) return;
+    loader->wait();
+    delete loader;
+    loader = nullptr;
+
+    if (!loadedModel) {
+        setState(Failed);
+        return;
+    }
+    // 最后一个引用释放时释放模型，识别器各自持有引用
+    const VoskApi::model_free_func modelFree = functions.model_free;
+    shared = QSharedPointer<VoskModel>(loadedModel, [modelFree](VoskModel *model) { modelFree(model); });
+    loadedModel = nullptr;
+    setState(Ready);
+}
+
+void VoskModelRegistry::setState(State newState)
+{
+    if (current == newState) return;
+    current = newState;
+    emit stateChanged(current);
+}
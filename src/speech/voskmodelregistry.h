@@ -0,0 +1,96 @@
+#ifndef VOSKMODELREGISTRY_H
+#define VOSKMODELREGISTRY_H
+
+#include <QtCore/qglobal.h>
+
+#ifndef SPEECH_EXPORT
+#ifdef SPEECH_LIBRARY
+#define SPEECH_EXPORT Q_DECL_EXPORT
+#else
+#define SPEECH_EXPORT Q_DECL_IMPORT
+#endif
+#endif
+
+#include <QObject>
+#include <QLibrary>
+#include <QSharedPointer>
+
+class QThread;
+
+// Vosk types
+typedef void* VoskModel;
+typedef void* VoskRecognizer;
+
+// 从libvosk解析出的函数，final_result可选
+struct VoskApi
+{
+    typedef VoskModel* (*model_new_func)(const char *model_path);
+    typedef void (*model_free_func)(VoskModel *model);
+    typedef VoskRecognizer* (*recognizer_new_func)(VoskModel *model, float sample_rate);
+    typedef void (*recognizer_free_func)(VoskRecognizer *recognizer);
+    typedef int (*accept_waveform_func)(VoskRecognizer *recognizer, const char *data, int length);
+    typedef const char* (*result_func)(VoskRecognizer *recognizer);
+
+    model_new_func model_new = nullptr;
+    model_free_func model_free = nullptr;
+    recognizer_new_func recognizer_new = nullptr;
+    recognizer_free_func recognizer_free = nullptr;
+    accept_waveform_func accept_waveform = nullptr;
+    result_func result = nullptr;
+    result_func partial_result = nullptr;
+    result_func final_result = nullptr;
+};
+
+// 进程内共享的Vosk模型
+// 库和模型在后台线程加载（模型1GB以上，需要数秒），GUI线程不阻塞；
+// 加载完成后各识别器通过model()取得同一个模型的共享引用，不重复加载。
+// 注册表自己也持有一份引用，unload()放开后，最后一个识别器释放时模型随之释放。
+// 只在GUI线程中调用，状态变化通过stateChanged发出。
+class SPEECH_EXPORT VoskModelRegistry : public QObject
+{
+    Q_OBJECT
+public:
+    enum State {
+        Unloaded, // 尚未加载或已经unload
+        Warming,  // 后台加载中
+        Ready,
+        Failed    // 库或模型加载失败，可再次preload重试
+    };
+    Q_ENUM(State)
+
+    static VoskModelRegistry *instance();
+
+    // 开始后台加载，加载中或已就绪时不做任何事
+    void preload();
+    // 放开注册表持有的引用，正在使用模型的识别器不受影响
+    void unload();
+
+    State state() const;
+    // 就绪时返回共享的模型，否则为空
+    QSharedPointer<VoskModel> model() const;
+    // 就绪后有效，库加载后不再卸载
+    const VoskApi &api() const;
+
+signals:
+    void stateChanged(VoskModelRegistry::State state);
+
+private slots:
+    void onLoaderFinished();
+
+private:
+    explicit VoskModelRegistry(QObject *parent = nullptr);
+    ~VoskModelRegistry();
+
+    void load(); // 在加载线程中运行
+    void setState(State newState);
+
+    State current;
+    QLibrary library;
+    VoskApi functions;      // 加载线程写入，线程结束后只读
+    bool libraryLoaded;
+    QThread *loader;
+    VoskModel *loadedModel; // 加载线程的结果，线程结束后由onLoaderFinished取走
+    QSharedPointer<VoskModel> shared;
+};
+
+#endif // VOSKMODELREGISTRY_H
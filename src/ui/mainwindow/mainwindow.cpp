@@ -93,6 +93,15 @@ MainWindow::MainWindow(QWidget *parent)
     connect(cameraButton, &QPushButton::clicked, this, &MainWindow::onCameraButtonClicked);
     controlsLayout->addWidget(cameraButton);
 
+    // 屏幕识别状态指示，画面中没有文字而暂停识别时显示
+    scanStatusLabel = new QLabel("⏸");
+    scanStatusLabel->setFixedSize(30, 30);
+    scanStatusLabel->setAlignment(Qt::AlignCenter);
+    scanStatusLabel->setStyleSheet("QLabel { border-radius: 15px; background-color: rgba(128,128,128,0.8); color: white; font-size: 16px; }");
+    scanStatusLabel->setToolTip("画面中没有文字，已暂停识别");
+    scanStatusLabel->hide();
+    controlsLayout->addWidget(scanStatusLabel);
+
     mainLayout->addWidget(controls, 0, Qt::AlignHCenter);
 
     // 下方空白区域 (减少权重)
@@ -106,6 +115,8 @@ MainWindow::MainWindow(QWidget *parent)
     // 初始化模块
     micLib = new SpeechModule(this);
     connect(micLib, &SpeechModule::textRecognized, this, &MainWindow::onTextRecognized);
+    connect(micLib, &SpeechModule::modelStateChanged, this, &MainWindow::onSpeechModelStateChanged);
+    onSpeechModelStateChanged(micLib->modelState());
 
     // 初始化悬浮显示库
     overlayLib = new OverlayModule(this);
@@ -116,6 +127,7 @@ MainWindow::MainWindow(QWidget *parent)
     // 初始化屏幕扫描库
     screenScanLib = new OCRModule(this);
     connect(screenScanLib, &OCRModule::textRecognized, overlayLib, &OverlayModule::showText);
+    connect(screenScanLib, &OCRModule::recognitionPausedChanged, this, &MainWindow::onScanPausedChanged);
 
     // 初始化动画库
     animationLib = new AnimationLib(this);
@@ -244,3 +256,31 @@ void MainWindow::onTextRecognized(const QString &text)
     QString current = inputEdit->toPlainText();
     inputEdit->setPlainText(current + text);
 }
+
+void MainWindow::onSpeechModelStateChanged(VoskModelRegistry::State state)
+{
+    // 模型在后台加载期间麦克风按钮显示预热中，加载失败时点击会重新加载
+    switch (state) {
+    case VoskModelRegistry::Warming:
+        micButton->setEnabled(false);
+        micButton->setText("⏳");
+        micButton->setToolTip("语音模型预热中...");
+        break;
+    case VoskModelRegistry::Failed:
+        micButton->setEnabled(true);
+        micButton->setText("🎤");
+        micButton->setToolTip("语音模型加载失败，点击重试");
+        break;
+    default:
+        micButton->setEnabled(true);
+        micButton->setText("🎤");
+        micButton->setToolTip(QString());
+        break;
+    }
+}
+
+void MainWindow::onScanPausedChanged(bool paused)
+{
+    // 视频、游戏等画面不识别，用工具栏上的指示提示扫描已暂停，不占用识别结果的悬浮显示
+    scanStatusLabel->setVisible(paused);
+}
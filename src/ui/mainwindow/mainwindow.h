@@ -6,6 +6,7 @@
 #include <QHBoxLayout>
 #include <QTextEdit>
 #include <QPushButton>
+#include <QLabel>
 #include <QCamera>
 #include <QMediaCaptureSession>
 #include <QVideoWidget>
@@ -34,6 +35,8 @@ private slots:
     void onSendButtonClicked();
     void onCloseMicButtonClicked();
     void onTextRecognized(const QString &text);
+    void onScanPausedChanged(bool paused);
+    void onSpeechModelStateChanged(VoskModelRegistry::State state);
 
 protected:
     void mousePressEvent(QMouseEvent *event) override;
@@ -48,6 +51,7 @@ private:
     QPushButton *sendButton;
     QPushButton *closeButton;
     QPushButton *cameraButton;
+    QLabel *scanStatusLabel;
     QCamera *camera;
     QMediaCaptureSession *captureSession;
     QVideoWidget *videoWidget;
@@ -0,0 +1,140 @@
+#include <QtTest/QtTest>
+#include <QElapsedTimer>
+#include <QImage>
+#include <functional>
+#include "ocr/imagekernels.h"
+
+class BenchmarkImageKernels : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void benchmarkToGray_data();
+    void benchmarkToGray();
+    void benchmarkDownscale_data();
+    void benchmarkDownscale();
+    void benchmarkOtsu_data();
+    void benchmarkOtsu();
+    void benchmarkSauvola();
+
+private:
+    void addLevels();
+    double measureMBps(qint64 bytesPerRun, const std::function<void()> &kernel) const;
+
+    QImage m_frame; // 3840x2160 ARGB32，模拟4K屏幕截图
+    QImage m_gray;
+};
+
+void BenchmarkImageKernels::initTestCase() {
+    m_frame = QImage(3840, 2160, QImage::Format_ARGB32);
+    for (int y = 0; y < m_frame.height(); ++y) {
+        QRgb *row = reinterpret_cast<QRgb*>(m_frame.scanLine(y));
+        for (int x = 0; x < m_frame.width(); ++x) {
+            row[x] = qRgb((x * 7 + y) & 0xFF, (x + y * 3) & 0xFF, (x ^ y) & 0xFF);
+        }
+    }
+    m_gray = ImageKernels::toGray(m_frame);
+    qDebug() << "Detected SIMD level:" << ImageKernels::detectedLevel();
+}
+
+void BenchmarkImageKernels::cleanupTestCase() {
+    ImageKernels::setMaxLevel(ImageKernels::AVX2);
+}
+
+void BenchmarkImageKernels::addLevels() {
+    QTest::addColumn<int>("level");
+    QTest::newRow("scalar") << int(ImageKernels::Scalar);
+    if (ImageKernels::detectedLevel() >= ImageKernels::SSE2) {
+        QTest::newRow("sse2") << int(ImageKernels::SSE2);
+    }
+    if (ImageKernels::detectedLevel() >= ImageKernels::AVX2) {
+        QTest::newRow("avx2") << int(ImageKernels::AVX2);
+    }
+}
+
+double BenchmarkImageKernels::measureMBps(qint64 bytesPerRun, const std::function<void()> &kernel) const {
+    const int runs = 20;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < runs; ++i) {
+        kernel();
+    }
+    const double seconds = timer.nsecsElapsed() / 1e9;
+    return seconds > 0.0 ? (double(bytesPerRun) * runs / (1024.0 * 1024.0)) / seconds : 0.0;
+}
+
+void BenchmarkImageKernels::benchmarkToGray_data() {
+    addLevels();
+}
+
+void BenchmarkImageKernels::benchmarkToGray() {
+    QFETCH(int, level);
+
+    // 所有实现的结果必须一致
+    ImageKernels::setMaxLevel(ImageKernels::Scalar);
+    QImage reference = ImageKernels::toGray(m_frame);
+    ImageKernels::setMaxLevel(ImageKernels::SimdLevel(level));
+    QCOMPARE(ImageKernels::toGray(m_frame), reference);
+
+    double mbps = measureMBps(m_frame.sizeInBytes(), [this]() { ImageKernels::toGray(m_frame); });
+    qDebug() << "toGray MB/s:" << mbps;
+
+    QBENCHMARK {
+        ImageKernels::toGray(m_frame);
+    }
+}
+
+void BenchmarkImageKernels::benchmarkDownscale_data() {
+    addLevels();
+}
+
+void BenchmarkImageKernels::benchmarkDownscale() {
+    QFETCH(int, level);
+
+    // 所有实现的结果必须与标量逐像素一致
+    ImageKernels::setMaxLevel(ImageKernels::Scalar);
+    QImage reference = ImageKernels::downscale(m_gray, 2);
+    QCOMPARE(reference.size(), QSize(1920, 1080));
+    ImageKernels::setMaxLevel(ImageKernels::SimdLevel(level));
+    QCOMPARE(ImageKernels::downscale(m_gray, 2), reference);
+
+    double mbps = measureMBps(m_gray.sizeInBytes(), [this]() { ImageKernels::downscale(m_gray, 2); });
+    qDebug() << "downscale x2 MB/s:" << mbps;
+
+    QBENCHMARK {
+        ImageKernels::downscale(m_gray, 2);
+    }
+}
+
+void BenchmarkImageKernels::benchmarkOtsu_data() {
+    addLevels();
+}
+
+void BenchmarkImageKernels::benchmarkOtsu() {
+    QFETCH(int, level);
+    ImageKernels::setMaxLevel(ImageKernels::SimdLevel(level));
+
+    double mbps = measureMBps(m_gray.sizeInBytes(), [this]() {
+        ImageKernels::binarize(m_gray, ImageKernels::OtsuBinarization);
+    });
+    qDebug() << "Otsu binarize MB/s:" << mbps;
+
+    QBENCHMARK {
+        ImageKernels::binarize(m_gray, ImageKernels::OtsuBinarization);
+    }
+}
+
+void BenchmarkImageKernels::benchmarkSauvola() {
+    // Sauvola使用滑动窗口和，只有标量实现
+    double mbps = measureMBps(m_gray.sizeInBytes(), [this]() { ImageKernels::sauvola(m_gray); });
+    qDebug() << "Sauvola binarize MB/s:" << mbps;
+
+    QBENCHMARK {
+        ImageKernels::sauvola(m_gray);
+    }
+}
+
+QTEST_MAIN(BenchmarkImageKernels)
+#include "BenchmarkImageKernels.moc"
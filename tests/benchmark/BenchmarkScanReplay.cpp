@@ -0,0 +1,133 @@
+#include <QtTest/QtTest>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QPainter>
+#include <QTemporaryDir>
+#include "ocr/framerecording.h"
+#include "ocr/scanpipeline.h"
+
+// 回放录制帧测量识别流水线的吞吐量和延迟，不依赖真实屏幕。
+// 设置环境变量OCR_REPLAY_FILE可回放实际录制的文件，否则生成一段滚动文档的合成录像。
+class BenchmarkScanReplay : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testRecordingRoundTrip();
+    void benchmarkReplayAsFastAsPossible();
+    void benchmarkReplayOriginalCadence();
+    void benchmarkReplayCoarseToFine();
+
+private:
+    QImage renderFrame(int index) const;
+
+    QTemporaryDir m_dir;
+    QString m_path;
+    FrameReplaySource m_replay;
+};
+
+QImage BenchmarkScanReplay::renderFrame(int index) const {
+    // 每帧向上滚动8像素，模拟阅读长文档
+    QImage image(1280, 720, QImage::Format_Grayscale8);
+    image.fill(Qt::white);
+    QPainter painter(&image);
+    painter.setPen(Qt::black);
+    painter.setFont(QFont("Sans", 14));
+    const int lineHeight = 28;
+    const int scroll = index * 8;
+    for (int line = scroll / lineHeight; line * lineHeight - scroll < image.height(); ++line) {
+        painter.drawText(40, line * lineHeight - scroll + lineHeight,
+                         QString("Line %1: The quick brown fox jumps over the lazy dog").arg(line));
+    }
+    return image;
+}
+
+void BenchmarkScanReplay::initTestCase() {
+    m_path = qEnvironmentVariable("OCR_REPLAY_FILE");
+    if (m_path.isEmpty()) {
+        QVERIFY(m_dir.isValid());
+        m_path = m_dir.filePath("scroll.frames");
+
+        FrameRecorder recorder;
+        QVERIFY(recorder.open(m_path));
+        for (int i = 0; i < 60; ++i) {
+            QVERIFY(recorder.append(renderFrame(i), i * 33)); // 约30帧每秒
+        }
+        recorder.close();
+    }
+
+    QVERIFY2(m_replay.open(m_path), qPrintable(m_replay.errorString()));
+    qDebug() << "Replaying" << m_replay.frameCount() << "frames of" << m_replay.frameSize() << "from" << m_path;
+}
+
+void BenchmarkScanReplay::cleanupTestCase() {
+    m_replay.close();
+}
+
+void BenchmarkScanReplay::testRecordingRoundTrip() {
+    if (!qEnvironmentVariableIsEmpty("OCR_REPLAY_FILE")) {
+        QSKIP("Round trip only checked for the synthetic recording");
+    }
+    QCOMPARE(m_replay.frameCount(), 60);
+    QCOMPARE(m_replay.format(), QImage::Format_Grayscale8);
+    QCOMPARE(m_replay.timestamp(10), qint64(330));
+    QCOMPARE(m_replay.frame(10), renderFrame(10));
+}
+
+void BenchmarkScanReplay::benchmarkReplayAsFastAsPossible() {
+    ScanPipeline pipeline;
+    pipeline.start();
+
+    QElapsedTimer timer;
+    timer.start();
+    const int submitted = m_replay.replay(&pipeline, FrameReplaySource::AsFastAsPossible);
+    const qint64 elapsed = timer.elapsed();
+    pipeline.stop();
+
+    // 全速回放不丢帧，结果可重复
+    QCOMPARE(submitted, m_replay.frameCount());
+    QCOMPARE(pipeline.processedFrames(), quint64(submitted));
+    qDebug() << "Throughput:" << (elapsed > 0 ? submitted * 1000.0 / elapsed : 0.0) << "frames/s"
+             << "last latency:" << pipeline.lastLatency() << "ms"
+             << "cache hit rate:" << pipeline.cacheHitRate();
+}
+
+void BenchmarkScanReplay::benchmarkReplayOriginalCadence() {
+    ScanPipeline pipeline;
+    pipeline.start();
+
+    QElapsedTimer timer;
+    timer.start();
+    const int submitted = m_replay.replay(&pipeline, FrameReplaySource::OriginalCadence);
+    const qint64 elapsed = timer.elapsed();
+    pipeline.stop();
+
+    // 按原始节奏回放时与实时采集一样，处理不过来的帧被丢弃
+    QCOMPARE(pipeline.processedFrames() + pipeline.droppedFrames(), quint64(submitted));
+    QVERIFY(elapsed >= m_replay.timestamp(m_replay.frameCount() - 1) - m_replay.timestamp(0));
+    qDebug() << "Processed" << pipeline.processedFrames() << "dropped" << pipeline.droppedFrames()
+             << "last latency:" << pipeline.lastLatency() << "ms";
+}
+
+void BenchmarkScanReplay::benchmarkReplayCoarseToFine() {
+    // 按2倍降采样识别，低置信度区域用原始分辨率重新识别
+    ScanPipeline pipeline;
+    pipeline.setDownscaleFactor(2);
+    pipeline.start();
+
+    QElapsedTimer timer;
+    timer.start();
+    const int submitted = m_replay.replay(&pipeline, FrameReplaySource::AsFastAsPossible);
+    const qint64 elapsed = timer.elapsed();
+    pipeline.stop();
+
+    QCOMPARE(pipeline.processedFrames(), quint64(submitted));
+    QVERIFY(pipeline.refinedPixels() <= pipeline.scannedPixels());
+    qDebug() << "Throughput:" << (elapsed > 0 ? submitted * 1000.0 / elapsed : 0.0) << "frames/s"
+             << "full-resolution area:" << pipeline.refinedAreaRatio() * 100.0 << "%";
+}
+
+QTEST_MAIN(BenchmarkScanReplay)
+#include "BenchmarkScanReplay.moc"
@@ -0,0 +1,62 @@
+#include <QtTest/QtTest>
+#include <QElapsedTimer>
+#include "ocr/screenhistoryindex.h"
+
+// 模拟数小时的屏幕文字历史：每秒若干区域变化，文字有大量重复（菜单、标题栏）
+class BenchmarkScreenHistory : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void benchmarkSearch();
+
+private:
+    static QString lineText(int index);
+    void fill(ScreenHistoryIndex &index, int seconds, qint64 start) const;
+};
+
+QString BenchmarkScreenHistory::lineText(int index) {
+    // 一半是常见的重复文字，一半是只出现一次的内容
+    if (index % 2 == 0) {
+        return QString("文件 编辑 视图 窗口 帮助 菜单%1").arg(index % 40);
+    }
+    return QString("第%1段 屏幕文字识别 The quick brown fox %2 jumps over the lazy dog").arg(index).arg(index * 7919 % 100003);
+}
+
+void BenchmarkScreenHistory::fill(ScreenHistoryIndex &index, int seconds, qint64 start) const {
+    int line = 0;
+    for (int second = 0; second < seconds; ++second) {
+        const qint64 timestamp = start + qint64(second) * 1000;
+        for (int block = 0; block < 5; ++block, ++line) {
+            const quint64 key = quint64(block) + 1;
+            index.addBlock(key, lineText(line), 0, QRect(0, block * 30, 800, 24), timestamp);
+        }
+    }
+}
+
+void BenchmarkScreenHistory::initTestCase() {
+    QVERIFY(!lineText(1).isEmpty());
+}
+
+void BenchmarkScreenHistory::benchmarkSearch() {
+    // 3小时，每秒5个区域
+    ScreenHistoryIndex index(256 * 1024 * 1024);
+    QElapsedTimer timer;
+    timer.start();
+    fill(index, 3 * 3600, 0);
+    qDebug() << "Indexed" << index.occurrenceCount() << "occurrences in" << timer.elapsed() << "ms,"
+             << index.usedBytes() / 1024 << "KB";
+
+    timer.restart();
+    const QVector<ScreenHistoryHit> hits = index.search("jumps over", 20);
+    qDebug() << "Query latency (ms):" << timer.elapsed();
+    QCOMPARE(hits.size(), 20);
+
+    QBENCHMARK {
+        index.search("屏幕文字", 20);
+    }
+}
+
+QTEST_MAIN(BenchmarkScreenHistory)
+#include "BenchmarkScreenHistory.moc"
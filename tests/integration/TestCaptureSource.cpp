@@ -0,0 +1,120 @@
+#include <QtTest/QtTest>
+#include <QGuiApplication>
+#include <QScreen>
+#include <QSignalSpy>
+#include <QWidget>
+#include "ocr/capturesource.h"
+
+// 截图后端测试
+// 无显示器的构建机上可以用Xvfb运行：xvfb-run -s "-screen 0 1280x720x24" ./integration_tests
+// 缩放比例不为1的换算：QT_SCALE_FACTOR=2 xvfb-run -s "-screen 0 1280x720x24" ./integration_tests testScaledGrab
+class TestCaptureSource : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void testGrabRegion();
+    void testForcedFallback();
+    void testDamageNotification();
+    void testScaledGrab();
+
+private:
+    QScreen* m_screen = nullptr;
+};
+
+void TestCaptureSource::initTestCase() {
+    m_screen = QGuiApplication::primaryScreen();
+    if (!m_screen) {
+        QSKIP("No screen available");
+    }
+    qDebug() << "Platform:" << QGuiApplication::platformName();
+}
+
+void TestCaptureSource::testGrabRegion() {
+    CaptureSource* source = CaptureSource::create(m_screen);
+    qDebug() << "Capture backend:" << source->name();
+
+    QImage image = source->grab(QRect(10, 20, 64, 32));
+    QVERIFY(!image.isNull());
+    QCOMPARE(image.size(), QSize(64, 32) * m_screen->devicePixelRatio());
+
+    delete source;
+}
+
+void TestCaptureSource::testForcedFallback() {
+    qputenv("OCR_CAPTURE_BACKEND", "grab");
+    CaptureSource* source = CaptureSource::create(m_screen);
+    qunsetenv("OCR_CAPTURE_BACKEND");
+
+    QCOMPARE(source->name(), QString("grab"));
+    QVERIFY(!source->isEventDriven());
+    delete source;
+}
+
+void TestCaptureSource::testDamageNotification() {
+    CaptureSource* source = CaptureSource::create(m_screen);
+    if (!source->isEventDriven()) {
+        delete source;
+        QSKIP("Capture backend does not report damage");
+    }
+
+    QSignalSpy spy(source, &CaptureSource::damaged);
+
+    QWidget widget;
+    widget.setGeometry(QRect(m_screen->geometry().topLeft() + QPoint(50, 50), QSize(200, 100)));
+    widget.setStyleSheet("background: red;");
+    widget.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&widget));
+
+    // 窗口的绘制会在根窗口上产生变化
+    QVERIFY(spy.count() > 0 || spy.wait(2000));
+
+    const QRect windowRect = widget.frameGeometry().translated(-m_screen->geometry().topLeft());
+    bool hit = false;
+    for (const QList<QVariant>& arguments : spy) {
+        hit = hit || arguments.at(0).toRect().intersects(windowRect);
+    }
+    QVERIFY(hit);
+
+    // 变化通知不应影响截图本身
+    QImage image = source->grab(windowRect);
+    QVERIFY(!image.isNull());
+
+    delete source;
+}
+
+void TestCaptureSource::testScaledGrab() {
+    if (qFuzzyCompare(m_screen->devicePixelRatio(), 1.0)) {
+        QSKIP("Device pixel ratio is 1, run with QT_SCALE_FACTOR=2");
+    }
+
+    // 每个屏幕上放一个红色窗口，按逻辑坐标截取同一区域，应该正好落在窗口内
+    const QRect local(40, 30, 120, 60);
+    for (QScreen* screen : QGuiApplication::screens()) {
+        QWidget widget(nullptr, Qt::FramelessWindowHint | Qt::X11BypassWindowManagerHint);
+        widget.setGeometry(local.translated(screen->geometry().topLeft()));
+        widget.setStyleSheet("background: red;");
+        widget.show();
+        QVERIFY(QTest::qWaitForWindowExposed(&widget));
+        QTest::qWait(100);
+
+        CaptureSource* source = CaptureSource::create(screen);
+        const QImage image = source->grab(local).convertToFormat(QImage::Format_RGB32);
+        delete source;
+
+        QVERIFY(!image.isNull());
+        QCOMPARE(image.size(), local.size() * screen->devicePixelRatio());
+        // 边缘可能有一个设备像素的舍入，向内取样
+        const QRect inner = image.rect().adjusted(2, 2, -2, -2);
+        for (const QPoint& point : {inner.topLeft(), inner.topRight(), inner.bottomLeft(), inner.bottomRight(), inner.center()}) {
+            const QRgb pixel = image.pixel(point);
+            QVERIFY2(qRed(pixel) > 200 && qGreen(pixel) < 60 && qBlue(pixel) < 60,
+                     qPrintable(QString("%1 at (%2,%3) is #%4").arg(screen->name()).arg(point.x()).arg(point.y())
+                                    .arg(pixel & 0xFFFFFF, 6, 16, QChar('0'))));
+        }
+    }
+}
+
+QTEST_MAIN(TestCaptureSource)
+#include "TestCaptureSource.moc"
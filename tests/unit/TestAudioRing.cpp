@@ -0,0 +1,121 @@
+#include <QtTest/QtTest>
+#include <QThread>
+#include "speech/audioring.h"
+
+// 采集环形缓冲区：回绕、溢出计数、奇数字节拼接和单生产者单消费者并发
+class TestAudioRing : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testWrapAround();
+    void testOverflowAccounting();
+    void testSinkJoinsSplitSamples();
+    void testConcurrentProducerConsumer();
+};
+
+void TestAudioRing::testWrapAround() {
+    AudioRing ring(8);
+    QCOMPARE(ring.capacity(), 8);
+
+    qint16 in[6] = {1, 2, 3, 4, 5, 6};
+    qint16 out[8] = {0};
+    QCOMPARE(ring.write(in, 6), 6);
+    QCOMPARE(ring.read(out, 4), 4);
+    // 写位置越过环尾
+    QCOMPARE(ring.write(in, 6), 6);
+    QCOMPARE(ring.available(), 8);
+    QCOMPARE(ring.read(out, 8), 8);
+    const qint16 expected[8] = {5, 6, 1, 2, 3, 4, 5, 6};
+    for (int i = 0; i < 8; ++i) {
+        QCOMPARE(out[i], expected[i]);
+    }
+    QCOMPARE(ring.available(), 0);
+}
+
+void TestAudioRing::testOverflowAccounting() {
+    AudioRing ring(4);
+    qint16 in[6] = {1, 2, 3, 4, 5, 6};
+    // 放不下的新采样被丢弃，已有数据不受影响
+    QCOMPARE(ring.write(in, 6), 4);
+    QCOMPARE(ring.overflowSamples(), qint64(2));
+    QCOMPARE(ring.totalSamples(), qint64(6));
+
+    qint16 out[4] = {0};
+    QCOMPARE(ring.read(out, 4), 4);
+    QCOMPARE(out[0], qint16(1));
+    QCOMPARE(out[3], qint16(4));
+
+    ring.reset();
+    QCOMPARE(ring.overflowSamples(), qint64(0));
+    QCOMPARE(ring.available(), 0);
+}
+
+void TestAudioRing::testSinkJoinsSplitSamples() {
+    AudioRing ring(16);
+    AudioRingSink sink(&ring);
+    QVERIFY(sink.open(QIODevice::WriteOnly));
+    QSignalSpy written(&sink, &AudioRingSink::samplesWritten);
+
+    const qint16 samples[3] = {0x1234, -2, 300};
+    const char *bytes = reinterpret_cast<const char *>(samples);
+    // 3 + 3字节：中间的采样跨两次写入
+    QCOMPARE(sink.write(bytes, 3), qint64(3));
+    QCOMPARE(ring.available(), 1);
+    QCOMPARE(sink.write(bytes + 3, 3), qint64(3));
+    QCOMPARE(ring.available(), 3);
+    QCOMPARE(written.count(), 2);
+
+    qint16 out[3] = {0};
+    QCOMPARE(ring.read(out, 3), 3);
+    QCOMPARE(out[0], samples[0]);
+    QCOMPARE(out[1], samples[1]);
+    QCOMPARE(out[2], samples[2]);
+}
+
+void TestAudioRing::testConcurrentProducerConsumer() {
+    AudioRing ring(1024);
+    const int total = 200000;
+
+    QThread *producer = QThread::create([&ring]() {
+        qint16 block[160];
+        int next = 0;
+        while (next < total) {
+            const int count = qMin(160, total - next);
+            for (int i = 0; i < count; ++i) {
+                block[i] = qint16(next + i);
+            }
+            // 写不下时重试剩余部分，测试中不允许丢弃
+            int done = 0;
+            while (done < count) {
+                const int free = ring.capacity() - ring.available();
+                if (free == 0) {
+                    QThread::yieldCurrentThread();
+                    continue;
+                }
+                done += ring.write(block + done, qMin(free, count - done));
+            }
+            next += count;
+        }
+    });
+    producer->start();
+
+    qint16 out[256];
+    int received = 0;
+    bool ordered = true;
+    while (received < total) {
+        const int n = ring.read(out, 256);
+        for (int i = 0; i < n; ++i) {
+            ordered = ordered && out[i] == qint16(received + i);
+        }
+        received += n;
+        if (n == 0) QThread::yieldCurrentThread();
+    }
+    producer->wait();
+    delete producer;
+
+    QVERIFY(ordered);
+    QCOMPARE(ring.overflowSamples(), qint64(0));
+}
+
+QTEST_MAIN(TestAudioRing)
+#include "TestAudioRing.moc"
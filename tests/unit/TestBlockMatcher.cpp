@@ -0,0 +1,116 @@
+#include <QtTest/QtTest>
+#include "ocr/blockmatcher.h"
+
+// 连续帧之间文字区域的对应：原位复用、滚动平移、拆分合并后的编号、增删改
+class TestBlockMatcher : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testReuseSamePosition();
+    void testScrollShift();
+    void testEditedBlockKeepsId();
+    void testSplitKeepsIdForLargerPart();
+    void testMergeKeepsOneId();
+    void testUsedIdNotTakenTwice();
+    void testDiff();
+
+private:
+    static OCRTextBlock block(const QRect &rect, const QString &text, quint64 id = 0);
+};
+
+OCRTextBlock TestBlockMatcher::block(const QRect &rect, const QString &text, quint64 id) {
+    OCRTextBlock b;
+    b.rect = rect;
+    b.text = text;
+    b.id = id;
+    return b;
+}
+
+void TestBlockMatcher::testReuseSamePosition() {
+    const QVector<OCRTextBlock> previous = {block(QRect(0, 0, 100, 20), "a", 1), block(QRect(0, 40, 100, 20), "b", 2)};
+    QCOMPARE(BlockMatcher::findSame(previous, QRect(0, 40, 100, 20)), 1);
+    QCOMPARE(BlockMatcher::findSame(previous, QRect(0, 41, 100, 20)), -1);
+}
+
+void TestBlockMatcher::testScrollShift() {
+    const QRect scrollRegion(0, 0, 400, 400);
+    const QVector<OCRTextBlock> previous = {block(QRect(10, 100, 200, 20), "a", 1), block(QRect(10, 200, 200, 20), "b", 2)};
+    // 向上滚动30像素，检测框取整误差在tolerance以内
+    const QPoint offset(0, -30);
+    QCOMPARE(BlockMatcher::findShifted(previous, QRect(10, 170, 200, 20), scrollRegion, offset, 2), 1);
+    QCOMPARE(BlockMatcher::findShifted(previous, QRect(11, 69, 200, 21), scrollRegion, offset, 2), 0);
+    // 超出误差或不在滚动区域内的不对应
+    QCOMPARE(BlockMatcher::findShifted(previous, QRect(10, 75, 200, 20), scrollRegion, offset, 2), -1);
+    QCOMPARE(BlockMatcher::findShifted(previous, QRect(10, 70, 200, 20), QRect(0, 0, 400, 110), offset, 2), -1);
+}
+
+void TestBlockMatcher::testEditedBlockKeepsId() {
+    const QVector<OCRTextBlock> previous = {block(QRect(0, 0, 200, 20), "hello", 7)};
+    // 输入文字后区域变宽，重叠足够多时沿用编号
+    QVector<OCRTextBlock> next = {block(QRect(0, 0, 240, 20), "hello world")};
+    BlockMatcher::assignIds(next, previous);
+    QCOMPARE(next[0].id, quint64(7));
+
+    // 重叠太少时是新区域
+    next = {block(QRect(150, 0, 200, 20), "other")};
+    BlockMatcher::assignIds(next, previous);
+    QVERIFY(next[0].id != 0);
+    QVERIFY(next[0].id != 7);
+}
+
+void TestBlockMatcher::testSplitKeepsIdForLargerPart() {
+    const QVector<OCRTextBlock> previous = {block(QRect(0, 0, 200, 40), "two lines", 7)};
+    QVector<OCRTextBlock> next = {block(QRect(0, 30, 200, 10), "lines"), block(QRect(0, 0, 200, 30), "two")};
+    BlockMatcher::assignIds(next, previous);
+    QCOMPARE(next[1].id, quint64(7));
+    QVERIFY(next[0].id != 0);
+    QVERIFY(next[0].id != 7);
+
+    const OCRTextDelta delta = BlockMatcher::diff(previous, next);
+    QCOMPARE(delta.changed.size(), 1);
+    QCOMPARE(delta.changed[0].id, quint64(7));
+    QCOMPARE(delta.added.size(), 1);
+    QCOMPARE(delta.added[0].id, next[0].id);
+    QVERIFY(delta.removed.isEmpty());
+}
+
+void TestBlockMatcher::testMergeKeepsOneId() {
+    const QVector<OCRTextBlock> previous = {block(QRect(0, 0, 200, 30), "first", 1), block(QRect(0, 30, 200, 10), "second", 2)};
+    QVector<OCRTextBlock> next = {block(QRect(0, 0, 200, 40), "first second")};
+    BlockMatcher::assignIds(next, previous);
+    QCOMPARE(next[0].id, quint64(1));
+
+    const OCRTextDelta delta = BlockMatcher::diff(previous, next);
+    QCOMPARE(delta.changed.size(), 1);
+    QVERIFY(delta.added.isEmpty());
+    QCOMPARE(delta.removed, QVector<quint64>({2}));
+}
+
+void TestBlockMatcher::testUsedIdNotTakenTwice() {
+    const QVector<OCRTextBlock> previous = {block(QRect(0, 0, 200, 20), "a", 5)};
+    // 第一个区域已经原位复用了编号5，与它重叠的新区域不能再用
+    QVector<OCRTextBlock> next = {block(QRect(0, 2, 200, 20), "b"), block(QRect(0, 0, 200, 20), "a", 5)};
+    BlockMatcher::assignIds(next, previous);
+    QCOMPARE(next[1].id, quint64(5));
+    QVERIFY(next[0].id != 0);
+    QVERIFY(next[0].id != 5);
+}
+
+void TestBlockMatcher::testDiff() {
+    const QVector<OCRTextBlock> previous = {block(QRect(0, 0, 100, 20), "same", 1), block(QRect(0, 30, 100, 20), "old", 2),
+                                            block(QRect(0, 60, 100, 20), "moved", 3), block(QRect(0, 90, 100, 20), "gone", 4)};
+    const QVector<OCRTextBlock> current = {block(QRect(0, 0, 100, 20), "same", 1), block(QRect(0, 30, 100, 20), "new", 2),
+                                           block(QRect(0, 70, 100, 20), "moved", 3), block(QRect(0, 120, 100, 20), "fresh", 9)};
+    const OCRTextDelta delta = BlockMatcher::diff(previous, current);
+    QCOMPARE(delta.changed.size(), 2);
+    QCOMPARE(delta.changed[0].id, quint64(2));
+    QCOMPARE(delta.changed[1].id, quint64(3));
+    QCOMPARE(delta.added.size(), 1);
+    QCOMPARE(delta.added[0].text, QString("fresh"));
+    QCOMPARE(delta.removed, QVector<quint64>({4}));
+
+    QVERIFY(BlockMatcher::diff(current, current).isEmpty());
+}
+
+QTEST_MAIN(TestBlockMatcher)
+#include "TestBlockMatcher.moc"
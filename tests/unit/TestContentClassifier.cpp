@@ -0,0 +1,101 @@
+#include <QtTest/QtTest>
+#include <QImage>
+#include <QRandomGenerator>
+#include "ocr/contentclassifier.h"
+
+// 画面内容分类：文字截图、噪声/照片画面、每帧都变化的画面
+class TestContentClassifier : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testTextScreenshot();
+    void testScrollingTextStaysText();
+    void testNoisyFrameIsNonText();
+    void testChangingFrameIsMotion();
+    void testResetDropsReference();
+
+private:
+    static QImage textScreenshot(int scroll);
+    static QImage noise(quint32 seed);
+};
+
+// 640x360白底黑字：每行若干6x10的“字形”，字间距2、词间距8，行高16
+QImage TestContentClassifier::textScreenshot(int scroll) {
+    QImage image(640, 360, QImage::Format_RGB32);
+    image.fill(Qt::white);
+    for (int top = 8 - scroll % 16; top < image.height(); top += 16) {
+        for (int x = 12, glyph = 0; x + 6 < image.width() - 12; x += glyph % 5 == 4 ? 14 : 8, ++glyph) {
+            for (int y = qMax(0, top); y < qMin(image.height(), top + 10); ++y) {
+                QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+                for (int dx = 0; dx < 6; ++dx) {
+                    line[x + dx] = qRgb(0, 0, 0);
+                }
+            }
+        }
+    }
+    return image;
+}
+
+// 每个像素随机颜色，颜色熵接近上限，边缘方向均匀分布
+QImage TestContentClassifier::noise(quint32 seed) {
+    QRandomGenerator random(seed);
+    QImage image(640, 360, QImage::Format_RGB32);
+    for (int y = 0; y < image.height(); ++y) {
+        QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+        for (int x = 0; x < image.width(); ++x) {
+            line[x] = 0xFF000000u | (random.generate() & 0xFFFFFFu);
+        }
+    }
+    return image;
+}
+
+void TestContentClassifier::testTextScreenshot() {
+    ContentClassifier classifier;
+    QCOMPARE(classifier.classify(textScreenshot(0)), ContentClassifier::Text);
+    const ContentClassifier::Features features = classifier.lastFeatures();
+    QVERIFY(features.colorEntropy < 2.0);
+    QVERIFY(features.axisEdgeRatio > 0.6);
+    QCOMPARE(features.changeRatio, 0.0);
+}
+
+void TestContentClassifier::testScrollingTextStaysText() {
+    // 滚动时整帧都在变，但颜色少，仍按文字识别
+    ContentClassifier classifier;
+    for (int tick = 0; tick < 5; ++tick) {
+        QCOMPARE(classifier.classify(textScreenshot(tick * 5)), ContentClassifier::Text);
+    }
+    QVERIFY(classifier.lastFeatures().changeRatio > 0.0);
+}
+
+void TestContentClassifier::testNoisyFrameIsNonText() {
+    ContentClassifier classifier;
+    const QImage frame = noise(1);
+    QCOMPARE(classifier.classify(frame), ContentClassifier::NonText);
+    // 静止不动时不算Motion
+    QCOMPARE(classifier.classify(frame), ContentClassifier::NonText);
+    const ContentClassifier::Features features = classifier.lastFeatures();
+    QVERIFY(features.colorEntropy > 10.0);
+    QVERIFY(features.axisEdgeRatio < 0.45);
+    QCOMPARE(features.changeRatio, 0.0);
+}
+
+void TestContentClassifier::testChangingFrameIsMotion() {
+    ContentClassifier classifier;
+    // 第一帧没有参考帧，按静态画面判断
+    QCOMPARE(classifier.classify(noise(1)), ContentClassifier::NonText);
+    for (quint32 tick = 2; tick < 6; ++tick) {
+        QCOMPARE(classifier.classify(noise(tick)), ContentClassifier::Motion);
+        QVERIFY(classifier.lastFeatures().changeRatio >= 0.3);
+    }
+}
+
+void TestContentClassifier::testResetDropsReference() {
+    ContentClassifier classifier;
+    classifier.classify(noise(1));
+    classifier.reset();
+    QCOMPARE(classifier.classify(noise(2)), ContentClassifier::NonText);
+    QCOMPARE(classifier.lastFeatures().changeRatio, 0.0);
+}
+
+QTEST_MAIN(TestContentClassifier)
+#include "TestContentClassifier.moc"
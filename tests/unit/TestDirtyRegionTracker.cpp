@@ -0,0 +1,129 @@
+#include <QtTest/QtTest>
+#include <QImage>
+#include "ocr/dirtyregiontracker.h"
+
+// 分块哈希脏区域：未变化、单个瓦片变化、跨瓦片行的文字行、缓存文字的复用和作废
+class TestDirtyRegionTracker : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testFirstFrameIsAllDirty();
+    void testUnchangedFrameHasNoDirtyRegion();
+    void testSingleTileChange();
+    void testLineAcrossTileRowsStaysWhole();
+    void testTexturedGradientBackground();
+    void testCachedTextReuseAndInvalidation();
+
+private:
+    static QImage blank();
+    static QImage texturedGradient();
+    static void fill(QImage &image, const QRect &rect, uchar value);
+};
+
+// 512x128，默认瓦片128x32，共4x4个瓦片
+QImage TestDirtyRegionTracker::blank() {
+    QImage image(512, 128, QImage::Format_Grayscale8);
+    image.fill(255);
+    return image;
+}
+
+// 斜向渐变叠加细纹理，相邻像素最多相差9
+QImage TestDirtyRegionTracker::texturedGradient() {
+    QImage image(512, 128, QImage::Format_Grayscale8);
+    for (int y = 0; y < image.height(); ++y) {
+        uchar *line = image.scanLine(y);
+        for (int x = 0; x < image.width(); ++x) {
+            line[x] = uchar(40 + x / 4 + y / 4 + (x * 7 + y * 13) % 9);
+        }
+    }
+    return image;
+}
+
+void TestDirtyRegionTracker::fill(QImage &image, const QRect &rect, uchar value) {
+    for (int y = rect.top(); y <= rect.bottom(); ++y) {
+        memset(image.scanLine(y) + rect.left(), value, size_t(rect.width()));
+    }
+}
+
+void TestDirtyRegionTracker::testFirstFrameIsAllDirty() {
+    DirtyRegionTracker tracker;
+    const QVector<QRect> regions = tracker.update(blank());
+    QCOMPARE(tracker.tileCount(), 16);
+    QCOMPARE(tracker.dirtyTileCount(), 16);
+    // 纯色画面没有墨迹跨过瓦片行边界，每个瓦片行一块
+    QCOMPARE(regions.size(), 4);
+    QCOMPARE(regions[0], QRect(0, 0, 512, 32));
+    QCOMPARE(regions[3], QRect(0, 96, 512, 32));
+}
+
+void TestDirtyRegionTracker::testUnchangedFrameHasNoDirtyRegion() {
+    DirtyRegionTracker tracker;
+    tracker.update(blank());
+    QVERIFY(tracker.update(blank()).isEmpty());
+    QCOMPARE(tracker.dirtyTileCount(), 0);
+    QVERIFY(tracker.dirtyBounds().isNull());
+    QVERIFY(!tracker.isDirty(QRect(0, 0, 512, 128)));
+}
+
+void TestDirtyRegionTracker::testSingleTileChange() {
+    DirtyRegionTracker tracker;
+    tracker.update(blank());
+
+    QImage frame = blank();
+    fill(frame, QRect(140, 40, 10, 10), 0);
+    const QVector<QRect> regions = tracker.update(frame);
+    QCOMPARE(regions, QVector<QRect>({QRect(128, 32, 128, 32)}));
+    QCOMPARE(tracker.dirtyTileCount(), 1);
+    QCOMPARE(tracker.dirtyBounds(), QRect(128, 32, 128, 32));
+    QVERIFY(tracker.isDirty(QRect(200, 50, 4, 4)));
+    QVERIFY(!tracker.isDirty(QRect(0, 0, 128, 32)));
+}
+
+void TestDirtyRegionTracker::testLineAcrossTileRowsStaysWhole() {
+    DirtyRegionTracker tracker;
+    tracker.update(blank());
+
+    // 一行文字跨过y=64的瓦片行边界，两个瓦片行合成一块
+    QImage frame = blank();
+    fill(frame, QRect(140, 56, 60, 16), 0);
+    const QVector<QRect> regions = tracker.update(frame);
+    QCOMPARE(tracker.dirtyTileCount(), 2);
+    QCOMPARE(regions, QVector<QRect>({QRect(128, 32, 128, 64)}));
+}
+
+void TestDirtyRegionTracker::testTexturedGradientBackground() {
+    DirtyRegionTracker tracker;
+    // 背景不是纯色，但没有笔画边缘，不应把块扩展到整屏高度
+    QCOMPARE(tracker.update(texturedGradient()).size(), 4);
+
+    QImage frame = texturedGradient();
+    fill(frame, QRect(140, 40, 10, 10), 0);
+    QCOMPARE(tracker.update(frame), QVector<QRect>({QRect(128, 32, 128, 32)}));
+
+    // 真正跨过边界的文字仍然合成一块
+    frame = texturedGradient();
+    fill(frame, QRect(140, 56, 60, 16), 0);
+    QCOMPARE(tracker.update(frame), QVector<QRect>({QRect(128, 32, 128, 64)}));
+}
+
+void TestDirtyRegionTracker::testCachedTextReuseAndInvalidation() {
+    DirtyRegionTracker tracker;
+    const QVector<QRect> first = tracker.update(blank());
+    for (int i = 0; i < first.size(); ++i) {
+        tracker.storeText(first[i], QString("row%1").arg(i));
+    }
+    QCOMPARE(tracker.text(), QString("row0\nrow1\nrow2\nrow3"));
+
+    // 变化的瓦片落在缓存块内，整个缓存块重新识别
+    QImage frame = blank();
+    fill(frame, QRect(140, 40, 10, 10), 0);
+    const QVector<QRect> regions = tracker.update(frame);
+    QCOMPARE(regions, QVector<QRect>({QRect(0, 32, 512, 32)}));
+    QCOMPARE(tracker.text(), QString("row0\nrow2\nrow3"));
+
+    tracker.storeText(regions[0], "edited");
+    QCOMPARE(tracker.text(), QString("row0\nedited\nrow2\nrow3"));
+}
+
+QTEST_MAIN(TestDirtyRegionTracker)
+#include "TestDirtyRegionTracker.moc"
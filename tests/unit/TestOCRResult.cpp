@@ -0,0 +1,186 @@
+#include <QtTest/QtTest>
+#include <QDataStream>
+#include "ocr/ocrresult.h"
+
+// OCRResult值类型：连续数组 + UTF-8字符串池
+class TestOCRResult : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testBuildAndRead();
+    void testLineTextSpacing();
+    void testAppendOffsetAndScale();
+    void testFiltered();
+    void testImplicitSharing();
+    void testStreamRoundTrip();
+    void testStreamRejectsCorruptData();
+
+private:
+    static void addWord(OCRResult &result, const QRect &rect, const QByteArray &text, int confidence);
+};
+
+void TestOCRResult::addWord(OCRResult &result, const QRect &rect, const QByteArray &text, int confidence) {
+    result.addWord(rect, text.constData(), int(text.size()), confidence);
+}
+
+void TestOCRResult::testBuildAndRead() {
+    OCRResult result;
+    QVERIFY(result.isEmpty());
+
+    result.addBlock(QRect(0, 0, 200, 40), 7);
+    result.addLine(QRect(0, 0, 200, 20));
+    addWord(result, QRect(0, 0, 50, 20), "Hello", 90);
+    addWord(result, QRect(60, 0, 60, 20), "world", 85);
+    result.addLine(QRect(0, 20, 200, 20));
+    addWord(result, QRect(0, 20, 40, 20), "第二行", 70);
+
+    QCOMPARE(result.blockCount(), 1);
+    QCOMPARE(result.lineCount(), 2);
+    QCOMPARE(result.wordCount(), 3);
+    QCOMPARE(result.block(0).id, quint64(7));
+    QCOMPARE(result.line(1).firstWord, quint32(2));
+    QCOMPARE(result.word(2).line, quint32(1));
+    QCOMPARE(result.word(1).confidence, 85);
+    QCOMPARE(result.wordUtf8(0).toByteArray(), QByteArray("Hello"));
+    QCOMPARE(result.wordText(2), QString("第二行"));
+    QCOMPARE(result.text(), QString("Hello world\n第二行"));
+}
+
+void TestOCRResult::testLineTextSpacing() {
+    // 中文词之间不加空格，中英文之间也不加
+    OCRResult result;
+    result.addLine(QRect(0, 0, 100, 20));
+    addWord(result, QRect(0, 0, 10, 20), "屏幕", 90);
+    addWord(result, QRect(10, 0, 10, 20), "文字", 90);
+    addWord(result, QRect(20, 0, 10, 20), "OCR", 90);
+    addWord(result, QRect(30, 0, 10, 20), "engine", 90);
+    QCOMPARE(result.lineText(0), QString("屏幕文字OCR engine"));
+
+    // 补充平面的汉字（U+20BB7）在UTF-16中是代理对，按整个码位判断
+    OCRResult extended;
+    extended.addLine(QRect(0, 0, 100, 20));
+    addWord(extended, QRect(0, 0, 10, 20), "𠮷", 90);
+    addWord(extended, QRect(10, 0, 10, 20), "OCR", 90);
+    QCOMPARE(extended.lineText(0), QString("𠮷OCR"));
+}
+
+void TestOCRResult::testAppendOffsetAndScale() {
+    OCRResult fragment;
+    fragment.addBlock(QRect(0, 0, 100, 20));
+    fragment.addLine(QRect(0, 0, 100, 20));
+    addWord(fragment, QRect(5, 2, 30, 16), "abc", 80);
+
+    OCRResult frame;
+    frame.addBlock(QRect(0, 0, 10, 10), 1);
+    frame.addLine(QRect(0, 0, 10, 10));
+    addWord(frame, QRect(0, 0, 10, 10), "x", 99);
+    frame.append(fragment, QPoint(100, 200), 2, 42);
+
+    QCOMPARE(frame.blockCount(), 2);
+    QCOMPARE(frame.block(1).id, quint64(42));
+    QCOMPARE(frame.block(1).firstLine, quint32(1));
+    QCOMPARE(frame.word(1).rect, QRect(110, 204, 60, 32));
+    QCOMPARE(frame.word(1).line, quint32(1));
+    QCOMPARE(frame.word(1).block, quint32(1));
+    QCOMPARE(frame.wordText(1), QString("abc"));
+    QCOMPARE(frame.wordText(0), QString("x"));
+}
+
+void TestOCRResult::testFiltered() {
+    OCRResult result;
+    result.addLine(QRect(0, 0, 100, 20));
+    addWord(result, QRect(0, 0, 10, 20), "good", 90);
+    addWord(result, QRect(10, 0, 10, 20), "n0ise", 20);
+    result.addLine(QRect(0, 20, 100, 20));
+    addWord(result, QRect(0, 20, 10, 20), "l1ne", 10);
+
+    const OCRResult filtered = result.filtered(60);
+    QCOMPARE(filtered.wordCount(), 1);
+    QCOMPARE(filtered.lineCount(), 2); // 空行保留
+    QCOMPARE(filtered.text(), QString("good"));
+    QCOMPARE(result.wordCount(), 3);
+}
+
+void TestOCRResult::testImplicitSharing() {
+    OCRResult a;
+    a.addLine(QRect(0, 0, 10, 10));
+    addWord(a, QRect(0, 0, 10, 10), "a", 90);
+
+    OCRResult b = a;
+    QCOMPARE(b.words().constData(), a.words().constData());
+    b.setScreen(2); // 屏幕序号不触发复制
+    QCOMPARE(b.words().constData(), a.words().constData());
+    QCOMPARE(a.screen(), 0);
+
+    addWord(b, QRect(10, 0, 10, 10), "b", 90);
+    QCOMPARE(a.wordCount(), 1);
+    QCOMPARE(b.wordCount(), 2);
+}
+
+void TestOCRResult::testStreamRoundTrip() {
+    OCRResult result;
+    result.setScreen(2);
+    result.addBlock(QRect(0, 0, 200, 20), 5);
+    result.addLine(QRect(0, 0, 200, 20));
+    addWord(result, QRect(0, 0, 50, 20), "Hello", 90);
+    addWord(result, QRect(60, 0, 60, 20), "屏幕", 70);
+
+    QByteArray bytes;
+    {
+        QDataStream out(&bytes, QIODevice::WriteOnly);
+        out << result;
+    }
+    QDataStream in(bytes);
+    OCRResult decoded;
+    in >> decoded;
+    QCOMPARE(in.status(), QDataStream::Ok);
+    QCOMPARE(decoded.screen(), 2);
+    QCOMPARE(decoded.wordCount(), 2);
+    QCOMPARE(decoded.block(0).id, quint64(5));
+    QCOMPARE(decoded.text(), result.text());
+}
+
+void TestOCRResult::testStreamRejectsCorruptData() {
+    // 数量远超流中剩余字节：不分配，直接拒绝
+    {
+        QByteArray bytes;
+        QDataStream out(&bytes, QIODevice::WriteOnly);
+        out << qint32(0) << quint32(0) << quint32(0) << quint32(0x7FFFFFFF);
+        QDataStream in(bytes);
+        OCRResult decoded;
+        in >> decoded;
+        QCOMPARE(in.status(), QDataStream::ReadCorruptData);
+        QVERIFY(decoded.isEmpty());
+    }
+    // 词的文字偏移超出字符串池
+    {
+        QByteArray bytes;
+        QDataStream out(&bytes, QIODevice::WriteOnly);
+        out << qint32(0) << quint32(1) << quint32(1) << quint32(1);
+        out << QRect(0, 0, 10, 10) << quint64(1) << quint32(0) << quint32(1);
+        out << QRect(0, 0, 10, 10) << quint32(0) << quint32(0) << quint32(1);
+        out << QRect(0, 0, 10, 10) << quint32(1000) << quint32(4) << quint32(0) << quint32(0) << qint32(90);
+        out << QByteArray("abcd");
+        QDataStream in(bytes);
+        OCRResult decoded;
+        in >> decoded;
+        QCOMPARE(in.status(), QDataStream::ReadCorruptData);
+        QVERIFY(decoded.isEmpty());
+    }
+    // 行指向不存在的区域
+    {
+        QByteArray bytes;
+        QDataStream out(&bytes, QIODevice::WriteOnly);
+        out << qint32(0) << quint32(1) << quint32(1) << quint32(0);
+        out << QRect(0, 0, 10, 10) << quint64(1) << quint32(0) << quint32(1);
+        out << QRect(0, 0, 10, 10) << quint32(3) << quint32(0) << quint32(0);
+        out << QByteArray();
+        QDataStream in(bytes);
+        OCRResult decoded;
+        in >> decoded;
+        QCOMPARE(in.status(), QDataStream::ReadCorruptData);
+    }
+}
+
+QTEST_MAIN(TestOCRResult)
+#include "TestOCRResult.moc"
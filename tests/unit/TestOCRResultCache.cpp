@@ -0,0 +1,181 @@
+#include <QtTest/QtTest>
+#include <QImage>
+#include <QThread>
+#include "infrastructure/cache/LRUCache.h"
+#include "ocr/ocrresultcache.h"
+
+// LRU缓存的字节预算淘汰、TTL过期和命中统计，以及识别结果缓存的感知哈希
+class TestOCRResultCache : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testEvictsLeastRecentlyUsedOverByteBudget();
+    void testEntryLimitAndOversizedEntry();
+    void testReplaceUpdatesBytes();
+    void testTtlExpiry();
+    void testHitMissCounters();
+    void testResultCacheLookup();
+    void testResultCacheStaysWithinBudget();
+    void testPerceptualHash();
+
+private:
+    static QImage textStrip(int inkLeft, uchar paper, uchar ink);
+};
+
+// 200x24的灰度条，[inkLeft, inkLeft+40)处有一段墨迹
+QImage TestOCRResultCache::textStrip(int inkLeft, uchar paper, uchar ink) {
+    QImage image(200, 24, QImage::Format_Grayscale8);
+    image.fill(paper);
+    for (int y = 6; y < 18; ++y) {
+        memset(image.scanLine(y) + inkLeft, ink, 40);
+    }
+    return image;
+}
+
+void TestOCRResultCache::testEvictsLeastRecentlyUsedOverByteBudget() {
+    LRUCache<int, QString> cache(100, 300);
+    cache.put(1, "one", 100);
+    cache.put(2, "two", 100);
+    cache.put(3, "three", 100);
+    QCOMPARE(cache.totalBytes(), qint64(300));
+
+    // 访问1后，最久未使用的是2
+    QCOMPARE(cache.get(1), QString("one"));
+    cache.put(4, "four", 100);
+    QVERIFY(cache.contains(1));
+    QVERIFY(!cache.contains(2));
+    QVERIFY(cache.contains(3));
+    QVERIFY(cache.contains(4));
+    QCOMPARE(cache.totalBytes(), qint64(300));
+    QCOMPARE(cache.evictions(), quint64(1));
+
+    // 一个大条目挤掉多个旧条目
+    cache.put(5, "five", 250);
+    QCOMPARE(cache.size(), 1);
+    QVERIFY(cache.contains(5));
+    QCOMPARE(cache.totalBytes(), qint64(250));
+    QCOMPARE(cache.evictions(), quint64(4));
+}
+
+void TestOCRResultCache::testEntryLimitAndOversizedEntry() {
+    LRUCache<int, QString> cache(2, 1000);
+    cache.put(1, "one", 10);
+    cache.put(2, "two", 10);
+    cache.put(3, "three", 10);
+    QCOMPARE(cache.size(), 2);
+    QVERIFY(!cache.contains(1));
+
+    // 超过整个预算的条目不缓存，也不挤掉已有条目
+    cache.put(4, "four", 1001);
+    QVERIFY(!cache.contains(4));
+    QCOMPARE(cache.size(), 2);
+    QCOMPARE(cache.totalBytes(), qint64(20));
+}
+
+void TestOCRResultCache::testReplaceUpdatesBytes() {
+    LRUCache<int, QString> cache(10, 1000);
+    cache.put(1, "one", 100);
+    cache.put(1, "uno", 40);
+    QCOMPARE(cache.size(), 1);
+    QCOMPARE(cache.totalBytes(), qint64(40));
+    QCOMPARE(cache.get(1), QString("uno"));
+
+    cache.remove(1);
+    QCOMPARE(cache.size(), 0);
+    QCOMPARE(cache.totalBytes(), qint64(0));
+}
+
+void TestOCRResultCache::testTtlExpiry() {
+    LRUCache<int, QString> cache(10, 1000, 1);
+    cache.put(1, "one", 10);
+    QString value;
+    QVERIFY(cache.tryGet(1, value));
+
+    QThread::msleep(1100);
+    QVERIFY(!cache.tryGet(1, value));
+    // 过期条目在查找时删除并释放字节
+    QVERIFY(!cache.contains(1));
+    QCOMPARE(cache.totalBytes(), qint64(0));
+    QCOMPARE(cache.hits(), quint64(1));
+    QCOMPARE(cache.misses(), quint64(1));
+}
+
+void TestOCRResultCache::testHitMissCounters() {
+    LRUCache<int, QString> cache(10, 1000);
+    QCOMPARE(cache.hitRate(), 0.0);
+
+    cache.put(1, "one", 10);
+    QVERIFY(cache.get(2).isNull());
+    QCOMPARE(cache.get(1), QString("one"));
+    QCOMPARE(cache.get(1), QString("one"));
+    // contains()不计入统计
+    QVERIFY(cache.contains(1));
+    QCOMPARE(cache.hits(), quint64(2));
+    QCOMPARE(cache.misses(), quint64(1));
+    QCOMPARE(cache.hitRate(), 2.0 / 3.0);
+
+    cache.resetStatistics();
+    QCOMPARE(cache.hits(), quint64(0));
+    QCOMPARE(cache.misses(), quint64(0));
+    QCOMPARE(cache.size(), 1);
+}
+
+void TestOCRResultCache::testResultCacheLookup() {
+    OCRResultCache cache;
+    const QByteArray key = OCRResultCache::perceptualHash(textStrip(10, 220, 30), QRect(0, 0, 200, 24));
+    QVERIFY(!key.isEmpty());
+
+    OCRCachedText result;
+    QVERIFY(!cache.lookup(key, result));
+
+    OCRCachedText stored;
+    stored.text = "File";
+    stored.confidence = 91;
+    cache.insert(key, stored);
+    QVERIFY(cache.lookup(key, result));
+    QCOMPARE(result.text, QString("File"));
+    QCOMPARE(result.confidence, 91);
+    QCOMPARE(cache.hits(), quint64(1));
+    QCOMPARE(cache.misses(), quint64(1));
+    QCOMPARE(cache.hitRate(), 0.5);
+
+    // 空键（区域无效）既不缓存也不计入统计
+    cache.insert(QByteArray(), stored);
+    QVERIFY(!cache.lookup(QByteArray(), result));
+    QCOMPARE(cache.size(), 1);
+    QCOMPARE(cache.misses(), quint64(1));
+
+    cache.clear();
+    QCOMPARE(cache.size(), 0);
+    QCOMPARE(cache.totalBytes(), qint64(0));
+}
+
+void TestOCRResultCache::testResultCacheStaysWithinBudget() {
+    OCRResultCache cache(4096, 8 * 1024, 0);
+    OCRCachedText stored;
+    stored.text = QString(200, QChar('x'));
+    for (int i = 0; i < 100; ++i) {
+        cache.insert(QByteArray::number(i), stored);
+        QVERIFY(cache.totalBytes() <= 8 * 1024);
+    }
+    QVERIFY(cache.size() < 100);
+    OCRCachedText result;
+    QVERIFY(cache.lookup(QByteArray::number(99), result));
+    QVERIFY(!cache.lookup(QByteArray::number(0), result));
+}
+
+void TestOCRResultCache::testPerceptualHash() {
+    const QRect rect(0, 0, 200, 24);
+    const QByteArray key = OCRResultCache::perceptualHash(textStrip(10, 200, 40), rect);
+
+    // 整体亮度变化不影响键
+    QCOMPARE(OCRResultCache::perceptualHash(textStrip(10, 230, 70), rect), key);
+    // 文字位置不同时键不同
+    QVERIFY(OCRResultCache::perceptualHash(textStrip(120, 200, 40), rect) != key);
+    // 只接受灰度图和有效区域
+    QVERIFY(OCRResultCache::perceptualHash(textStrip(10, 200, 40).convertToFormat(QImage::Format_RGB32), rect).isEmpty());
+    QVERIFY(OCRResultCache::perceptualHash(textStrip(10, 200, 40), QRect(300, 0, 10, 10)).isEmpty());
+}
+
+QTEST_MAIN(TestOCRResultCache)
+#include "TestOCRResultCache.moc"
@@ -0,0 +1,109 @@
+#include <QtTest/QtTest>
+#include "ocr/scanscheduler.h"
+
+// 扫描频率调度：有变化时最高帧率，静止时退避到最低帧率，间隔不短于识别耗时，进程CPU占用超出余量时降频
+class TestScanScheduler : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testActivityRunsAtMaxRate();
+    void testIdleBacksOffToMinRate();
+    void testActivityResumesImmediately();
+    void testSlowRecognitionIsThrottled();
+    void testCpuBudget();
+    void testProcessCpuTime();
+    void testInvalidRangeIgnored();
+};
+
+void TestScanScheduler::testActivityRunsAtMaxRate() {
+    ScanScheduler scheduler;
+    scheduler.setFpsRange(1.0, 20.0);
+    QCOMPARE(scheduler.update(5, 0.1, 0.0), 50);
+    QCOMPARE(scheduler.update(5, 0.1, 0.0), 50);
+}
+
+void TestScanScheduler::testIdleBacksOffToMinRate() {
+    ScanScheduler scheduler;
+    scheduler.setFpsRange(1.0, 20.0);
+    scheduler.update(5, 0.1, 0.0);
+
+    // 开始的几个静止帧保持最高帧率，之后逐帧拉长间隔
+    int previous = scheduler.update(5, 0.0, 0.0);
+    QCOMPARE(previous, 50);
+    bool grew = false;
+    for (int i = 0; i < 30; ++i) {
+        const int next = scheduler.update(5, 0.0, 0.0);
+        QVERIFY(next >= previous);
+        grew = grew || next > previous;
+        previous = next;
+    }
+    QVERIFY(grew);
+    QCOMPARE(scheduler.interval(), 1000);
+    QCOMPARE(scheduler.currentFps(), 1.0);
+}
+
+void TestScanScheduler::testActivityResumesImmediately() {
+    ScanScheduler scheduler;
+    scheduler.setFpsRange(1.0, 20.0);
+    for (int i = 0; i < 30; ++i) {
+        scheduler.update(5, 0.0, 0.0);
+    }
+    QCOMPARE(scheduler.interval(), 1000);
+    QCOMPARE(scheduler.update(5, 0.05, 0.0), 50);
+}
+
+void TestScanScheduler::testSlowRecognitionIsThrottled() {
+    ScanScheduler scheduler;
+    scheduler.setFpsRange(1.0, 30.0);
+    // 每帧识别100毫秒，间隔不短于识别耗时
+    QCOMPARE(scheduler.update(100, 1.0, 0.0), 100);
+    QCOMPARE(scheduler.update(100, 1.0, 0.0), 100);
+}
+
+void TestScanScheduler::testCpuBudget() {
+    ScanScheduler scheduler;
+    scheduler.setFpsRange(1.0, 20.0);
+    scheduler.setMaxCpuLoad(0.25);
+
+    // 进程占用整机一半，超出预算，间隔逐帧拉长
+    int previous = scheduler.update(5, 1.0, 0.5);
+    for (int i = 0; i < 20; ++i) {
+        const int next = scheduler.update(5, 1.0, 0.5);
+        QVERIFY(next >= previous);
+        previous = next;
+    }
+    QVERIFY(previous > 100);
+    QVERIFY(previous <= 1000);
+    QVERIFY(scheduler.cpuLoad() > 0.25);
+
+    // 占用回落到预算以内后逐步恢复到最高帧率
+    for (int i = 0; i < 60; ++i) {
+        scheduler.update(5, 1.0, 0.05);
+    }
+    QCOMPARE(scheduler.interval(), 50);
+}
+
+void TestScanScheduler::testProcessCpuTime() {
+    const qint64 before = ScanScheduler::processCpuTime();
+    QVERIFY(before >= 0);
+    // 忙等一段时间，进程CPU时间随之增加
+    QElapsedTimer timer;
+    timer.start();
+    volatile quint64 sink = 0;
+    while (timer.elapsed() < 50) {
+        sink = sink + 1;
+    }
+    QVERIFY(ScanScheduler::processCpuTime() > before);
+}
+
+void TestScanScheduler::testInvalidRangeIgnored() {
+    ScanScheduler scheduler;
+    scheduler.setFpsRange(2.0, 10.0);
+    scheduler.setFpsRange(0.0, 10.0);
+    scheduler.setFpsRange(5.0, 1.0);
+    QCOMPARE(scheduler.minFps(), 2.0);
+    QCOMPARE(scheduler.maxFps(), 10.0);
+}
+
+QTEST_MAIN(TestScanScheduler)
+#include "TestScanScheduler.moc"
@@ -0,0 +1,100 @@
+#include <QtTest/QtTest>
+#include "ocr/screenhistoryindex.h"
+
+// 屏幕文字历史索引：去重存储、出现记录、子串查询和内存上限
+class TestScreenHistoryIndex : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testSearchFindsOccurrence();
+    void testMemoryBudget();
+    void testTextOutputThenBlocks();
+
+private:
+    static QString lineText(int index);
+};
+
+QString TestScreenHistoryIndex::lineText(int index) {
+    // 一半是常见的重复文字，一半是只出现一次的内容
+    if (index % 2 == 0) {
+        return QString("文件 编辑 视图 窗口 帮助 菜单%1").arg(index % 40);
+    }
+    return QString("第%1段 屏幕文字识别 The quick brown fox %2 jumps over the lazy dog").arg(index).arg(index * 7919 % 100003);
+}
+
+void TestScreenHistoryIndex::testSearchFindsOccurrence() {
+    ScreenHistoryIndex index;
+    index.addBlock(1, "Quarterly Report 第三季度报告", 1, QRect(10, 20, 300, 30), 1000);
+    index.addBlock(2, "Inbox (3)", 0, QRect(0, 0, 100, 20), 2000);
+    index.removeBlock(1, 5000);
+    index.addBlock(1, "Quarterly Report 第三季度报告", 0, QRect(40, 40, 300, 30), 9000);
+
+    // 相同文字只存一份，两次出现分别记录
+    QCOMPARE(index.textCount(), 2);
+    QCOMPARE(index.occurrenceCount(), 3);
+
+    QVector<ScreenHistoryHit> hits = index.search("季度报告");
+    QCOMPARE(hits.size(), 2);
+    QCOMPARE(hits[0].firstSeen, qint64(9000));
+    QCOMPARE(hits[0].lastSeen, qint64(-1));
+    QCOMPARE(hits[1].firstSeen, qint64(1000));
+    QCOMPARE(hits[1].lastSeen, qint64(5000));
+    QCOMPARE(hits[1].screen, 1);
+    QCOMPARE(hits[1].rect, QRect(10, 20, 300, 30));
+
+    QCOMPARE(index.search("quarterly report").size(), 2); // 不区分大小写
+    QCOMPARE(index.search("报").size(), 2);              // 单字查询
+    QVERIFY(index.search("report quarterly").isEmpty());  // 二元组都在但不连续
+}
+
+void TestScreenHistoryIndex::testMemoryBudget() {
+    // 1小时，每秒5个区域
+    ScreenHistoryIndex index(2 * 1024 * 1024);
+    int line = 0;
+    for (int second = 0; second < 3600; ++second) {
+        for (int block = 0; block < 5; ++block, ++line) {
+            index.addBlock(quint64(block) + 1, lineText(line), 0, QRect(0, block * 30, 800, 24), qint64(second) * 1000);
+        }
+    }
+
+    QVERIFY(index.usedBytes() <= index.maxBytes());
+    // 最早的记录被淘汰，最新的记录仍可查到
+    QVERIFY(index.oldestTimestamp() > 0);
+    QVERIFY(!index.search(lineText(line - 1)).isEmpty());
+}
+
+void TestScreenHistoryIndex::testTextOutputThenBlocks() {
+    ScreenHistoryIndex index;
+    // 纯文字输出按行记录，没有位置
+    index.onTextRecognized("Inbox (3)\n项目计划");
+    QCOMPARE(index.occurrenceCount(), 2);
+    QVector<ScreenHistoryHit> hits = index.search("项目计划");
+    QCOMPARE(hits.size(), 1);
+    QCOMPARE(hits[0].screen, -1);
+    QCOMPARE(hits[0].lastSeen, qint64(-1));
+
+    // 收到带位置的区域输出后，按文字记录的行结束，改为按区域记录
+    OCRTextDelta delta;
+    delta.screen = 1;
+    OCRTextBlock block;
+    block.id = 7;
+    block.text = "项目计划";
+    block.rect = QRect(10, 10, 200, 20);
+    delta.added.append(block);
+    index.onBlocksChanged(delta);
+
+    hits = index.search("项目计划");
+    QCOMPARE(hits.size(), 2);
+    // 两次出现可能在同一毫秒，不依赖排序
+    const ScreenHistoryHit &positioned = hits[0].screen == 1 ? hits[0] : hits[1];
+    const ScreenHistoryHit &plain = hits[0].screen == 1 ? hits[1] : hits[0];
+    QCOMPARE(positioned.screen, 1);
+    QCOMPARE(positioned.rect, QRect(10, 10, 200, 20));
+    QCOMPARE(positioned.lastSeen, qint64(-1));
+    QCOMPARE(plain.screen, -1);
+    QVERIFY(plain.lastSeen >= 0);
+    QVERIFY(index.search("Inbox")[0].lastSeen >= 0);
+}
+
+QTEST_MAIN(TestScreenHistoryIndex)
+#include "TestScreenHistoryIndex.moc"
@@ -0,0 +1,132 @@
+#include <QtTest/QtTest>
+#include <QImage>
+#include "ocr/scriptdetector.h"
+
+// 文字种类识别：用几何图形模拟方块字和高低错落的拉丁字母
+class TestScriptDetector : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testHanLine();
+    void testLatinLine();
+    void testMixedLine();
+    void testHanAndLatinLines();
+    void testInvertedColors();
+    void testUnknown();
+
+private:
+    static QImage blank();
+    static void fill(QImage &image, const QRect &rect);
+    // 20x20的方块：四横两竖，每列穿过四笔。返回下一个字的起始x
+    static int drawHan(QImage &image, int x, int top);
+    // 20像素高的竖线，像字母l
+    static int drawTall(QImage &image, int x, int top);
+    // 8x10的方框，只有x高度，像字母o
+    static int drawShort(QImage &image, int x, int top);
+};
+
+QImage TestScriptDetector::blank() {
+    QImage image(240, 80, QImage::Format_Grayscale8);
+    image.fill(255);
+    return image;
+}
+
+void TestScriptDetector::fill(QImage &image, const QRect &rect) {
+    for (int y = rect.top(); y <= rect.bottom(); ++y) {
+        memset(image.scanLine(y) + rect.left(), 0, size_t(rect.width()));
+    }
+}
+
+int TestScriptDetector::drawHan(QImage &image, int x, int top) {
+    for (int stroke = 0; stroke < 4; ++stroke) {
+        fill(image, QRect(x, top + stroke * 6, 20, 2));
+    }
+    fill(image, QRect(x, top, 2, 20));
+    fill(image, QRect(x + 18, top, 2, 20));
+    return x + 26;
+}
+
+int TestScriptDetector::drawTall(QImage &image, int x, int top) {
+    fill(image, QRect(x, top, 2, 20));
+    return x + 6;
+}
+
+int TestScriptDetector::drawShort(QImage &image, int x, int top) {
+    fill(image, QRect(x, top + 10, 8, 2));
+    fill(image, QRect(x, top + 18, 8, 2));
+    fill(image, QRect(x, top + 10, 2, 10));
+    fill(image, QRect(x + 6, top + 10, 2, 10));
+    return x + 12;
+}
+
+void TestScriptDetector::testHanLine() {
+    QImage image = blank();
+    int x = 10;
+    for (int i = 0; i < 6; ++i) {
+        x = drawHan(image, x, 10);
+    }
+    QCOMPARE(ScriptDetector::detect(image, QRect(0, 0, 240, 40)), ScriptDetector::Han);
+}
+
+void TestScriptDetector::testLatinLine() {
+    QImage image = blank();
+    int x = 10;
+    for (int i = 0; i < 6; ++i) {
+        x = drawTall(image, x, 10);
+        x = drawShort(image, x, 10);
+    }
+    QCOMPARE(ScriptDetector::detect(image, QRect(0, 0, 240, 40)), ScriptDetector::Latin);
+}
+
+void TestScriptDetector::testMixedLine() {
+    // 拉丁字块多于汉字的五分之一，交给组合模型
+    QImage image = blank();
+    int x = drawHan(image, 10, 10);
+    x = drawHan(image, x, 10);
+    for (int i = 0; i < 3; ++i) {
+        x = drawTall(image, x, 10);
+    }
+    QCOMPARE(ScriptDetector::detect(image, QRect(0, 0, 240, 40)), ScriptDetector::Mixed);
+}
+
+void TestScriptDetector::testHanAndLatinLines() {
+    QImage image = blank();
+    int x = 10;
+    for (int i = 0; i < 5; ++i) {
+        x = drawHan(image, x, 10);
+    }
+    x = 10;
+    for (int i = 0; i < 5; ++i) {
+        x = drawTall(image, x, 45);
+        x = drawShort(image, x, 45);
+    }
+    QCOMPARE(ScriptDetector::detect(image, image.rect()), ScriptDetector::Mixed);
+    // 只看其中一行
+    QCOMPARE(ScriptDetector::detect(image, QRect(0, 0, 240, 40)), ScriptDetector::Han);
+    QCOMPARE(ScriptDetector::detect(image, QRect(0, 40, 240, 40)), ScriptDetector::Latin);
+}
+
+void TestScriptDetector::testInvertedColors() {
+    // 浅色字深色底
+    QImage image = blank();
+    int x = 10;
+    for (int i = 0; i < 6; ++i) {
+        x = drawHan(image, x, 10);
+    }
+    image.invertPixels();
+    QCOMPARE(ScriptDetector::detect(image, QRect(0, 0, 240, 40)), ScriptDetector::Han);
+}
+
+void TestScriptDetector::testUnknown() {
+    const QImage image = blank();
+    QCOMPARE(ScriptDetector::detect(image, image.rect()), ScriptDetector::Unknown);
+    // 行太矮
+    QImage small = blank();
+    fill(small, QRect(10, 10, 100, 4));
+    QCOMPARE(ScriptDetector::detect(small, QRect(0, 8, 240, 6)), ScriptDetector::Unknown);
+    // 不是灰度图
+    QCOMPARE(ScriptDetector::detect(image.convertToFormat(QImage::Format_RGB32), image.rect()), ScriptDetector::Unknown);
+}
+
+QTEST_MAIN(TestScriptDetector)
+#include "TestScriptDetector.moc"
@@ -0,0 +1,85 @@
+#include <QtTest/QtTest>
+#include <QImage>
+#include "ocr/scrolldetector.h"
+
+// 滚动检测：已知的竖直、水平位移，静止画面和新露出的区域
+class TestScrollDetector : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testVerticalScroll();
+    void testHorizontalScroll();
+    void testStaticFrameIsNotScroll();
+    void testExposedRect();
+
+private:
+    // 文档内容：(left, top)为视口在文档中的位置，每个像素取位置的哈希，各行各列互不相同
+    static QImage viewport(const QSize &size, int left, int top);
+};
+
+QImage TestScrollDetector::viewport(const QSize &size, int left, int top) {
+    QImage image(size, QImage::Format_Grayscale8);
+    for (int y = 0; y < size.height(); ++y) {
+        uchar *row = image.scanLine(y);
+        for (int x = 0; x < size.width(); ++x) {
+            quint32 h = quint32(x + left) * 73856093u ^ quint32(y + top) * 19349663u;
+            h ^= h >> 13;
+            h *= 0x5bd1e995u;
+            h ^= h >> 15;
+            row[x] = uchar(h);
+        }
+    }
+    return image;
+}
+
+void TestScrollDetector::testVerticalScroll() {
+    ScrollDetector detector;
+    const QSize size(200, 300);
+    // 向下滚动24像素：内容上移，current(x, y) == previous(x, y + 24)
+    const QImage previous = viewport(size, 0, 100);
+    const QImage current = viewport(size, 0, 124);
+    QPoint offset;
+    QVERIFY(detector.estimate(previous, current, QRect(QPoint(0, 0), size), offset));
+    QCOMPARE(offset, QPoint(0, -24));
+
+    // 反方向
+    QVERIFY(detector.estimate(current, previous, QRect(QPoint(0, 0), size), offset));
+    QCOMPARE(offset, QPoint(0, 24));
+}
+
+void TestScrollDetector::testHorizontalScroll() {
+    ScrollDetector detector;
+    const QSize size(300, 120);
+    const QImage previous = viewport(size, 50, 0);
+    const QImage current = viewport(size, 40, 0);
+    QPoint offset;
+    QVERIFY(detector.estimate(previous, current, QRect(QPoint(0, 0), size), offset));
+    QCOMPARE(offset, QPoint(10, 0));
+}
+
+void TestScrollDetector::testStaticFrameIsNotScroll() {
+    ScrollDetector detector;
+    const QImage frame = viewport(QSize(200, 200), 0, 0);
+    QPoint offset;
+    QVERIFY(!detector.estimate(frame, frame, frame.rect(), offset));
+
+    // 内容完全不同时也不是滚动
+    QVERIFY(!detector.estimate(frame, viewport(QSize(200, 200), 1000, 5000), frame.rect(), offset));
+
+    // 纯色画面没有可投票的行
+    QImage blank(200, 200, QImage::Format_Grayscale8);
+    blank.fill(255);
+    QVERIFY(!detector.estimate(blank, blank, blank.rect(), offset));
+}
+
+void TestScrollDetector::testExposedRect() {
+    const QRect region(10, 20, 100, 200);
+    QCOMPARE(ScrollDetector::exposedRect(region, QPoint(0, -24)), QRect(10, 196, 100, 24));
+    QCOMPARE(ScrollDetector::exposedRect(region, QPoint(0, 24)), QRect(10, 20, 100, 24));
+    QCOMPARE(ScrollDetector::exposedRect(region, QPoint(-10, 0)), QRect(100, 20, 10, 200));
+    QCOMPARE(ScrollDetector::exposedRect(region, QPoint(10, 0)), QRect(10, 20, 10, 200));
+    QVERIFY(ScrollDetector::exposedRect(region, QPoint()).isNull());
+}
+
+QTEST_MAIN(TestScrollDetector)
+#include "TestScrollDetector.moc"
@@ -0,0 +1,80 @@
+#include <QtTest/QtTest>
+#include <QImage>
+#include <algorithm>
+#include "ocr/textdetector.h"
+
+// 文字区域检测：空白画面、单行和多行文字、过高的纹理区域
+class TestTextDetector : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testBlankImageHasNoText();
+    void testSingleLine();
+    void testSeparateLines();
+    void testTallTextureIsRejected();
+
+private:
+    static QImage blank();
+    // 模拟文字行：每12像素一个4像素宽的竖直笔画，宽度取12n+4使最后一笔落在右边缘
+    static void drawLine(QImage &image, const QRect &rect);
+};
+
+QImage TestTextDetector::blank() {
+    QImage image(400, 300, QImage::Format_Grayscale8);
+    image.fill(255);
+    return image;
+}
+
+void TestTextDetector::drawLine(QImage &image, const QRect &rect) {
+    for (int y = rect.top(); y <= rect.bottom(); ++y) {
+        uchar *row = image.scanLine(y);
+        for (int x = rect.left(); x <= rect.right(); ++x) {
+            if ((x - rect.left()) % 12 < 4) row[x] = 0;
+        }
+    }
+}
+
+void TestTextDetector::testBlankImageHasNoText() {
+    TextDetector detector;
+    QVERIFY(detector.detect(blank()).isEmpty());
+    QVERIFY(detector.detect(QImage()).isEmpty());
+}
+
+void TestTextDetector::testSingleLine() {
+    TextDetector detector;
+    QImage image = blank();
+    const QRect line(40, 40, 196, 16);
+    drawLine(image, line);
+    const QVector<QRect> boxes = detector.detect(image);
+    QCOMPARE(boxes.size(), 1);
+    QVERIFY(boxes[0].contains(line));
+    // 只多出检测时的边距
+    QVERIFY(boxes[0].width() <= line.width() + 16);
+    QVERIFY(boxes[0].height() <= line.height() + 16);
+}
+
+void TestTextDetector::testSeparateLines() {
+    TextDetector detector;
+    QImage image = blank();
+    const QRect first(40, 40, 196, 16);
+    const QRect second(40, 120, 124, 16);
+    drawLine(image, first);
+    drawLine(image, second);
+    QVector<QRect> boxes = detector.detect(image);
+    QCOMPARE(boxes.size(), 2);
+    std::sort(boxes.begin(), boxes.end(), [](const QRect &a, const QRect &b) { return a.top() < b.top(); });
+    QVERIFY(boxes[0].contains(first));
+    QVERIFY(boxes[1].contains(second));
+    QVERIFY(!boxes[0].intersects(boxes[1]));
+}
+
+void TestTextDetector::testTallTextureIsRejected() {
+    // 笔画连成一整块，高度远超文字行，视为图片
+    TextDetector detector;
+    QImage image = blank();
+    drawLine(image, QRect(40, 20, 300, 260));
+    QVERIFY(detector.detect(image).isEmpty());
+}
+
+QTEST_MAIN(TestTextDetector)
+#include "TestTextDetector.moc"
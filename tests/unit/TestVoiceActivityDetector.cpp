@@ -0,0 +1,96 @@
+#include <QtTest/QtTest>
+#include <QVector>
+#include <QtMath>
+#include "speech/voiceactivitydetector.h"
+
+// 语音活动检测：静音跳过、语音段加前置音频和拖尾、清音和单次脉冲
+class TestVoiceActivityDetector : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testSilenceIsSkipped();
+    void testSpeechSegmentWithPaddingAndHangover();
+    void testFricativeCountsAsSpeech();
+    void testClickIsIgnored();
+
+private:
+    // 按40毫秒一块送入，返回送出的采样数和语音段结束次数
+    static int run(VoiceActivityDetector &vad, const QVector<qint16> &input, int *segments = nullptr);
+    static QVector<qint16> noise(int samples, int amplitude, quint32 seed);
+    static void addTone(QVector<qint16> &samples, int from, int count, double frequency, int amplitude);
+};
+
+int TestVoiceActivityDetector::run(VoiceActivityDetector &vad, const QVector<qint16> &input, int *segments) {
+    const int block = 640;
+    QVector<qint16> out(block + vad.paddingSamples());
+    int written = 0;
+    for (int i = 0; i < input.size(); i += block) {
+        bool ended = false;
+        written += vad.process(input.constData() + i, qMin(block, input.size() - i), out.data(), &ended);
+        if (segments && ended) ++*segments;
+    }
+    return written;
+}
+
+QVector<qint16> TestVoiceActivityDetector::noise(int samples, int amplitude, quint32 seed) {
+    // 固定种子的线性同余序列，结果可重复
+    QVector<qint16> result(samples);
+    for (qint16 &s : result) {
+        seed = seed * 1664525u + 1013904223u;
+        s = qint16(int(seed >> 16) % (2 * amplitude + 1) - amplitude);
+    }
+    return result;
+}
+
+void TestVoiceActivityDetector::addTone(QVector<qint16> &samples, int from, int count, double frequency, int amplitude) {
+    for (int i = from; i < from + count; ++i) {
+        samples[i] = qint16(qBound(-32768, samples[i] + int(amplitude * qSin(2 * M_PI * frequency * i / 16000.0)), 32767));
+    }
+}
+
+void TestVoiceActivityDetector::testSilenceIsSkipped() {
+    VoiceActivityDetector vad;
+    int segments = 0;
+    QCOMPARE(run(vad, noise(16000 * 2, 50, 1), &segments), 0);
+    QCOMPARE(segments, 0);
+    QCOMPARE(vad.totalSamples(), qint64(32000));
+    QCOMPARE(vad.skippedPercent(), 100.0);
+}
+
+void TestVoiceActivityDetector::testSpeechSegmentWithPaddingAndHangover() {
+    VoiceActivityDetector vad;
+    // 1秒噪声、1秒语音、2秒噪声
+    QVector<qint16> input = noise(16000 * 4, 50, 2);
+    addTone(input, 16000, 16000, 300.0, 8000);
+
+    int segments = 0;
+    const int written = run(vad, input, &segments);
+    QCOMPARE(segments, 1);
+    QVERIFY(!vad.isSpeech());
+    // 语音本身加上200毫秒前置音频和300毫秒拖尾，误差在两帧以内
+    const int expected = 16000 + 3200 + 4800;
+    QVERIFY2(qAbs(written - expected) <= 320, qPrintable(QString::number(written)));
+    QVERIFY(vad.skippedPercent() > 55.0);
+}
+
+void TestVoiceActivityDetector::testFricativeCountsAsSpeech() {
+    VoiceActivityDetector vad;
+    // 比浊音弱得多的宽带噪声，过零率高，按清音处理
+    QVector<qint16> input = noise(16000 * 2, 50, 3);
+    const QVector<qint16> hiss = noise(8000, 200, 4);
+    for (int i = 0; i < hiss.size(); ++i) {
+        input[16000 + i] = hiss.at(i);
+    }
+    QVERIFY(run(vad, input) >= hiss.size());
+}
+
+void TestVoiceActivityDetector::testClickIsIgnored() {
+    VoiceActivityDetector vad;
+    // 只持续一帧的响声达不到起始确认
+    QVector<qint16> input = noise(16000, 50, 5);
+    addTone(input, 8000, 160, 1000.0, 20000);
+    QCOMPARE(run(vad, input), 0);
+}
+
+QTEST_MAIN(TestVoiceActivityDetector)
+#include "TestVoiceActivityDetector.moc"